@@ -12,6 +12,7 @@
 #include "Game/Players/PlayerHandler.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/ResourceHandler.h"
 #include "Sim/Misc/Team.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Units/Unit.h"
@@ -536,6 +537,9 @@ void CEngineOutHandler::CreateSkirmishAI(const uint8_t skirmishAIId, bool savedG
 		return;
 	}
 
+	// native AIs usually ask for resource spots early on
+	resourceHandler->PrefetchResourceMapAnalyzers();
+
 	aiInst.PreInit(skirmishAIId);
 
 	teamSkirmishAIs[ aiInst.GetTeamId() ].push_back(skirmishAIId);
@@ -213,6 +213,8 @@ CR_REG_METADATA(CGame, (
 	CR_IGNORED(worldDrawer),
 	CR_IGNORED(saveFileHandler),
 	CR_IGNORED(gameInputReceiver),
+	CR_IGNORED(loadStages),
+	CR_IGNORED(loadStageDepth),
 
 	// Post Load
 	CR_POSTLOAD(PostLoad)
@@ -372,10 +374,8 @@ void CGame::Load(const std::string& mapFileName)
 	try {
 		LOG("[Game::%s][1] globalQuit=%d threaded=%d", __func__, globalQuit.load(), !Threading::IsMainThread());
 
-		LoadMap(mapFileName);
-		Watchdog::ClearTimer(WDT_LOAD);
-		LoadDefs(defsParser);
-		Watchdog::ClearTimer(WDT_LOAD);
+		RunLoadStage("LoadMap", [&]() { LoadMap(mapFileName); });
+		RunLoadStage("LoadDefs", [&]() { LoadDefs(defsParser); });
 	} catch (const content_error& e) {
 		contentErrors.emplace_back(e.what());
 		LOG_L(L_ERROR, "[Game::%s][1] forced quit with exception \"%s\"", __func__, e.what());
@@ -391,10 +391,8 @@ void CGame::Load(const std::string& mapFileName)
 	try {
 		LOG("[Game::%s][2] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
 
-		PreLoadSimulation(defsParser);
-		Watchdog::ClearTimer(WDT_LOAD);
-		PreLoadRendering();
-		Watchdog::ClearTimer(WDT_LOAD);
+		RunLoadStage("PreLoadSimulation", [&]() { PreLoadSimulation(defsParser); });
+		RunLoadStage("PreLoadRendering", [&]() { PreLoadRendering(); });
 	} catch (const content_error& e) {
 		contentErrors.emplace_back(e.what());
 		LOG_L(L_ERROR, "[Game::%s][2] forced quit with exception \"%s\"", __func__, e.what());
@@ -404,10 +402,8 @@ void CGame::Load(const std::string& mapFileName)
 	try {
 		LOG("[Game::%s][3] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
 
-		PostLoadSimulation(defsParser);
-		Watchdog::ClearTimer(WDT_LOAD);
-		PostLoadRendering();
-		Watchdog::ClearTimer(WDT_LOAD);
+		RunLoadStage("PostLoadSimulation", [&]() { PostLoadSimulation(defsParser); });
+		RunLoadStage("PostLoadRendering", [&]() { PostLoadRendering(); });
 	} catch (const content_error& e) {
 		contentErrors.emplace_back(e.what());
 		LOG_L(L_ERROR, "[Game::%s][3] forced quit with exception \"%s\"", __func__, e.what());
@@ -417,8 +413,7 @@ void CGame::Load(const std::string& mapFileName)
 		try {
 			LOG("[Game::%s][4] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
 
-			LoadInterface();
-			Watchdog::ClearTimer(WDT_LOAD);
+			RunLoadStage("LoadInterface", [&]() { LoadInterface(); });
 		} catch (const content_error& e) {
 			contentErrors.emplace_back(e.what());
 			LOG_L(L_ERROR, "[Game::%s][4] forced quit with exception \"%s\"", __func__, e.what());
@@ -430,8 +425,7 @@ void CGame::Load(const std::string& mapFileName)
 		try {
 			LOG("[Game::%s][5] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
 
-			LoadFinalize();
-			Watchdog::ClearTimer(WDT_LOAD);
+			RunLoadStage("LoadFinalize", [&]() { LoadFinalize(); });
 		} catch (const content_error& e) {
 			contentErrors.emplace_back(e.what());
 			LOG_L(L_ERROR, "[Game::%s][5] forced quit with exception \"%s\"", __func__, e.what());
@@ -443,8 +437,7 @@ void CGame::Load(const std::string& mapFileName)
 		try {
 			LOG("[Game::%s][6] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
 
-			LoadLua(saveFileHandler != nullptr, false);
-			Watchdog::ClearTimer(WDT_LOAD);
+			RunLoadStage("LoadLua", [&]() { LoadLua(saveFileHandler != nullptr, false); });
 		} catch (const content_error& e) {
 			contentErrors.emplace_back(e.what());
 			LOG_L(L_ERROR, "[Game::%s][6] forced quit with exception \"%s\"", __func__, e.what());
@@ -457,32 +450,30 @@ void CGame::Load(const std::string& mapFileName)
 
 		if (!globalQuit && saveFileHandler != nullptr) {
 			loadscreen->SetLoadMessage("Loading Saved Game");
-			{
+			RunLoadStage("LoadSavedGame", [&]() {
 				auto lock = CLoadLock::GetUniqueLock();
 				saveFileHandler->LoadGame();
-				Watchdog::ClearTimer(WDT_LOAD);
-			}
-			LoadLua(false, true);
-			Watchdog::ClearTimer(WDT_LOAD);
+			});
+			RunLoadStage("LoadLua (unsynced)", [&]() { LoadLua(false, true); });
 		} else {
 			ENTER_SYNCED_CODE();
-			{
+			RunLoadStage("GamePreload", [&]() {
 				auto lock = CLoadLock::GetUniqueLock();
 				eventHandler.GamePreload();
 				Watchdog::ClearTimer(WDT_LOAD);
 				eventHandler.CollectGarbage(true);
-				Watchdog::ClearTimer(WDT_LOAD);
-			}
+			});
 			LEAVE_SYNCED_CODE();
 		}
 		// Update height bounds and pathing after pregame or a saved game load.
 		{
 			ENTER_SYNCED_CODE();
-			//needed in case pre-game terraform changed the map
-			readMap->UpdateHeightBounds();
-			Watchdog::ClearTimer(WDT_LOAD);
-			pathManager->PostFinalizeRefresh();
-			Watchdog::ClearTimer(WDT_LOAD);
+			RunLoadStage("PostFinalizeRefresh", [&]() {
+				//needed in case pre-game terraform changed the map
+				readMap->UpdateHeightBounds();
+				Watchdog::ClearTimer(WDT_LOAD);
+				pathManager->PostFinalizeRefresh();
+			});
 			LEAVE_SYNCED_CODE();
 		}
 
@@ -502,8 +493,7 @@ void CGame::Load(const std::string& mapFileName)
 		try {
 			LOG("[Game::%s][8] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
 
-			LoadSkirmishAIs();
-			Watchdog::ClearTimer(WDT_LOAD);
+			RunLoadStage("LoadSkirmishAIs", [&]() { LoadSkirmishAIs(); });
 		} catch (const content_error& e) {
 			contentErrors.emplace_back(e.what());
 			LOG_L(L_ERROR, "[Game::%s][8] forced quit with exception \"%s\"", __func__, e.what());
@@ -513,6 +503,7 @@ void CGame::Load(const std::string& mapFileName)
 
 	Watchdog::DeregisterThread(WDT_LOAD);
 	AddTimedJobs();
+	LogLoadStages();
 
 	if (forcedQuit)
 		spring::exitCode = spring::EXIT_CODE_NOLOAD;
@@ -657,21 +648,22 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 	ZoneScoped;
 	CommonDefHandler::InitStatic();
 
-	{
-		SCOPED_ONCE_TIMER("Game::PostLoadSim (WeaponDefs)");
+	RunLoadStage("WeaponDefs", [&]() {
 		loadscreen->SetLoadMessage("Loading Weapon Definitions");
 		weaponDefHandler->Init(defsParser);
-	}
-	{
-		SCOPED_ONCE_TIMER("Game::PostLoadSim (UnitDefs)");
+	});
+	RunLoadStage("UnitDefs", [&]() {
 		loadscreen->SetLoadMessage("Loading Unit Definitions");
 		unitDefHandler->Init(defsParser);
-	}
-	{
-		SCOPED_ONCE_TIMER("Game::PostLoadSim (FeatureDefs)");
+	});
+	RunLoadStage("FeatureDefs", [&]() {
 		loadscreen->SetLoadMessage("Loading Feature Definitions");
 		featureDefHandler->Init(defsParser);
-	}
+	});
+
+	// nothing up to the map features depends on models, so parsing them and
+	// decoding their textures on the ThreadPool overlaps with PFS initialization
+	RunLoadStage("PreloadModels", [&]() { worldDrawer.PreloadModels(); });
 
 	CUnit::InitStatic();
 	CCommandAI::InitCommandDescriptionCache();
@@ -705,14 +697,20 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 	//   --> need a way to let Lua flush it or re-calculate map
 	//   checksum (over heightmap + blockmap, not raw archive)
 	mapDamage = IMapDamage::InitMapDamage();
-	pathManager = IPathManager::GetInstance(modInfo.pathFinderSystem);
+	RunLoadStage("PathManager", [&]() { pathManager = IPathManager::GetInstance(modInfo.pathFinderSystem); });
 	moveDefHandler.PostSimInit();
 
+	// map features upload their models (S3DModelVAO::UploadVBOs) while loading,
+	// which must not overlap preload jobs still appending to the same buffers
+	RunLoadStage("WaitPreloadedModels", [&]() { worldDrawer.WaitPreloadedModels(); });
+
 	// load map-specific features
-	loadscreen->SetLoadMessage("Initializing Map Features");
-	featureDefHandler->LoadFeatureDefsFromMap();
-	if (saveFileHandler == nullptr)
-		featureHandler.LoadFeaturesFromMap();
+	RunLoadStage("MapFeatures", [&]() {
+		loadscreen->SetLoadMessage("Initializing Map Features");
+		featureDefHandler->LoadFeatureDefsFromMap();
+		if (saveFileHandler == nullptr)
+			featureHandler.LoadFeaturesFromMap();
+	});
 
 	// must be called after features are all loaded
 	unitDefHandler->SanitizeUnitDefs();
@@ -746,7 +744,9 @@ void CGame::PreLoadRendering()
 
 void CGame::PostLoadRendering() {
 	ZoneScoped;
-	worldDrawer.InitPost();
+	RunLoadStage("WorldDrawer", [&]() { worldDrawer.InitPost(); });
+	// time spent waiting here is model loading that was not hidden by earlier stages
+	RunLoadStage("FinalizeModels", [&]() { worldDrawer.FinalizeModels(); });
 }
 
 
@@ -929,6 +929,45 @@ void CGame::LoadFinalize()
 }
 
 
+void CGame::RunLoadStage(const char* name, const std::function<void()>& func)
+{
+	const size_t stageIdx = loadStages.size();
+	const int stageDepth = loadStageDepth++;
+	const spring_time t0 = spring_gettime();
+
+	loadStages.push_back({name, stageDepth, spring_notime});
+
+	try {
+		func();
+	} catch (...) {
+		// stage stays in the list with zero time, marking where loading failed
+		loadStageDepth = stageDepth;
+		throw;
+	}
+
+	loadStageDepth = stageDepth;
+	loadStages[stageIdx].time = spring_gettime() - t0;
+
+	Watchdog::ClearTimer(WDT_LOAD);
+}
+
+void CGame::LogLoadStages() const
+{
+	spring_time totalTime = spring_notime;
+
+	for (const LoadStage& stage: loadStages) {
+		if (stage.depth == 0)
+			totalTime += stage.time;
+	}
+
+	LOG("[Game::%s] loading took %.1fms", __func__, totalTime.toMilliSecsf());
+
+	for (const LoadStage& stage: loadStages) {
+		LOG("[Game::%s] %*s%-24s %9.1fms", __func__, stage.depth * 2, "", stage.name, stage.time.toMilliSecsf());
+	}
+}
+
+
 void CGame::PostLoad()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -1788,6 +1827,7 @@ void CGame::SimFrame() {
 
 		teamHandler.GameFrame(gs->frameNum);
 		playerHandler.GameFrame(gs->frameNum);
+		eventHandler.FlushBatchedEvents();
 		eventHandler.GameFramePost(gs->frameNum);
 
 		unitHandler.UpdatePostFrame();
@@ -1800,6 +1840,12 @@ void CGame::SimFrame() {
 
 	eventHandler.DbgTimingInfo(TIMING_SIM, lastFrameTime, lastSimFrameTime);
 
+	// update watched SYNCED snapshots, deliver messages synced Lua deferred during this frame
+	if (luaRules != nullptr)
+		luaRules->PostSimFrame();
+	if (luaGaia != nullptr)
+		luaGaia->PostSimFrame();
+
 	FrameMarkEnd(tracingSimFrameName);
 
 	#ifdef HEADLESS
@@ -4,6 +4,7 @@
 #define _GAME_H
 
 #include <atomic>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -67,6 +68,10 @@ private:
 	void LoadFinalize();
 	void PostLoad();
 
+	/// runs (part of) a loading stage and records its duration for LogLoadStages
+	void RunLoadStage(const char* name, const std::function<void()>& func);
+	void LogLoadStages() const;
+
 	void KillMisc();
 	void KillRendering();
 	void KillInterface();
@@ -225,6 +230,16 @@ private:
 
 	CGameInputReceiver gameInputReceiver;
 
+	struct LoadStage {
+		const char* name;
+		int depth;
+		spring_time time;
+	};
+
+	/// loading stages in the order they were started, nested ones indented by depth
+	std::vector<LoadStage> loadStages;
+	int loadStageDepth = 0;
+
 	std::atomic<bool> loadDone = {false};
 	std::atomic<bool> gameOver = {false};
 };
@@ -16,6 +16,7 @@
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/DamageArray.h"
+#include "Sim/Misc/FootprintBatch.h"
 #include "Sim/Misc/YardmapStatusEffectsMap.h"
 #include "Sim/Misc/GeometricObjects.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
@@ -39,6 +40,7 @@
 #include "Sim/Weapons/Weapon.h"
 #include "System/EventHandler.h"
 #include "System/SpringMath.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/Sound/ISoundChannels.h"
 
 #include "System/Misc/TracyDefs.h"
@@ -54,6 +56,8 @@ void CGameHelper::Init()
 		wdVec.clear();
 		wdVec.reserve(32);
 	}
+
+	targetCandidateQuads.clear();
 }
 
 void CGameHelper::Kill()
@@ -105,37 +109,30 @@ float CGameHelper::CalcImpulseScale(const DamageArray& damages, const float expD
 	return std::clamp(rawImpulseScale, -MAX_EXPLOSION_IMPULSE, MAX_EXPLOSION_IMPULSE);
 }
 
-void CGameHelper::DoExplosionDamage(
-	CUnit* unit,
-	CUnit* owner,
+template<typename T>
+bool CGameHelper::CalcExplosionDamage(
+	const T* object,
 	const float3& expPos,
 	const float expRadius,
-	const float expSpeed,
 	const float expEdgeEffect,
-	const bool ignoreOwner,
 	const DamageArray& damages,
-	const int weaponDefID,
-	const int projectileID
+	ExplosionDamage& expDamage
 ) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	assert(unit != nullptr);
-
-	if (ignoreOwner && (unit == owner))
-		return;
-
-	const LocalModelPiece* lhp = unit->GetLastHitPiece(gs->frameNum);
-	const CollisionVolume* vol = unit->GetCollisionVolume(lhp);
+	const LocalModelPiece* lhp = object->GetLastHitPiece(gs->frameNum);
+	const CollisionVolume* vol = object->GetCollisionVolume(lhp);
 
 	const float3& lhpPos = (lhp != nullptr && vol == lhp->GetCollisionVolume())? lhp->GetAbsolutePos(): ZeroVector;
-	const float3& volPos = vol->GetWorldSpacePos(unit, lhpPos);
+	const float3& volPos = vol->GetWorldSpacePos(object, lhpPos);
 
 	// linear damage falloff with distance
-	const float expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(unit, lhp, expPos) : 0.0f;
+	// (features always measure against their root volume)
+	const LocalModelPiece* expPiece = std::is_same_v<T, CUnit>? lhp: nullptr;
+	const float expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(object, expPiece, expPos) : 0.0f;
 	const float expRim = expDist * expEdgeEffect;
 
 	// return early if (distance > radius)
 	if (expDist > expRadius)
-		return;
+		return false;
 
 	// expEdgeEffect should be in [0, 1], so expRadius >= expDist >= expDist*expEdgeEffect
 	assert(expRadius >= expRim);
@@ -159,56 +156,78 @@ void CGameHelper::DoExplosionDamage(
 	// include units that should not be touched)
 
 	const float3 impulseDir = (volPos - expPos).SafeNormalize();
-	const float3 expImpulse = impulseDir * modImpulseScale;
 
-	DamageArray expDamages = damages * expDistanceMod;
+	expDamage.expDist = expDist;
+	expDamage.expDistanceMod = expDistanceMod;
+	expDamage.impulse = impulseDir * modImpulseScale;
+	return true;
+}
 
-	if (expDist < (expSpeed * DIRECT_EXPLOSION_DAMAGE_SPEED_SCALE)) {
+void CGameHelper::ApplyExplosionDamage(
+	CUnit* unit,
+	CUnit* owner,
+	const ExplosionDamage& expDamage,
+	const float expSpeed,
+	const DamageArray& damages,
+	const int weaponDefID,
+	const int projectileID
+) {
+	DamageArray expDamages = damages * expDamage.expDistanceMod;
+
+	if (expDamage.expDist < (expSpeed * DIRECT_EXPLOSION_DAMAGE_SPEED_SCALE)) {
 		// damage directly
-		unit->DoDamage(expDamages, expImpulse, owner, weaponDefID, projectileID);
+		unit->DoDamage(expDamages, expDamage.impulse, owner, weaponDefID, projectileID);
 	} else {
 		// damage later
-		waitingDamages[(gs->frameNum + int(expDist / expSpeed) - (DIRECT_EXPLOSION_DAMAGE_SPEED_SCALE - 1)) & (waitingDamages.size() - 1)].emplace_back(std::move(expDamages), expImpulse, ((owner != nullptr)? owner->id: -1), unit->id, weaponDefID, projectileID);
+		waitingDamages[(gs->frameNum + int(expDamage.expDist / expSpeed) - (DIRECT_EXPLOSION_DAMAGE_SPEED_SCALE - 1)) & (waitingDamages.size() - 1)].emplace_back(std::move(expDamages), expDamage.impulse, ((owner != nullptr)? owner->id: -1), unit->id, weaponDefID, projectileID);
 	}
 }
 
 void CGameHelper::DoExplosionDamage(
-	CFeature* feature,
+	CUnit* unit,
 	CUnit* owner,
 	const float3& expPos,
 	const float expRadius,
+	const float expSpeed,
 	const float expEdgeEffect,
+	const bool ignoreOwner,
 	const DamageArray& damages,
 	const int weaponDefID,
 	const int projectileID
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
-	assert(feature != nullptr);
-
-	const LocalModelPiece* lhp = feature->GetLastHitPiece(gs->frameNum);
-	const CollisionVolume* vol = feature->GetCollisionVolume(lhp);
+	assert(unit != nullptr);
 
-	const float3& lhpPos = (lhp != nullptr && vol == lhp->GetCollisionVolume())? lhp->GetAbsolutePos(): ZeroVector;
-	const float3& volPos = vol->GetWorldSpacePos(feature, lhpPos);
+	if (ignoreOwner && (unit == owner))
+		return;
 
-	const float expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(feature, nullptr, expPos) : 0.0f;
-	const float expRim = expDist * expEdgeEffect;
+	ExplosionDamage expDamage;
 
-	if (expDist > expRadius)
+	if (!CalcExplosionDamage(unit, expPos, expRadius, expEdgeEffect, damages, expDamage))
 		return;
 
-	assert(expRadius >= expRim);
+	ApplyExplosionDamage(unit, owner, expDamage, expSpeed, damages, weaponDefID, projectileID);
+}
 
-	const float expDistanceMod = expEdgeEffect == 1.0f || expDist < 1.0f
-		? 1.0f
-		: (expRadius + 0.001f - expDist) / (expRadius + 0.001f - expRim)
-	;
-	const float modImpulseScale = CalcImpulseScale(damages, expDistanceMod);
+void CGameHelper::DoExplosionDamage(
+	CFeature* feature,
+	CUnit* owner,
+	const float3& expPos,
+	const float expRadius,
+	const float expEdgeEffect,
+	const DamageArray& damages,
+	const int weaponDefID,
+	const int projectileID
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(feature != nullptr);
 
-	const float3 impulseDir = (volPos - expPos).SafeNormalize();
-	const float3 expImpulse = impulseDir * modImpulseScale;
+	ExplosionDamage expDamage;
 
-	feature->DoDamage(damages * expDistanceMod, expImpulse, owner, weaponDefID, projectileID);
+	if (!CalcExplosionDamage(feature, expPos, expRadius, expEdgeEffect, damages, expDamage))
+		return;
+
+	feature->DoDamage(damages * expDamage.expDistanceMod, expDamage.impulse, owner, weaponDefID, projectileID);
 }
 
 
@@ -219,13 +238,35 @@ void CGameHelper::DamageObjectsInExplosionRadius(
 	const int weaponDefID
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
+	const BatchedExplosion exp = {
+		params.pos,
+		expRad,
+		params.explosionSpeed,
+		params.edgeEffectiveness,
+		params.damages,
+		((params.owner != nullptr)? params.owner->id: -1),
+		weaponDefID,
+		static_cast<int>(params.projectileID),
+		params.ignoreOwner
+	};
+
+	if (batchingExplosions) {
+		batchedExplosions.push_back(exp);
+		return;
+	}
+
+	DamageObjectsInExplosionRadius(exp, params.owner);
+}
+
+void CGameHelper::DamageObjectsInExplosionRadius(const BatchedExplosion& exp, CUnit* owner)
+{
 	static std::vector<CUnit*> unitCache;
 	static std::vector<CFeature*> featureCache;
 
 	const unsigned int oldNumUnits = unitCache.size();
 	const unsigned int oldNumFeatures = featureCache.size();
 
-	quadField.GetUnitsAndFeaturesColVol(params.pos, expRad, unitCache, featureCache);
+	quadField.GetUnitsAndFeaturesColVol(exp.pos, exp.radius, unitCache, featureCache);
 
 	const unsigned int newNumUnits = unitCache.size();
 	const unsigned int newNumFeatures = featureCache.size();
@@ -237,17 +278,145 @@ void CGameHelper::DamageObjectsInExplosionRadius(
 	//   not keep track of end-markers --> certain objects
 	//   would not be damaged AT ALL (!)
 	for (unsigned int n = oldNumUnits; n < newNumUnits; n++)
-		DoExplosionDamage(unitCache[n], params.owner, params.pos, expRad, params.explosionSpeed, params.edgeEffectiveness, params.ignoreOwner, params.damages, weaponDefID, params.projectileID);
+		DoExplosionDamage(unitCache[n], owner, exp.pos, exp.radius, exp.speed, exp.edgeEffectiveness, exp.ignoreOwner, exp.damages, exp.weaponDefID, exp.projectileID);
 
 	unitCache.resize(oldNumUnits);
 
 	// damage all features within the explosion radius
 	for (unsigned int n = oldNumFeatures; n < newNumFeatures; n++)
-		DoExplosionDamage(featureCache[n], params.owner, params.pos, expRad, params.edgeEffectiveness, params.damages, weaponDefID, params.projectileID);
+		DoExplosionDamage(featureCache[n], owner, exp.pos, exp.radius, exp.edgeEffectiveness, exp.damages, exp.weaponDefID, exp.projectileID);
 
 	featureCache.resize(oldNumFeatures);
 }
 
+void CGameHelper::BeginExplosionBatch()
+{
+	assert(batchedExplosions.empty());
+	batchingExplosions = modInfo.batchExplosionDamage;
+}
+
+void CGameHelper::EndExplosionBatch()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// explosions triggered while applying damage (e.g. by dying units or
+	// Lua callins) are applied immediately, nested as they would be without
+	// the batch
+	batchingExplosions = false;
+
+	if (batchedExplosions.empty())
+		return;
+
+	ResolveExplosionBatch();
+	batchedExplosions.clear();
+}
+
+void CGameHelper::ResolveExplosionBatch()
+{
+	ZoneScopedC(tracy::Color::Goldenrod);
+	static QuadFieldColVolBatch colVolBatch;
+	static std::vector<CUnit*> units;
+	static std::vector<CFeature*> features;
+
+	const size_t numExplosions = batchedExplosions.size();
+
+	if (batchedExplosionHits.size() < numExplosions)
+		batchedExplosionHits.resize(numExplosions);
+
+	// one sweep over the quads for all explosions, yielding the same
+	// objects in the same order as a query per explosion
+	colVolBatch.Clear();
+
+	for (const BatchedExplosion& exp: batchedExplosions) {
+		colVolBatch.AddQuery(exp.pos, exp.radius);
+	}
+
+	quadField.GetUnitsAndFeaturesColVol(colVolBatch);
+
+	for (size_t i = 0; i < numExplosions; i++) {
+		const BatchedExplosion& exp = batchedExplosions[i];
+		auto& hits = batchedExplosionHits[i];
+
+		units.clear();
+		features.clear();
+		hits.clear();
+
+		quadField.GetUnitsAndFeaturesColVol(colVolBatch, i, units, features);
+
+		for (CUnit* u: units) {
+			if (exp.ignoreOwner && u->id == exp.ownerID)
+				continue;
+
+			hits.push_back({u, nullptr, {}, false, false});
+		}
+		for (CFeature* f: features) {
+			hits.push_back({nullptr, f, {}, false, false});
+		}
+	}
+
+	// piece matrices are updated lazily, make sure none are left dirty
+	// before reading them from multiple threads at once
+	for (size_t i = 0; i < numExplosions; i++) {
+		for (BatchedExplosionHit& hit: batchedExplosionHits[i]) {
+			const CSolidObject* object = (hit.unit != nullptr)? static_cast<const CSolidObject*>(hit.unit): hit.feature;
+			const LocalModelPiece* lhp = object->GetLastHitPiece(gs->frameNum);
+
+			if (lhp == nullptr)
+				continue;
+
+			lhp->GetModelSpaceMatrix();
+			hit.lastHitPiece = true;
+		}
+	}
+
+	for_mt(0, numExplosions, [&](const int i) {
+		const BatchedExplosion& exp = batchedExplosions[i];
+
+		for (BatchedExplosionHit& hit: batchedExplosionHits[i]) {
+			if (hit.unit != nullptr) {
+				hit.inRadius = CalcExplosionDamage(hit.unit, exp.pos, exp.radius, exp.edgeEffectiveness, exp.damages, hit.damage);
+			} else {
+				hit.inRadius = CalcExplosionDamage(hit.feature, exp.pos, exp.radius, exp.edgeEffectiveness, exp.damages, hit.damage);
+			}
+		}
+	});
+
+	// apply serially and in explosion order, units before features as in
+	// DamageObjectsInExplosionRadius; chain explosions triggered by this are
+	// applied right away, so everything happens in the unbatched order
+	for (size_t i = 0; i < numExplosions; i++) {
+		const BatchedExplosion& exp = batchedExplosions[i];
+
+		CUnit* owner = unitHandler.GetUnit(exp.ownerID);
+
+		// objects were added or moved (e.g. wrecks of units killed above, or
+		// by Lua), the remaining overlaps are stale and have to be queried
+		if (!quadField.IsValidColVolBatch(colVolBatch)) {
+			DamageObjectsInExplosionRadius(exp, owner);
+			continue;
+		}
+
+		for (BatchedExplosionHit& hit: batchedExplosionHits[i]) {
+			// damage callins can move pieces, measure against the current one
+			if (hit.lastHitPiece) {
+				if (hit.unit != nullptr) {
+					hit.inRadius = CalcExplosionDamage(hit.unit, exp.pos, exp.radius, exp.edgeEffectiveness, exp.damages, hit.damage);
+				} else {
+					hit.inRadius = CalcExplosionDamage(hit.feature, exp.pos, exp.radius, exp.edgeEffectiveness, exp.damages, hit.damage);
+				}
+			}
+
+			if (!hit.inRadius)
+				continue;
+
+			if (hit.unit != nullptr) {
+				ApplyExplosionDamage(hit.unit, owner, hit.damage, exp.speed, exp.damages, exp.weaponDefID, exp.projectileID);
+			} else {
+				hit.feature->DoDamage(exp.damages * hit.damage.expDistanceMod, hit.damage.impulse, owner, exp.weaponDefID, exp.projectileID);
+			}
+		}
+	}
+}
+
 void CGameHelper::Explosion(const CExplosionParams& params) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const DamageArray& damages = params.damages;
@@ -655,6 +824,58 @@ namespace {
 
 
 
+const CGameHelper::TargetCandidateQuad& CGameHelper::GetTargetCandidates(int allyTeam, int quadIdx)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const size_t numQuads = quadField.GetNumQuadsX() * quadField.GetNumQuadsZ();
+	const size_t numAllyTeams = teamHandler.ActiveAllyTeams();
+
+	if (targetCandidateQuads.size() != (numQuads * numAllyTeams)) {
+		targetCandidateQuads.clear();
+		targetCandidateQuads.resize(numQuads * numAllyTeams);
+	}
+
+	const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+	TargetCandidateQuad& tcq = targetCandidateQuads[allyTeam * numQuads + quadIdx];
+
+	if (tcq.unitsRevision == quad.unitsRevision)
+		return tcq;
+
+	tcq.unitsRevision = quad.unitsRevision;
+	tcq.units.clear();
+	tcq.allyTeamOffsets.resize(numAllyTeams + 1);
+
+	for (size_t t = 0; t < numAllyTeams; ++t) {
+		tcq.allyTeamOffsets[t] = tcq.units.size();
+
+		if (teamHandler.Ally(allyTeam, t))
+			continue;
+
+		for (CUnit* unit: quad.teamUnits[t]) {
+			if ((unit->losStatus[allyTeam] & (LOS_INLOS | LOS_INRADAR)) == 0)
+				continue;
+
+			tcq.units.push_back(unit);
+		}
+	}
+
+	tcq.allyTeamOffsets[numAllyTeams] = tcq.units.size();
+	return tcq;
+}
+
+void CGameHelper::InvalidateTargetCandidates(const CUnit* unit, int allyTeam)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const size_t numQuads = quadField.GetNumQuadsX() * quadField.GetNumQuadsZ();
+
+	if (targetCandidateQuads.size() != (numQuads * teamHandler.ActiveAllyTeams()))
+		return;
+
+	for (const int qi: unit->quads) {
+		targetCandidateQuads[allyTeam * numQuads + qi].unitsRevision = -1u;
+	}
+}
+
 size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
 {
 	const CUnit*  weaponOwner = weapon->owner;
@@ -701,14 +922,21 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 			continue;
 
 		for (const int qi: *qfQuery.quads) {
-			const std::vector<CUnit*>& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
+			// visibility was already resolved for our allyteam, possibly by another weapon
+			const TargetCandidateQuad& tcq = helper->GetTargetCandidates(weaponOwner->allyteam, qi);
+
+			// bounds are re-read since a callin below can make another weapon rebuild <tcq>
+			for (unsigned int i = tcq.allyTeamOffsets[t]; i < tcq.allyTeamOffsets[t + 1]; i++) {
+				CUnit* targetUnit = tcq.units[i];
 
-			for (CUnit* targetUnit: allyTeamUnits) {
 				if (targetUnit->tempNum == tempNum)
 					continue;
 
 				targetUnit->tempNum = tempNum;
 
+				// cheap reject before the virtual TestTarget
+				if ((targetUnit->category & weapon->onlyTargetCategory) == 0)
+					continue;
 				if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
 					continue;
 
@@ -1017,40 +1245,6 @@ float4 CGameHelper::BuildPosToRect(const float3& midPoint, int facing, int xsize
 	};
 }
 
-int CGameHelper::GetYardMapIndex(int buildFacing, const int2& yardPos, const int2& xrange, const int2& zrange)
-{
-	RECOIL_DETAILED_TRACY_ZONE;
-	int yardX = yardPos.x - xrange.x;
-	int yardZ = yardPos.y - zrange.x;
-	int yardXR = xrange.y - xrange.x;
-	int yardZR = zrange.y - zrange.x;
-
-	switch (buildFacing) {
-		default: {
-			// FACING_SOUTH don't need to do any remapping
-		} break;
-
-		case FacingMap::FACING_NORTH: {
-			yardX = yardXR - yardX - 1; //mirror yardX
-			yardZ = yardZR - yardZ - 1; //mirror yardZ
-		} break;
-
-		case FacingMap::FACING_EAST: {
-			yardZ = yardZR - yardZ - 1; //mirror yardZ
-			std::swap(yardX , yardZ );  //swap yard{X,Z}
-			std::swap(yardXR, yardZR);  //swap yard{XR,ZR}
-		} break;
-
-		case FacingMap::FACING_WEST: {
-			yardX = yardXR - yardX - 1; //mirror yardX
-			std::swap(yardX , yardZ );  //swap yard{X,Z}
-			std::swap(yardXR, yardZR);  //swap yard{XR,ZR}
-		} break;
-	}
-
-	return yardX + yardXR * yardZ;
-}
-
 
 struct SearchOffset {
 	int dx, dy;
@@ -1263,6 +1457,89 @@ float CGameHelper::GetBuildHeight(const float3& pos, const UnitDef* unitdef, boo
 }
 
 
+bool CGameHelper::HasGeoThermalFeature(const float3& testPos, int xsize, int zsize, int threadOwner)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = threadOwner;
+	quadField.GetFeaturesExact(qfQuery, testPos, std::max(xsize, zsize) * 6);
+
+	const int mindx = xsize * (SQUARE_SIZE >> 1) - (SQUARE_SIZE >> 1);
+	const int mindz = zsize * (SQUARE_SIZE >> 1) - (SQUARE_SIZE >> 1);
+
+	// look for a nearby geothermal feature if we need one
+	for (const CFeature* f: *qfQuery.features) {
+		if (!f->def->geoThermal)
+			continue;
+
+		const float dx = math::fabs(f->pos.x - testPos.x);
+		const float dz = math::fabs(f->pos.z - testPos.z);
+
+		if (dx < mindx && dz < mindz)
+			return true;
+	}
+
+	return false;
+}
+
+int CGameHelper::GetGroundBlockMapsBuffer()
+{
+	// buffer should be the maximum distance given by the movetype using the formula:
+	// maxspeed * modInfo.unitQuadPositionUpdateRate + half footStep + 1
+	// +1 on end is a safety buffer against rounding issues with square placement.
+	// placeholder values are given here for the moment.
+	const int largestMoveTypSizeH = moveDefHandler.GetLargestFootPrintSizeH() + 1;
+	return (SQUARE_SIZE * modInfo.unitQuadPositionUpdateRate * 2 + largestMoveTypSizeH + 1);
+}
+
+void CGameHelper::UpdateGroundBlockMaps(const int2& mins, const int2& maxs, int threadOwner)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// Units update their positions on slow update. Synced code must avoid building and trapping
+	// units - so check that all nearby mobile units have correctly accurate positions up to date.
+	assert(!ThreadPool::inMultiThreadedSection);
+
+	const int bufferSize = GetGroundBlockMapsBuffer();
+	const float3 min((mins.x - bufferSize) * SQUARE_SIZE, 0.f, (mins.y - bufferSize) * SQUARE_SIZE);
+	const float3 max((maxs.x + bufferSize) * SQUARE_SIZE, 0.f, (maxs.y + bufferSize) * SQUARE_SIZE);
+
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = threadOwner;
+	quadField.GetUnitsExact(qfQuery, min, max);
+	for (const CUnit* unit: *qfQuery.units) {
+		if (unit->moveDef != nullptr) 
+			unit->moveType->UpdateGroundBlockMap();
+	}
+}
+
+void CGameHelper::UpdateGroundBlockMaps(const CFootprintClusters& clusters, int threadOwner)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(!ThreadPool::inMultiThreadedSection);
+
+	for (size_t i = 0; i < clusters.GetNumClusters(); i++) {
+		int2 mins;
+		int2 maxs;
+
+		clusters.GetBounds(i, mins, maxs);
+
+		const float3 min(mins.x * SQUARE_SIZE, 0.f, mins.y * SQUARE_SIZE);
+		const float3 max(maxs.x * SQUARE_SIZE, 0.f, maxs.y * SQUARE_SIZE);
+
+		QuadFieldQuery qfQuery;
+		qfQuery.threadOwner = threadOwner;
+		quadField.GetUnitsExact(qfQuery, min, max);
+
+		// the bounds also contain units that are not near any footprint; skip
+		// those so exactly the units a query per footprint returns are updated
+		for (const CUnit* unit: *qfQuery.units) {
+			if (unit->moveDef != nullptr && clusters.IsNear(i, unit->pos.x, unit->pos.z))
+				unit->moveType->UpdateGroundBlockMap();
+		}
+	}
+}
+
+
 CGameHelper::BuildSquareStatus CGameHelper::TestUnitBuildSquare(
 	const BuildInfo& buildInfo,
 	CFeature*& feature,
@@ -1297,54 +1574,11 @@ CGameHelper::BuildSquareStatus CGameHelper::TestUnitBuildSquare(
 
 	BuildSquareStatus testStatus = BUILDSQUARE_OPEN;
 
-	if (buildInfo.def->needGeo) {
+	if (buildInfo.def->needGeo && !HasGeoThermalFeature(testPos, xsize, zsize, threadOwner))
 		testStatus = BUILDSQUARE_BLOCKED;
 
-		QuadFieldQuery qfQuery;
-		qfQuery.threadOwner = threadOwner;
-		quadField.GetFeaturesExact(qfQuery, testPos, std::max(xsize, zsize) * 6);
-
-		const int mindx = xsize * (SQUARE_SIZE >> 1) - (SQUARE_SIZE >> 1);
-		const int mindz = zsize * (SQUARE_SIZE >> 1) - (SQUARE_SIZE >> 1);
-
-		// look for a nearby geothermal feature if we need one
-		for (const CFeature* f: *qfQuery.features) {
-			if (!f->def->geoThermal)
-				continue;
-
-			const float dx = math::fabs(f->pos.x - testPos.x);
-			const float dz = math::fabs(f->pos.z - testPos.z);
-
-			if (dx < mindx && dz < mindz) {
-				testStatus = BUILDSQUARE_OPEN;
-				break;
-			}
-		}
-	}
-
-	// Units update their positions on slow update. Synced code must avoid building and trapping
-	// units - so check that all nearby mobile units have correctly accurate positions up to date.
 	if (synced)
-	{
-		assert(!ThreadPool::inMultiThreadedSection);
-
-		// buffer should be the maximum distance given by the movetype using the formula:
-		// maxspeed * modInfo.unitQuadPositionUpdateRate + half footStep + 1
-		// +1 on end is a safety buffer against rounding issues with square placement.
-		// placeholder values are given here for the moment.
-		const int largestMoveTypSizeH = moveDefHandler.GetLargestFootPrintSizeH() + 1;
-		const int bufferSize = SQUARE_SIZE * modInfo.unitQuadPositionUpdateRate * 2 + largestMoveTypSizeH + 1;
-		const float3 min((x1 - bufferSize) * SQUARE_SIZE, 0.f, (z1 - bufferSize) * SQUARE_SIZE);
-		const float3 max((x2 + bufferSize) * SQUARE_SIZE, 0.f, (z2 + bufferSize) * SQUARE_SIZE);
-
-		QuadFieldQuery qfQuery;
-		qfQuery.threadOwner = threadOwner;
-		quadField.GetUnitsExact(qfQuery, min, max);
-		for (const CUnit* unit: *qfQuery.units) {
-			if (unit->moveDef != nullptr) 
-				unit->moveType->UpdateGroundBlockMap();
-		}
-	}
+		UpdateGroundBlockMaps({x1, z1}, {x2, z2}, threadOwner);
 
 	if (commands != nullptr) {
 		// this is only called in unsynced context (ShowUnitBuildSquare)
@@ -1402,16 +1636,35 @@ CGameHelper::BuildSquareStatus CGameHelper::TestUnitBuildSquare(
 		}
 
 		// this can be called in either context
-		for (int z = z1; z < z2; z++) {
-			for (int x = x1; x < x2; x++) {
-				sqrPos.x = x * SQUARE_SIZE;
-				sqrPos.z = z * SQUARE_SIZE;
+		testStatus = TestFootprintSquares(buildInfo, moveDef, sqrPos.y, xrange, zrange, feature, allyteam, synced, testStatus);
+	}
 
-				const BuildSquareStatus sqrStatus = TestBuildSquare(sqrPos, xrange, zrange, buildInfo, moveDef, feature, allyteam, synced);
+	return testStatus;
+}
 
-				if ((testStatus = std::min(testStatus, sqrStatus)) == BUILDSQUARE_BLOCKED) {
-					return BUILDSQUARE_BLOCKED;
-				}
+CGameHelper::BuildSquareStatus CGameHelper::TestFootprintSquares(
+	const BuildInfo& buildInfo,
+	const MoveDef* moveDef,
+	float buildHeight,
+	const int2& xrange,
+	const int2& zrange,
+	CFeature*& feature,
+	int allyteam,
+	bool synced,
+	BuildSquareStatus testStatus
+) {
+	float3 sqrPos;
+	sqrPos.y = buildHeight;
+
+	for (int z = zrange.x; z < zrange.y; z++) {
+		for (int x = xrange.x; x < xrange.y; x++) {
+			sqrPos.x = x * SQUARE_SIZE;
+			sqrPos.z = z * SQUARE_SIZE;
+
+			const BuildSquareStatus sqrStatus = TestBuildSquare(sqrPos, xrange, zrange, buildInfo, moveDef, feature, allyteam, synced);
+
+			if ((testStatus = std::min(testStatus, sqrStatus)) == BUILDSQUARE_BLOCKED) {
+				return BUILDSQUARE_BLOCKED;
 			}
 		}
 	}
@@ -1419,6 +1672,109 @@ CGameHelper::BuildSquareStatus CGameHelper::TestUnitBuildSquare(
 	return testStatus;
 }
 
+
+void CGameHelper::TestUnitBuildSquares(
+	const UnitDef* unitDef,
+	int buildFacing,
+	const std::vector<float3>& buildPositions,
+	int allyteam,
+	bool synced,
+	std::vector<BuildSquareStatus>& statuses,
+	std::vector<CFeature*>& features,
+	int threadOwner
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	statuses.clear();
+	statuses.resize(buildPositions.size(), BUILDSQUARE_BLOCKED);
+	features.clear();
+	features.resize(buildPositions.size(), nullptr);
+
+	const BuildInfo buildInfo(unitDef, ZeroVector, buildFacing);
+	const MoveDef* moveDef = (unitDef->pathType != -1U) ? moveDefHandler.GetMoveDefByPathType(unitDef->pathType) : nullptr;
+
+	const int xsize = buildInfo.GetXSize();
+	const int zsize = buildInfo.GetZSize();
+
+	// footprint corners of all candidates, and of those that lie within the map
+	std::vector<int2> allCorners(buildPositions.size());
+	std::vector<int2> corners(buildPositions.size(), {-1, -1});
+
+	int2 mins = {mapDims.mapx, mapDims.mapy};
+	int2 maxs = {-1, -1};
+
+	for (size_t i = 0; i < buildPositions.size(); i++) {
+		const int x1 = int(buildPositions[i].x / SQUARE_SIZE) - (xsize >> 1), x2 = x1 + xsize;
+		const int z1 = int(buildPositions[i].z / SQUARE_SIZE) - (zsize >> 1), z2 = z1 + zsize;
+
+		allCorners[i] = {x1, z1};
+
+		if (static_cast<unsigned>(x1) > mapDims.mapx || static_cast<unsigned>(x2) > mapDims.mapx ||
+			static_cast<unsigned>(z1) > mapDims.mapy || static_cast<unsigned>(z2) > mapDims.mapy) {
+			continue;
+		}
+
+		corners[i] = {x1, z1};
+
+		mins.x = std::min(mins.x, x1);
+		mins.y = std::min(mins.y, z1);
+		maxs.x = std::max(maxs.x, x1);
+		maxs.y = std::max(maxs.y, z1);
+	}
+
+	// one query per cluster of candidates instead of one per candidate; like
+	// TestUnitBuildSquare this also covers candidates outside the map
+	if (synced) {
+		CFootprintClusters clusters;
+		clusters.Init(allCorners, {xsize, zsize}, GetGroundBlockMapsBuffer());
+
+		UpdateGroundBlockMaps(clusters, threadOwner);
+	}
+
+	if (maxs.x < 0)
+		return;
+
+	// slopes are not summarized: CheckTerrainConstraints only tests them for
+	// mobile unitdefs (buildings test maxHeightDif, which the height range
+	// covers), and blocking is not cached in bitplanes since it depends on
+	// the LOS, facing and moveDef of each candidate; the yardmap planes are
+	// already precompiled per unitdef and the per-square tests read them
+	const CFootprintHeightRanges heightRanges(readMap->GetSharedCenterHeightMap(synced), mapDims.mapx, mins, maxs, {xsize, zsize}, buildPositions.size());
+
+	for (size_t i = 0; i < buildPositions.size(); i++) {
+		const int2 corner = corners[i];
+
+		if (corner.x < 0)
+			continue;
+
+		const float3& testPos = buildPositions[i];
+		const float buildHeight = GetBuildHeight(testPos, unitDef, synced);
+
+		// the lowest and highest squares are real squares of the footprint, reject
+		// if either fails the height-only part of TestBuildSquare's terrain check
+		const float2 heightRange = heightRanges.Get(corner);
+		constexpr float noSlope = -std::numeric_limits<float>::infinity();
+
+		if (!CheckTerrainConstraints(unitDef, moveDef, buildHeight, heightRange.x, noSlope))
+			continue;
+		if (!CheckTerrainConstraints(unitDef, moveDef, buildHeight, heightRange.y, noSlope))
+			continue;
+
+		if (unitDef->needGeo && !HasGeoThermalFeature(testPos, xsize, zsize, threadOwner))
+			continue;
+
+		BuildInfo candidate = buildInfo;
+		candidate.pos = testPos;
+
+		const int2 xrange = {corner.x, corner.x + xsize};
+		const int2 zrange = {corner.y, corner.y + zsize};
+
+		statuses[i] = TestFootprintSquares(candidate, moveDef, buildHeight, xrange, zrange, features[i], allyteam, synced, BUILDSQUARE_OPEN);
+
+		if (statuses[i] == BUILDSQUARE_BLOCKED)
+			features[i] = nullptr;
+	}
+}
+
 CGameHelper::BuildSquareStatus CGameHelper::TestBuildSquare(
 	const float3& pos,
 	const int2& xrange,
@@ -1448,10 +1804,13 @@ CGameHelper::BuildSquareStatus CGameHelper::TestBuildSquare(
 	const int yardxpos = unsigned(pos.x) / SQUARE_SIZE;
 	const int yardypos = unsigned(pos.z) / SQUARE_SIZE;
 	const int2 yardpos = { yardxpos, yardypos };
-	const int ymIdx = GetYardMapIndex(buildInfo.buildFacing, yardpos, xrange, zrange);
+
+	// squares of the precompiled yardmap are relative to the footprint corner
+	const CYardMapMasks* yardMapMasks = unitDef->GetYardMapMasksPtr();
+	const int2 ymPos = { yardxpos - xrange.x, yardypos - zrange.x };
 
 	if (yardmapStatusEffectsMap.AreAnyFlagsSet(sqx, sqz, YardmapStatusEffectsMap::BLOCK_BUILDING)) {
-		bool isStackable = (!unitDef->yardmap.empty() && unitDef->yardmap[ymIdx] <= YardmapStates::YARDMAP_STACKABLE);
+		bool isStackable = (yardMapMasks != nullptr && yardMapMasks->TestSquare(buildInfo.buildFacing, ymPos.x, ymPos.y, CYardMapMasks::PLANE_STACKABLE));
 		if ( !isStackable && (synced || ((allyteam < 0) || losHandler->InLos(pos, allyteam))) ) {
 			return BUILDSQUARE_BLOCKED;
 		}
@@ -1480,7 +1839,7 @@ CGameHelper::BuildSquareStatus CGameHelper::TestBuildSquare(
 			assert(u);
 			if ((allyteam < 0) || (u->losStatus[allyteam] & LOS_INLOS)) {
 				if (so->immobile) {
-					bool isStackable = (!unitDef->yardmap.empty() && unitDef->yardmap[ymIdx] <= YardmapStates::YARDMAP_GEOSTACKABLE);
+					bool isStackable = (yardMapMasks != nullptr && yardMapMasks->TestSquare(buildInfo.buildFacing, ymPos.x, ymPos.y, CYardMapMasks::PLANE_GEOSTACKABLE));
 					ret = isStackable ? BUILDSQUARE_OPEN :
 							(TestBlockSquareForBuildOnly(so, yardpos) ? BUILDSQUARE_OPEN : BUILDSQUARE_BLOCKED);
 				} else {
@@ -1534,17 +1893,13 @@ bool CGameHelper::TestBlockSquareForBuildOnly(
 	auto so = blockingObject;
 	
 	// check whether the current building allows for building in the given square.
-	auto soYardMap = so->GetBlockMap();
-	if (soYardMap != nullptr) {
-		const int sox1 = int(so->pos.x / SQUARE_SIZE) - (so->xsize >> 1), sox2 = sox1 + so->xsize;
-		const int soz1 = int(so->pos.z / SQUARE_SIZE) - (so->zsize >> 1), soz2 = soz1 + so->zsize;
-		const int2 soxrange = int2(sox1, sox2);
-		const int2 sozrange = int2(soz1, soz2);
-
-		auto soYmIdx = GetYardMapIndex(so->buildFacing, yardpos, soxrange, sozrange);
-		if (soYardMap[soYmIdx] == YardmapStates::YARDMAP_BUILDONLY)
-			// While the square is blocked for walking, it is open for building.
-			ret = true;
+	auto soYardMapMasks = so->GetYardMapMasks();
+	if (soYardMapMasks != nullptr) {
+		const int sox1 = int(so->pos.x / SQUARE_SIZE) - (so->xsize >> 1);
+		const int soz1 = int(so->pos.z / SQUARE_SIZE) - (so->zsize >> 1);
+
+		// While the square is blocked for walking, it is open for building.
+		ret = soYardMapMasks->TestSquare(so->buildFacing, yardpos.x - sox1, yardpos.y - soz1, CYardMapMasks::PLANE_BUILDONLY);
 	}
 
 	return ret;
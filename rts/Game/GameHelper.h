@@ -21,6 +21,7 @@ class CWeapon;
 class CSolidObject;
 class CFeature;
 class CMobileCAI;
+class CFootprintClusters;
 struct UnitDef;
 struct MoveDef;
 struct BuildInfo;
@@ -86,12 +87,6 @@ public:
 	static float3 Pos2BuildPos(const BuildInfo& buildInfo, bool synced);
 	static float4 BuildPosToRect(const float3& midPoint, int facing, int xsize, int zsize);
 
-	static int GetYardMapIndex(int buildFacing,
-		const int2& yardPos,
-		const int2& xrange,
-		const int2& zrange
-	);
-
 	///< test whether a blocked map square has a build override
 	static bool TestBlockSquareForBuildOnly(
 		const CSolidObject *blockingObject,
@@ -123,6 +118,22 @@ public:
 		int threadOwner = 0
 	);
 
+	/**
+	 * @brief test many (already snapped) build positions of one unitdef and facing
+	 * statuses match TestUnitBuildSquare for every position, features are only
+	 * reported for positions that are not blocked
+	 */
+	static void TestUnitBuildSquares(
+		const UnitDef* unitDef,
+		int buildFacing,
+		const std::vector<float3>& buildPositions,
+		int allyteam,
+		bool synced,
+		std::vector<BuildSquareStatus>& statuses,
+		std::vector<CFeature*>& features,
+		int threadOwner = 0
+	);
+
 	static float GetBuildHeight(const float3& pos, const UnitDef* unitdef, bool synced = true);
 	static Command GetBuildCommand(const float3& pos, const float3& dir);
 
@@ -150,6 +161,24 @@ public:
 
 	static size_t GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
 
+	/**
+	 * Enemies visible (in LOS or radar) to one allyteam within one QuadField
+	 * quad, grouped by their own allyteam: [offsets[t], offsets[t + 1]).
+	 * Built on first use and shared by all weapons of that allyteam until a
+	 * unit enters or leaves the quad, or the LOS status of one in it changes.
+	 */
+	struct TargetCandidateQuad {
+		std::vector<CUnit*> units;
+		std::vector<unsigned int> allyTeamOffsets;
+
+		// CQuadField::Quad::unitsRevision these were collected at
+		unsigned int unitsRevision = -1u;
+	};
+
+	const TargetCandidateQuad& GetTargetCandidates(int allyTeam, int quadIdx);
+	/// called when the LOS or radar status of <unit> changes for <allyTeam>
+	void InvalidateTargetCandidates(const CUnit* unit, int allyTeam);
+
 	void Init();
 	void Kill();
 	void Update();
@@ -182,7 +211,93 @@ public:
 	void DamageObjectsInExplosionRadius(const CExplosionParams& params, const float expRad, const int weaponDefID);
 	void Explosion(const CExplosionParams& params);
 
+	/**
+	 * While a batch is open, radius damage of synced explosions is deferred
+	 * until EndExplosionBatch, which finds the objects in range of all of
+	 * them with one QuadField sweep, computes their damage in parallel and
+	 * then applies it in the original order. Explosions this triggers (e.g.
+	 * death explosions) are applied immediately, nested as without a batch.
+	 * Only has an effect if the game enables modInfo.batchExplosionDamage.
+	 */
+	void BeginExplosionBatch();
+	void EndExplosionBatch();
+
 private:
+	static bool HasGeoThermalFeature(const float3& testPos, int xsize, int zsize, int threadOwner);
+	///< distance (in squares) around a footprint within which UpdateGroundBlockMaps updates units
+	static int GetGroundBlockMapsBuffer();
+	///< brings the ground-block maps of mobile units near the squares [mins, maxs) up to date
+	static void UpdateGroundBlockMaps(const int2& mins, const int2& maxs, int threadOwner);
+	///< as above, for the units near any footprint of <clusters>
+	static void UpdateGroundBlockMaps(const CFootprintClusters& clusters, int threadOwner);
+
+	///< per-square part of TestUnitBuildSquare for a footprint within the map
+	static BuildSquareStatus TestFootprintSquares(
+		const BuildInfo& buildInfo,
+		const MoveDef* moveDef,
+		float buildHeight,
+		const int2& xrange,
+		const int2& zrange,
+		CFeature*& feature,
+		int allyteam,
+		bool synced,
+		BuildSquareStatus testStatus
+	);
+
+	struct ExplosionDamage {
+		float expDist;
+		float expDistanceMod;
+		float3 impulse;
+	};
+
+	struct BatchedExplosion {
+		float3 pos;
+		float radius;
+		float speed;
+		float edgeEffectiveness;
+
+		DamageArray damages;
+
+		int ownerID;
+		int weaponDefID;
+		int projectileID;
+
+		bool ignoreOwner;
+	};
+
+	struct BatchedExplosionHit {
+		CUnit* unit;
+		CFeature* feature;
+
+		ExplosionDamage damage;
+		bool inRadius;
+		// damage is measured against a (movable) piece volume
+		bool lastHitPiece;
+	};
+
+	template<typename T>
+	static bool CalcExplosionDamage(
+		const T* object,
+		const float3& expPos,
+		const float expRadius,
+		const float expEdgeEffect,
+		const DamageArray& damages,
+		ExplosionDamage& expDamage
+	);
+
+	void ApplyExplosionDamage(
+		CUnit* unit,
+		CUnit* owner,
+		const ExplosionDamage& expDamage,
+		const float expSpeed,
+		const DamageArray& damages,
+		const int weaponDefID,
+		const int projectileID
+	);
+
+	void DamageObjectsInExplosionRadius(const BatchedExplosion& exp, CUnit* owner);
+	void ResolveExplosionBatch();
+
 	struct WaitingDamage {
 		WaitingDamage(const DamageArray& _damage, const float3& _impulse, int _attackerID, int _targetID, int _weaponID, int _projectileID)
 		: attackerID(_attackerID)
@@ -205,6 +320,13 @@ private:
 	std::array<std::vector<WaitingDamage>, 128> waitingDamages;
 	static_assert (std::has_single_bit(std::tuple_size_v <decltype(waitingDamages)>), "Size is used in bit hax and must be 2^N");
 
+	std::vector<BatchedExplosion> batchedExplosions;
+	std::vector< std::vector<BatchedExplosionHit> > batchedExplosionHits;
+
+	bool batchingExplosions = false;
+
+	std::vector<TargetCandidateQuad> targetCandidateQuads;
+
 public:
 	std::vector<int> targetUnitIDs; // GetEnemyUnits{NoLosTest}
 	std::vector<std::pair<float, CUnit*>> targetPairs; // GenerateWeaponTargets
@@ -10,6 +10,7 @@
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GeometricObjects.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
@@ -184,6 +185,133 @@ inline static bool TestTrajectoryConeHelper(
 
 
 
+/**
+ * helper for TraceRay and TraceBeam
+ * shortens <traceLength> if feature <f> is hit closer than that
+ */
+inline static bool TraceRayFeature(
+	const float3& pos,
+	const float3& dir,
+	float& traceLength,
+	CFeature* f,
+	CollisionQuery& cq,
+	CollisionQuery* hitColQuery
+) {
+	// NOTE:
+	//   if f is non-blocking, ProjectileHandler will not test
+	//   for collisions with projectiles so we can skip it here
+	if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+		return false;
+
+	if (!CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true))
+		return false;
+
+	const float len = cq.GetHitPosDist(pos, dir);
+
+	// we want the closest feature (intersection point) on the ray
+	if (len >= traceLength)
+		return false;
+
+	traceLength = len;
+	*hitColQuery = cq;
+	return true;
+}
+
+/**
+ * helper for TraceRay and TraceBeam
+ * shortens <traceLength> if unit <u> is scanned for and hit closer than that
+ */
+inline static bool TraceRayUnit(
+	const float3& pos,
+	const float3& dir,
+	float& traceLength,
+	int traceFlags,
+	const CUnit* owner,
+	CUnit* u,
+	CollisionQuery& cq,
+	CollisionQuery* hitColQuery
+) {
+	if (u == owner)
+		return false;
+
+	if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+		return false;
+
+	bool doHitTest = false;
+
+	doHitTest |= (((traceFlags & Collision::NOFRIENDLIES) == 0) && u->allyteam == owner->allyteam);
+	doHitTest |= (((traceFlags & Collision::NOENEMIES   ) == 0) && u->allyteam != owner->allyteam);
+	doHitTest |= (((traceFlags & Collision::NONEUTRALS  ) == 0) && u->IsNeutral());
+	doHitTest |= (((traceFlags & Collision::NOCLOAKED   ) == 0) && u->IsCloaked());
+
+	if (!doHitTest)
+		return false;
+
+	if (!CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true))
+		return false;
+
+	const float len = cq.GetHitPosDist(pos, dir);
+
+	// we want the closest unit (intersection point) on the ray
+	if (len >= traceLength)
+		return false;
+
+	traceLength = len;
+	*hitColQuery = cq;
+	return true;
+}
+
+/**
+ * helper for TraceRayShields and TraceBeamShields
+ * inserts repulser <r> into <hitShields> (sorted by distance) if it is hit
+ */
+inline static void TraceRayShield(
+	const CWeapon* emitter,
+	const float3& start,
+	const float3& dir,
+	float length,
+	CPlasmaRepulser* r,
+	CollisionQuery& cq,
+	std::vector<TraceRay::SShieldDist>& hitShields
+) {
+	if (!r->CanIntercept(emitter->weaponDef->interceptedByShieldType, emitter->owner->allyteam))
+		return;
+
+	if (!CCollisionHandler::DetectHit(r->owner, &r->collisionVolume, r->owner->GetTransformMatrix(true), start, start + dir * length, &cq, true))
+		return;
+
+	if (cq.InsideHit() && r->weaponDef->exteriorShield)
+		return;
+
+	const float len = cq.GetHitPosDist(start, dir);
+
+	if (len <= 0.0f)
+		return;
+
+	const auto hitCmp = [](const float a, const TraceRay::SShieldDist& b) { return (a < b.dist); };
+	const auto insPos = std::upper_bound(hitShields.begin(), hitShields.end(), len, hitCmp);
+
+	hitShields.insert(insPos, {r, len});
+}
+
+/**
+ * helper for TraceRay and TraceBeam
+ * shortens <traceLength> if the ground is hit closer than that
+ */
+inline static bool TraceRayGround(const float3& pos, const float3& dir, float& traceLength)
+{
+	const float groundLength = CGround::LineGroundCol(pos, pos + dir * traceLength);
+
+	if (traceLength > groundLength && groundLength > 0.0f) {
+		traceLength = groundLength;
+		return true;
+	}
+
+	return false;
+}
+
+
+
 //////////////////////////////////////////////////////////////////////
 // Raytracing
 //////////////////////////////////////////////////////////////////////
@@ -246,24 +374,8 @@ float TraceRay(
 				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
 				for (CFeature* f: quad.features) {
-					// NOTE:
-					//   if f is non-blocking, ProjectileHandler will not test
-					//   for collisions with projectiles so we can skip it here
-					if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
-						continue;
-
-					if (CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
-
-						// we want the closest feature (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
-
-						traceLength = len;
-
+					if (TraceRayFeature(pos, dir, traceLength, f, cq, hitColQuery))
 						hitFeature = f;
-						*hitColQuery = cq;
-					}
 				}
 			}
 		}
@@ -274,34 +386,8 @@ float TraceRay(
 				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
 				for (CUnit* u: quad.units) {
-					if (u == owner)
-						continue;
-
-					if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
-						continue;
-
-					bool doHitTest = false;
-
-					doHitTest |= (scanForAllies   && u->allyteam == owner->allyteam);
-					doHitTest |= (scanForEnemies  && u->allyteam != owner->allyteam);
-					doHitTest |= (scanForNeutrals && u->IsNeutral());
-					doHitTest |= (scanForCloaked  && u->IsCloaked());
-
-					if (!doHitTest)
-						continue;
-
-					if (CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
-
-						// we want the closest unit (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
-
-						traceLength = len;
-
+					if (TraceRayUnit(pos, dir, traceLength, traceFlags, owner, u, cq, hitColQuery))
 						hitUnit = u;
-						*hitColQuery = cq;
-					}
 				}
 			}
 
@@ -312,16 +398,10 @@ float TraceRay(
 		}
 	}
 
-	if (scanForGround) {
-		// ground intersection
-		const float groundLength = CGround::LineGroundCol(pos, pos + dir * traceLength);
-
-		if (traceLength > groundLength && groundLength > 0.0f) {
-			traceLength = groundLength;
-
-			hitUnit = nullptr;
-			hitFeature = nullptr;
-		}
+	// ground intersection
+	if (scanForGround && TraceRayGround(pos, dir, traceLength)) {
+		hitUnit = nullptr;
+		hitFeature = nullptr;
 	}
 
 	// no intersection if no decrease in length
@@ -346,25 +426,130 @@ void TraceRayShields(
 		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
 		for (CPlasmaRepulser* r: quad.repulsers) {
-			if (!r->CanIntercept(emitter->weaponDef->interceptedByShieldType, emitter->owner->allyteam))
+			TraceRayShield(emitter, start, dir, length, r, cq, hitShields);
+		}
+	}
+}
+
+
+void GetBeamCandidates(
+	const float3& pos,
+	const float3& dir,
+	float length,
+	SBeamCandidates& candidates
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	candidates.units.clear();
+	candidates.features.clear();
+	candidates.repulsers.clear();
+
+	if (dir == ZeroVector)
+		return;
+
+	const int tempNum = gs->GetTempNum();
+
+	QuadFieldQuery qfQuery;
+	quadField.GetQuadsOnRay(qfQuery, pos, dir, length);
+
+	for (const int quadIdx: *qfQuery.quads) {
+		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+
+		// objects overlapping several quads along the ray are listed once
+		for (CFeature* f: quad.features) {
+			if (f->tempNum == tempNum)
 				continue;
 
-			if (CCollisionHandler::DetectHit(r->owner, &r->collisionVolume, r->owner->GetTransformMatrix(true), start, start + dir * length, &cq, true)) {
-				if (cq.InsideHit() && r->weaponDef->exteriorShield)
-					continue;
+			f->tempNum = tempNum;
+			candidates.features.push_back(f);
+		}
 
-				const float len = cq.GetHitPosDist(start, dir);
+		for (CUnit* u: quad.units) {
+			if (u->tempNum == tempNum)
+				continue;
 
-				if (len <= 0.0f)
-					continue;
+			u->tempNum = tempNum;
+			candidates.units.push_back(u);
+		}
 
-				const auto hitCmp = [](const float a, const SShieldDist& b) { return (a < b.dist); };
-				const auto insPos = std::upper_bound(hitShields.begin(), hitShields.end(), len, hitCmp);
+		for (CPlasmaRepulser* r: quad.repulsers) {
+			if (r->tempNum == tempNum)
+				continue;
 
-				hitShields.insert(insPos, {r, len});
-			}
+			r->tempNum = tempNum;
+			candidates.repulsers.push_back(r);
+		}
+	}
+}
+
+float TraceBeam(
+	const SBeamCandidates& candidates,
+	const float3& pos,
+	const float3& dir,
+	float traceLength,
+	int traceFlags,
+	const CUnit* owner,
+	CUnit*& hitUnit,
+	CFeature*& hitFeature,
+	CollisionQuery* hitColQuery
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(owner != nullptr);
+
+	const bool scanForFeatures = ((traceFlags & Collision::NOFEATURES) == 0);
+	const bool scanForAnyUnits = ((traceFlags & (Collision::NOUNITS | Collision::NOCLOAKED)) != (Collision::NOUNITS | Collision::NOCLOAKED));
+	const bool scanForGround   = ((traceFlags & Collision::NOGROUND) == 0);
+
+	hitFeature = nullptr;
+	hitUnit = nullptr;
+
+	if (dir == ZeroVector)
+		return -1.0f;
+
+	CollisionQuery cq;
+
+	if (hitColQuery == nullptr)
+		hitColQuery = &cq;
+
+	if (scanForFeatures) {
+		for (CFeature* f: candidates.features) {
+			if (TraceRayFeature(pos, dir, traceLength, f, cq, hitColQuery))
+				hitFeature = f;
 		}
 	}
+
+	if (scanForAnyUnits) {
+		for (CUnit* u: candidates.units) {
+			if (TraceRayUnit(pos, dir, traceLength, traceFlags, owner, u, cq, hitColQuery))
+				hitUnit = u;
+		}
+
+		// units override features, so feature != null implies no unit was hit
+		if (hitUnit != nullptr)
+			hitFeature = nullptr;
+	}
+
+	if (scanForGround && TraceRayGround(pos, dir, traceLength)) {
+		hitUnit = nullptr;
+		hitFeature = nullptr;
+	}
+
+	return traceLength;
+}
+
+void TraceBeamShields(
+	const SBeamCandidates& candidates,
+	const CWeapon* emitter,
+	const float3& start,
+	const float3& dir,
+	float length,
+	std::vector<SShieldDist>& hitShields
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	CollisionQuery cq;
+
+	for (CPlasmaRepulser* r: candidates.repulsers) {
+		TraceRayShield(emitter, start, dir, length, r, cq, hitShields);
+	}
 }
 
 
@@ -33,6 +33,13 @@ namespace TraceRay {
 		float dist;
 	};
 
+	// objects a beam might hit, each listed once in quad order
+	struct SBeamCandidates {
+		std::vector<CUnit*> units;
+		std::vector<CFeature*> features;
+		std::vector<CPlasmaRepulser*> repulsers;
+	};
+
 	float TraceRay(
 		const float3& pos,
 		const float3& dir,
@@ -63,6 +70,38 @@ namespace TraceRay {
 		std::vector<SShieldDist>& hitShields
 	);
 
+	/**
+	 * Gathers the units, features and shields along a beam with a single
+	 * QuadField traversal, shared by TraceBeam and TraceBeamShields for
+	 * any length up to @c length. Unlike TraceRay, objects that overlap
+	 * several quads are only tested once.
+	 */
+	void GetBeamCandidates(
+		const float3& pos,
+		const float3& dir,
+		float length,
+		SBeamCandidates& candidates
+	);
+	float TraceBeam(
+		const SBeamCandidates& candidates,
+		const float3& pos,
+		const float3& dir,
+		float traceLength,
+		int traceFlags,
+		const CUnit* owner,
+		CUnit*& hitUnit,
+		CFeature*& hitFeature,
+		CollisionQuery* hitColQuery = nullptr
+	);
+	void TraceBeamShields(
+		const SBeamCandidates& candidates,
+		const CWeapon* emitter,
+		const float3& start,
+		const float3& dir,
+		float length,
+		std::vector<SShieldDist>& hitShields
+	);
+
 	float GuiTraceRay(
 		const float3& start,
 		const float3& dir,
@@ -1619,6 +1619,139 @@ void CLuaHandle::UnitLeftLos(const CUnit* unit, int allyTeam)
 }
 
 
+/******************************************************************************/
+
+void CLuaHandle::UnitBatchCallIn(const LuaHashString& hs, const std::vector<SUnitEvent>& events, bool losEvent)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 7, __func__);
+	if (!hs.GetGlobalFunc(L))
+		return;
+
+	const auto PushArray = [&](int SUnitEvent::* member) {
+		lua_createtable(L, events.size(), 0);
+
+		for (size_t i = 0; i < events.size(); i++) {
+			lua_pushnumber(L, events[i].*member);
+			lua_rawseti(L, -2, i + 1);
+		}
+	};
+
+	int numArgs = 0;
+
+	if (losEvent) {
+		// same argument order as the per-unit LOS callins
+		PushArray(&SUnitEvent::unitID);
+		PushArray(&SUnitEvent::unitTeam);
+		numArgs = 2;
+
+		if (GetHandleFullRead(L)) {
+			PushArray(&SUnitEvent::allyTeam);
+			PushArray(&SUnitEvent::unitDefID);
+			numArgs = 4;
+		}
+	} else {
+		PushArray(&SUnitEvent::unitID);
+		PushArray(&SUnitEvent::unitDefID);
+		PushArray(&SUnitEvent::unitTeam);
+		numArgs = 3;
+	}
+
+	// call the routine
+	RunCallIn(L, hs, numArgs, 0);
+}
+
+
+/***
+ * Batched form of `UnitEnteredRadar`, called once per frame with all units that entered radar of a readable allyteam during the frame.
+ *
+ * Only available to unsynced code. Units may have died since the event occurred.
+ *
+ * @function Callins:UnitEnteredRadarBatch
+ * @param unitIDs integer[]
+ * @param unitTeams integer[]
+ * @param allyTeams integer[]
+ * @param unitDefIDs integer[]
+ */
+void CLuaHandle::UnitEnteredRadarBatch(const std::vector<SUnitEvent>& events)
+{
+	static const LuaHashString hs(__func__);
+	UnitBatchCallIn(hs, events, true);
+}
+
+
+/***
+ * Batched form of `UnitEnteredLos`, called once per frame with all units that entered LOS of a readable allyteam during the frame.
+ *
+ * Only available to unsynced code. Units may have died since the event occurred.
+ *
+ * @function Callins:UnitEnteredLosBatch
+ * @param unitIDs integer[]
+ * @param unitTeams integer[]
+ * @param allyTeams integer[]
+ * @param unitDefIDs integer[]
+ */
+void CLuaHandle::UnitEnteredLosBatch(const std::vector<SUnitEvent>& events)
+{
+	static const LuaHashString hs(__func__);
+	UnitBatchCallIn(hs, events, true);
+}
+
+
+/***
+ * Batched form of `UnitLeftRadar`, called once per frame with all units that left radar of a readable allyteam during the frame.
+ *
+ * Only available to unsynced code. Units may have died since the event occurred.
+ *
+ * @function Callins:UnitLeftRadarBatch
+ * @param unitIDs integer[]
+ * @param unitTeams integer[]
+ * @param allyTeams integer[]
+ * @param unitDefIDs integer[]
+ */
+void CLuaHandle::UnitLeftRadarBatch(const std::vector<SUnitEvent>& events)
+{
+	static const LuaHashString hs(__func__);
+	UnitBatchCallIn(hs, events, true);
+}
+
+
+/***
+ * Batched form of `UnitLeftLos`, called once per frame with all units that left LOS of a readable allyteam during the frame.
+ *
+ * Only available to unsynced code. Units may have died since the event occurred.
+ *
+ * @function Callins:UnitLeftLosBatch
+ * @param unitIDs integer[]
+ * @param unitTeams integer[]
+ * @param allyTeams integer[]
+ * @param unitDefIDs integer[]
+ */
+void CLuaHandle::UnitLeftLosBatch(const std::vector<SUnitEvent>& events)
+{
+	static const LuaHashString hs(__func__);
+	UnitBatchCallIn(hs, events, true);
+}
+
+
+/***
+ * Called once per frame with all readable units that moved during the frame.
+ *
+ * Only available to unsynced code. Units may have died since the event occurred.
+ *
+ * @function Callins:UnitMovedBatch
+ * @param unitIDs integer[]
+ * @param unitDefIDs integer[]
+ * @param unitTeams integer[]
+ */
+void CLuaHandle::UnitMovedBatch(const std::vector<SUnitEvent>& events)
+{
+	static const LuaHashString hs(__func__);
+	UnitBatchCallIn(hs, events, false);
+}
+
+
 /******************************************************************************
  * Transport
  * @section transport
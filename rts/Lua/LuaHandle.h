@@ -154,6 +154,12 @@ class CLuaHandle : public CEventClient
 		void UnitLeftRadar(const CUnit* unit, int allyTeam) override;
 		void UnitLeftLos(const CUnit* unit, int allyTeam) override;
 
+		void UnitEnteredRadarBatch(const std::vector<SUnitEvent>& events) override;
+		void UnitEnteredLosBatch(const std::vector<SUnitEvent>& events) override;
+		void UnitLeftRadarBatch(const std::vector<SUnitEvent>& events) override;
+		void UnitLeftLosBatch(const std::vector<SUnitEvent>& events) override;
+		void UnitMovedBatch(const std::vector<SUnitEvent>& events) override;
+
 		void UnitEnteredUnderwater(const CUnit* unit) override;
 		void UnitEnteredWater(const CUnit* unit) override;
 		void UnitEnteredAir(const CUnit* unit) override;
@@ -322,6 +328,7 @@ class CLuaHandle : public CEventClient
 		bool RunCallIn(lua_State* L, const LuaHashString& hs, int inArgs, int outArgs);
 
 		void LosCallIn(const LuaHashString& hs, const CUnit* unit, int allyTeam);
+		void UnitBatchCallIn(const LuaHashString& hs, const std::vector<SUnitEvent>& events, bool losEvent);
 		void UnitCallIn(const LuaHashString& hs, const CUnit* unit);
 
 		void RunDrawCallIn(const LuaHashString& hs);
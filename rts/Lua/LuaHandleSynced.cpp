@@ -131,6 +131,7 @@ bool CUnsyncedLuaHandle::Init(std::string code, const std::string& file)
 		if (!AddEntriesToTable(L, "FeatureDefs",   LuaFeatureDefs::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "Script",          LuaInterCall::PushEntriesUnsynced)) KILL
 		if (!AddEntriesToTable(L, "Script",             LuaScream::PushEntries        )) KILL
+		if (!AddEntriesToTable(L, "Script",        LuaSyncedTable::PushWatchEntries   )) KILL
 		if (!AddEntriesToTable(L, "Spring",         LuaSyncedRead::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "Spring",       LuaUnsyncedCtrl::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "Spring",       LuaUnsyncedRead::PushEntries        )) KILL
@@ -207,6 +208,62 @@ void CUnsyncedLuaHandle::RecvFromSynced(lua_State* srcState, int args)
 	RunCallIn(L, cmdStr, args, 0);
 }
 
+void CUnsyncedLuaHandle::DeferFromSynced(lua_State* srcState, int args)
+{
+	if (!IsValid())
+		return;
+
+	LuaUtils::PackData(deferredMsgs, srcState, args);
+}
+
+void CUnsyncedLuaHandle::UpdateSyncedSnapshots()
+{
+	if (watchedSynced.empty() || !IsValid())
+		return;
+
+	auto& slh = base.syncedLuaHandle;
+
+	if (!slh.IsValid())
+		return;
+
+	LUA_CALL_IN_CHECK(L);
+	LuaSyncedTable::UpdateWatched(L, slh.GetLuaState(), watchedSynced);
+}
+
+// runs RecvFromSynced once for every SendToUnsyncedDeferred message
+void CUnsyncedLuaHandle::RecvDeferredFromSynced()
+{
+	if (deferredMsgs.empty())
+		return;
+
+	// messages sent while delivering (e.g. through callins run by
+	// RecvFromSynced) are kept for the next delivery
+	static std::vector<uint8_t> msgs;
+
+	msgs.clear();
+	msgs.swap(deferredMsgs);
+
+	if (!IsValid())
+		return;
+
+	LUA_CALL_IN_CHECK(L);
+
+	static const LuaHashString cmdStr("RecvFromSynced");
+
+	const uint8_t* msgData = msgs.data();
+	const uint8_t* msgsEnd = msgs.data() + msgs.size();
+
+	while (msgData < msgsEnd) {
+		luaL_checkstack(L, 2, __func__);
+
+		if (!cmdStr.GetGlobalFunc(L))
+			return; // the call is not defined
+
+		// call the routine
+		RunCallIn(L, cmdStr, LuaUtils::UnpackData(L, msgData, msgsEnd), 0);
+	}
+}
+
 /*** Custom Object Rendering
  *
  * For the following calls drawMode can be one of the following, notDrawing = 0, normalDraw = 1, shadowDraw = 2, reflectionDraw = 3, refractionDraw = 4, and finally gameDeferredDraw = 5 which was added in 102.0.
@@ -507,6 +564,7 @@ bool CSyncedLuaHandle::Init(std::string code, const std::string& file)
 
 	// add the custom file loader
 	LuaPushNamedCFunc(L, "SendToUnsynced", SendToUnsynced);
+	LuaPushNamedCFunc(L, "SendToUnsyncedDeferred", SendToUnsyncedDeferred);
 	LuaPushNamedCFunc(L, "CallAsTeam",     CSplitLuaHandle::CallAsTeam);
 	LuaPushNamedNumber(L, "COBSCALE",      COBSCALE);
 
@@ -1997,23 +2055,11 @@ int CSyncedLuaHandle::SyncedPairs(lua_State* L)
 }
 
 
-/***
- * Invoke `UnsyncedCallins:RecvFromSynced` callin with the given arguments.
- * 
- * @function SendToUnsynced
- *
- * @param ... nil|boolean|number|string|table Arguments. Typically the first argument is the name of a function to call.
- *
- * Argument tables will be recursively copied and stripped of unsupported types and metatables.
- *
- * @see UnsyncedCallins:RecvFromSynced
- */
-int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
+static int CheckSendToUnsyncedArgs(lua_State* L, const char* caller)
 {
-	RECOIL_DETAILED_TRACY_ZONE;
 	const int args = lua_gettop(L);
 	if (args <= 0) {
-		luaL_error(L, "Incorrect arguments to SendToUnsynced()");
+		luaL_error(L, "Incorrect arguments to %s()", caller);
 	}
 
 	static const int supportedTypes =
@@ -2027,16 +2073,61 @@ int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
 	for (int i = 1; i <= args; i++) {
 		const int t = (1 << lua_type(L, i));
 		if (!(t & supportedTypes)) {
-			luaL_error(L, "Incorrect data type for SendToUnsynced(), arg %d", i);
+			luaL_error(L, "Incorrect data type for %s(), arg %d", caller, i);
 		}
 	}
 
+	return args;
+}
+
+/***
+ * Invoke `UnsyncedCallins:RecvFromSynced` callin with the given arguments.
+ * 
+ * @function SendToUnsynced
+ *
+ * @param ... nil|boolean|number|string|table Arguments. Typically the first argument is the name of a function to call.
+ *
+ * Argument tables will be recursively copied and stripped of unsupported types and metatables.
+ *
+ * @see UnsyncedCallins:RecvFromSynced
+ */
+int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int args = CheckSendToUnsyncedArgs(L, __func__);
+
 	CUnsyncedLuaHandle* ulh = CSplitLuaHandle::GetUnsyncedHandle(L);
 	ulh->RecvFromSynced(L, args);
 	return 0;
 }
 
 
+/***
+ * Queue a `UnsyncedCallins:RecvFromSynced` call with the given arguments.
+ *
+ * @function SendToUnsyncedDeferred
+ *
+ * @param ... nil|boolean|number|string|table Arguments. Typically the first argument is the name of a function to call.
+ *
+ * Unlike `SendToUnsynced` the arguments are only serialized here; all messages
+ * of a frame are delivered in the order they were sent once the simulation
+ * frame has completed, so they arrive after any `SendToUnsynced` of the
+ * same frame. Arguments are copied with the same rules as `SendToUnsynced`,
+ * as they are when this is called (later changes to tables are not seen).
+ *
+ * @see UnsyncedCallins:RecvFromSynced
+ */
+int CSyncedLuaHandle::SendToUnsyncedDeferred(lua_State* L)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int args = CheckSendToUnsyncedArgs(L, __func__);
+
+	CUnsyncedLuaHandle* ulh = CSplitLuaHandle::GetUnsyncedHandle(L);
+	ulh->DeferFromSynced(L, args);
+	return 0;
+}
+
+
 int CSyncedLuaHandle::AddSyncedActionFallback(lua_State* L)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
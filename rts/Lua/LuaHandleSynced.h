@@ -4,9 +4,11 @@
 #define LUA_HANDLE_SYNCED
 
 #include <string>
+#include <vector>
 
 #include "LuaHandle.h"
 #include "LuaRulesParams.h"
+#include "LuaSyncedTable.h"
 #include "System/UnorderedMap.hpp"
 
 struct lua_State;
@@ -18,6 +20,7 @@ struct BuildInfo;
 class CUnsyncedLuaHandle : public CLuaHandle
 {
 	friend class CSplitLuaHandle;
+	friend class LuaSyncedTable;
 
 	public: // call-ins
 		bool DrawUnit(const CUnit* unit) override;
@@ -28,6 +31,10 @@ class CUnsyncedLuaHandle : public CLuaHandle
 
 	public: // all non-eventhandler callins
 		void RecvFromSynced(lua_State* srcState, int args); // not an engine call-in
+		void RecvDeferredFromSynced(); // not an engine call-in
+
+		void DeferFromSynced(lua_State* srcState, int args);
+		void UpdateSyncedSnapshots();
 
 	protected:
 		CUnsyncedLuaHandle(CSplitLuaHandle* base, const std::string& name, int order);
@@ -44,6 +51,11 @@ class CUnsyncedLuaHandle : public CLuaHandle
 
 	protected:
 		CSplitLuaHandle& base;
+
+		// SendToUnsyncedDeferred messages of the current frame, see LuaUtils::PackData
+		std::vector<uint8_t> deferredMsgs;
+		// SYNCED entries registered through Script.SetWatchSynced
+		std::vector<LuaSyncedTable::WatchedEntry> watchedSynced;
 };
 
 
@@ -150,6 +162,7 @@ class CSyncedLuaHandle : public CLuaHandle
 		static int SyncedPairs(lua_State* L);
 
 		static int SendToUnsynced(lua_State* L);
+		static int SendToUnsyncedDeferred(lua_State* L);
 
 		static int AddSyncedActionFallback(lua_State* L);
 		static int RemoveSyncedActionFallback(lua_State* L);
@@ -187,6 +200,13 @@ class CSplitLuaHandle
 			return syncedLuaHandle.RecvLuaMsg(msg, playerID);
 		}
 
+		// refreshes the watched SYNCED snapshots first, so the deferred
+		// messages of the frame are received with up-to-date snapshots
+		void PostSimFrame() {
+			unsyncedLuaHandle.UpdateSyncedSnapshots();
+			unsyncedLuaHandle.RecvDeferredFromSynced();
+		}
+
 	public:
 		void CheckStack() {
 			syncedLuaHandle.CheckStack();
@@ -347,6 +347,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(TestMoveOrder);
 	REGISTER_LUA_CFUNC(TestBuildOrder);
+	REGISTER_LUA_CFUNC(TestBuildOrders);
 	REGISTER_LUA_CFUNC(Pos2BuildPos);
 	REGISTER_LUA_CFUNC(ClosestBuildPos);
 
@@ -7914,6 +7915,80 @@ int LuaSyncedRead::TestBuildOrder(lua_State* L)
 }
 
 
+/***
+ * Tests many build positions of one unitdef at once.
+ *
+ * Equivalent to calling `Spring.TestBuildOrder` for every position, but shares
+ * the work between positions, so it is much cheaper for grid searches.
+ *
+ * @function Spring.TestBuildOrders
+ * @param unitDefID integer
+ * @param positions xyz[] Array of `{x, y, z}` positions.
+ * @param facing Facing
+ * @return BuildOrderBlockedStatus[]? blockings One entry per position.
+ * @return table<integer,integer>? featureIDs Reclaimable features in the way, keyed by position index.
+ */
+int LuaSyncedRead::TestBuildOrders(lua_State* L)
+{
+	const int unitDefID = luaL_checkint(L, 1);
+	const UnitDef* unitDef = unitDefHandler->GetUnitDefByID(unitDefID);
+
+	if (unitDef == nullptr)
+		return 0;
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	const bool synced = CLuaHandle::GetHandleSynced(L);
+	const int buildFacing = LuaUtils::ParseFacing(L, __func__, 3);
+	const int numPositions = lua_objlen(L, 2);
+
+	std::vector<float3> buildPositions;
+	std::vector<CGameHelper::BuildSquareStatus> statuses;
+	std::vector<CFeature*> features;
+
+	buildPositions.reserve(numPositions);
+
+	for (int i = 1; i <= numPositions; i++) {
+		lua_rawgeti(L, 2, i);
+
+		float pos[3];
+
+		if (LuaUtils::ParseFloatArray(L, -1, pos, 3) != 3)
+			luaL_error(L, "[%s] position %d is not an {x, y, z} array", __func__, i);
+
+		lua_pop(L, 1);
+		buildPositions.push_back(CGameHelper::Pos2BuildPos({unitDef, {pos[0], pos[1], pos[2]}, buildFacing}, synced));
+	}
+
+	CGameHelper::TestUnitBuildSquares(unitDef, buildFacing, buildPositions, CLuaHandle::GetHandleReadAllyTeam(L), synced, statuses, features);
+
+	lua_createtable(L, numPositions, 0);
+
+	for (int i = 0; i < numPositions; i++) {
+		int retval = statuses[i];
+
+		// same backward-compatible mapping as TestBuildOrder
+		if (retval == CGameHelper::BUILDSQUARE_OPEN)
+			retval = CGameHelper::BUILDSQUARE_RECLAIMABLE;
+
+		lua_pushnumber(L, retval);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	lua_newtable(L);
+
+	for (int i = 0; i < numPositions; i++) {
+		if (features[i] == nullptr)
+			continue;
+
+		lua_pushnumber(L, features[i]->id);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 2;
+}
+
+
 /*** Snaps a position to the building grid
  *
  * @function Spring.Pos2BuildPos
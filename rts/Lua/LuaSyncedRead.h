@@ -254,6 +254,7 @@ class LuaSyncedRead {
 
 		static int TestMoveOrder(lua_State* L);
 		static int TestBuildOrder(lua_State* L);
+		static int TestBuildOrders(lua_State* L);
 		static int Pos2BuildPos(lua_State* L);
 		static int ClosestBuildPos(lua_State* L);
 
@@ -0,0 +1,256 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaSyncedSnapshot.h"
+
+#include "LuaInclude.h"
+
+#include "System/UnorderedMap.hpp"
+#include "System/UnorderedSet.hpp"
+
+#include <cassert>
+#include <cstring>
+
+
+// same limit as LuaUtils::CopyData
+static constexpr int MAX_SNAPSHOT_DEPTH = 16;
+
+/******************************************************************************/
+
+static bool IsSnapshotKey(lua_State* L, int index)
+{
+	// table keys have no identity that survives between snapshots
+	switch (lua_type(L, index)) {
+		case LUA_TBOOLEAN:
+		case LUA_TNUMBER:
+		case LUA_TSTRING:
+			return true;
+	}
+
+	return false;
+}
+
+static void PushSnapshotScalar(lua_State* dstL, lua_State* srcL, int index)
+{
+	switch (lua_type(srcL, index)) {
+		case LUA_TBOOLEAN: {
+			lua_pushboolean(dstL, lua_toboolean(srcL, index));
+		} break;
+		case LUA_TNUMBER: {
+			lua_pushnumber(dstL, lua_tonumber(srcL, index));
+		} break;
+		case LUA_TSTRING: {
+			size_t len;
+			const char* str = lua_tolstring(srcL, index, &len);
+			lua_pushlstring(dstL, str, len);
+		} break;
+		default: {
+			assert(false);
+			lua_pushnil(dstL);
+		} break;
+	}
+}
+
+static bool SnapshotScalarsEqual(lua_State* dstL, int dstIndex, lua_State* srcL, int srcIndex)
+{
+	if (lua_type(dstL, dstIndex) != lua_type(srcL, srcIndex))
+		return false;
+
+	switch (lua_type(srcL, srcIndex)) {
+		case LUA_TBOOLEAN: {
+			return (lua_toboolean(dstL, dstIndex) == lua_toboolean(srcL, srcIndex));
+		}
+		case LUA_TNUMBER: {
+			return (lua_tonumber(dstL, dstIndex) == lua_tonumber(srcL, srcIndex));
+		}
+		case LUA_TSTRING: {
+			size_t dstLen;
+			size_t srcLen;
+			const char* dstStr = lua_tolstring(dstL, dstIndex, &dstLen);
+			const char* srcStr = lua_tolstring(srcL, srcIndex, &srcLen);
+			return (dstLen == srcLen && std::memcmp(dstStr, srcStr, srcLen) == 0);
+		}
+	}
+
+	return false;
+}
+
+
+struct SnapshotTable {
+	int ref;
+	bool changed;
+};
+
+struct SnapshotTables {
+	// snapshot of each source table reached during an update
+	spring::unsynced_map<const void*, SnapshotTable> sources;
+	// snapshot tables bound to a source during an update
+	spring::unsynced_set<const void*> claimed;
+
+	// stack index (in dstL) of the metatable given to new snapshot tables
+	int metatable;
+};
+
+static bool UpdateSnapshotField(lua_State* dstL, int dstTable, lua_State* srcL, int srcIndex, int depth, SnapshotTables& syncedTables);
+
+/**
+ * Updates the snapshot on top of dstL's stack (nil or a snapshot table) in
+ * place to match the table at srcIndex, or replaces it by a new table.
+ * Tables reached more than once during an update (shared or recursive ones)
+ * map to the same snapshot table, like LuaUtils::CopyData. A snapshot table
+ * that was shared before but already belongs to another source table in this
+ * update is not reused, so formerly shared subtables can diverge.
+ * @return whether the snapshot changed; <replaced> is set if it is a different table now
+ */
+static bool UpdateSnapshotTable(lua_State* dstL, lua_State* srcL, int srcIndex, int depth, SnapshotTables& syncedTables, bool& replaced)
+{
+	const void* p = lua_topointer(srcL, srcIndex);
+	const auto it = syncedTables.sources.find(p);
+
+	if (it != syncedTables.sources.end()) {
+		lua_rawgeti(dstL, LUA_REGISTRYINDEX, it->second.ref);
+		replaced = !lua_rawequal(dstL, -1, -2);
+		lua_remove(dstL, -2);
+		return (replaced || it->second.changed);
+	}
+
+	if (depth++ > MAX_SNAPSHOT_DEPTH) {
+		replaced = !lua_isnil(dstL, -1);
+		lua_pop(dstL, 1);
+		lua_pushnil(dstL);
+		return replaced;
+	}
+
+	bool changed = false;
+
+	if ((replaced = (!lua_istable(dstL, -1) || syncedTables.claimed.contains(lua_topointer(dstL, -1))))) {
+		lua_pop(dstL, 1);
+		lua_createtable(dstL, lua_objlen(srcL, srcIndex), 5);
+		lua_pushvalue(dstL, syncedTables.metatable);
+		lua_setmetatable(dstL, -2);
+		changed = true;
+	}
+
+	lua_pushvalue(dstL, -1);
+	syncedTables.sources[p] = {luaL_ref(dstL, LUA_REGISTRYINDEX), false};
+	syncedTables.claimed.insert(lua_topointer(dstL, -1));
+
+	const int dstTable = lua_gettop(dstL);
+
+	luaL_checkstack(dstL, 4, __func__);
+	luaL_checkstack(srcL, 3, __func__);
+
+	// add new and update changed entries
+	for (lua_pushnil(srcL); lua_next(srcL, srcIndex) != 0; lua_pop(srcL, 1)) {
+		if (!IsSnapshotKey(srcL, -2))
+			continue;
+
+		PushSnapshotScalar(dstL, srcL, -2);
+		changed |= UpdateSnapshotField(dstL, dstTable, srcL, lua_gettop(srcL), depth, syncedTables);
+	}
+
+	// remove entries that are gone; clearing existing fields is allowed during traversal
+	for (lua_pushnil(dstL); lua_next(dstL, dstTable) != 0; lua_pop(dstL, 1)) {
+		PushSnapshotScalar(srcL, dstL, -2);
+		lua_rawget(srcL, srcIndex);
+
+		const bool keep = (lua_type(srcL, -1) == LUA_TTABLE || IsSnapshotKey(srcL, -1));
+
+		lua_pop(srcL, 1);
+
+		if (keep)
+			continue;
+
+		lua_pushvalue(dstL, -2);
+		lua_pushnil(dstL);
+		lua_rawset(dstL, dstTable);
+		changed = true;
+	}
+
+	// every entry referencing this table sees the change, not just the first one
+	return (syncedTables.sources[p].changed = changed);
+}
+
+/**
+ * Makes dstTable[key] (key on top of dstL's stack, consumed) match the value
+ * at srcIndex; unsupported values (functions, userdata, ...) become nil.
+ * @return whether anything changed
+ */
+static bool UpdateSnapshotField(lua_State* dstL, int dstTable, lua_State* srcL, int srcIndex, int depth, SnapshotTables& syncedTables)
+{
+	lua_pushvalue(dstL, -1);
+	lua_rawget(dstL, dstTable);
+
+	bool changed = false;
+
+	switch (lua_type(srcL, srcIndex)) {
+		case LUA_TTABLE: {
+			bool replaced = false;
+			changed = UpdateSnapshotTable(dstL, srcL, srcIndex, depth, syncedTables, replaced);
+
+			if (!replaced) {
+				lua_pop(dstL, 2);
+				return changed;
+			}
+		} break;
+		case LUA_TBOOLEAN:
+		case LUA_TNUMBER:
+		case LUA_TSTRING: {
+			if (SnapshotScalarsEqual(dstL, -1, srcL, srcIndex)) {
+				lua_pop(dstL, 2);
+				return false;
+			}
+
+			lua_pop(dstL, 1);
+			PushSnapshotScalar(dstL, srcL, srcIndex);
+			changed = true;
+		} break;
+		default: {
+			if (lua_isnil(dstL, -1)) {
+				lua_pop(dstL, 2);
+				return false;
+			}
+
+			lua_pop(dstL, 1);
+			lua_pushnil(dstL);
+			changed = true;
+		} break;
+	}
+
+	lua_rawset(dstL, dstTable);
+	return changed;
+}
+
+
+/******************************************************************************/
+
+void LuaSyncedSnapshot::Update(lua_State* dstL, int proxyTable, int metatable, lua_State* srcL, std::vector<LuaSyncedTable::WatchedEntry>& watched)
+{
+	const int srcTop = lua_gettop(srcL);
+
+	luaL_checkstack(dstL, 2, __func__);
+	luaL_checkstack(srcL, 2, __func__);
+
+	lua_lock(srcL); // tables must not change while we iterate them
+
+	// shared per update so tables referenced by several entries stay shared
+	SnapshotTables syncedTables;
+	syncedTables.metatable = metatable;
+
+	for (LuaSyncedTable::WatchedEntry& entry: watched) {
+		lua_pushsstring(srcL, entry.name);
+		lua_rawget(srcL, LUA_GLOBALSINDEX);
+
+		lua_pushsstring(dstL, entry.name);
+
+		// rawset into the proxy, so __index (copy on access) is bypassed
+		entry.version += UpdateSnapshotField(dstL, proxyTable, srcL, lua_gettop(srcL), 0, syncedTables);
+
+		lua_settop(srcL, srcTop);
+	}
+
+	for (const auto& pair: syncedTables.sources) {
+		luaL_unref(dstL, LUA_REGISTRYINDEX, pair.second.ref);
+	}
+
+	lua_unlock(srcL);
+}
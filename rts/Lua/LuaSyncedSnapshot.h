@@ -0,0 +1,21 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_SYNCED_SNAPSHOT_H
+#define LUA_SYNCED_SNAPSHOT_H
+
+// Incremental snapshots of synced globals, see Script.SetWatchSynced
+
+#include "LuaSyncedTable.h"
+
+#include <vector>
+
+struct lua_State;
+
+namespace LuaSyncedSnapshot {
+	// makes proxyTable[entry.name] in dstL a snapshot of the global entry.name
+	// in srcL for every watched entry, rewriting only what changed; new snapshot
+	// tables get the metatable at stack index <metatable> in dstL
+	void Update(lua_State* dstL, int proxyTable, int metatable, lua_State* srcL, std::vector<LuaSyncedTable::WatchedEntry>& watched);
+};
+
+#endif /* LUA_SYNCED_SNAPSHOT_H */
@@ -6,13 +6,30 @@
 
 #include "LuaHandleSynced.h"
 #include "LuaHashString.h"
+#include "LuaSyncedSnapshot.h"
 #include "LuaUtils.h"
 
+#include <algorithm>
+
 
 static int SyncTableIndex(lua_State* L);
 static int SyncTableNewIndex(lua_State* L);
 static int SyncTableMetatable(lua_State* L);
 
+// registry key of the proxy table, global SYNCED can be overwritten
+static char syncedProxyKey;
+
+/******************************************************************************/
+
+static void PushReadOnlyMetatable(lua_State* L)
+{
+	// disallow writing in SYNCED[...]
+	lua_createtable(L, 0, 2); {
+		LuaPushNamedCFunc(L, "__newindex",  SyncTableNewIndex);
+		LuaPushNamedCFunc(L, "__metatable", SyncTableMetatable);
+	}
+}
+
 /******************************************************************************/
 
 static int SyncTableIndex(lua_State* dstL)
@@ -37,11 +54,7 @@ static int SyncTableIndex(lua_State* dstL)
 	// copy to destination
 	const int valueCopied = LuaUtils::CopyData(dstL, srcL, 1);
 	if (lua_istable(dstL, -1)) {
-		// disallow writing in SYNCED[...]
-		lua_createtable(dstL, 0, 2); {
-			LuaPushNamedCFunc(dstL, "__newindex",  SyncTableNewIndex);
-			LuaPushNamedCFunc(dstL, "__metatable", SyncTableMetatable);
-		}
+		PushReadOnlyMetatable(dstL);
 		lua_setmetatable(dstL, -2);
 	}
 
@@ -86,6 +99,9 @@ static int SyncTableMetatable(lua_State* L)
  * Note that this makes a copy on each access, so is very slow and will not
  * reflect changes. Cache it, but remember to refresh.
  * 
+ * Entries registered with `Script.SetWatchSynced` are instead kept as
+ * read-only snapshots that are updated (only where something changed) after
+ * every simulation frame, so reading them is a plain table access.
  * 
  * @global SYNCED table<string, any>
  */
@@ -102,11 +118,140 @@ bool LuaSyncedTable::PushEntries(lua_State* L)
 
 		lua_setmetatable(L, -2);
 	}
+
+	lua_pushlightuserdata(L, &syncedProxyKey);
+	lua_pushvalue(L, -2);
+	lua_rawset(L, LUA_REGISTRYINDEX);
+
 	lua_rawset(L, -3);
 
 	return true;
 }
 
 
+/******************************************************************************/
+/******************************************************************************/
+
+bool LuaSyncedTable::PushWatchEntries(lua_State* L)
+{
+	REGISTER_LUA_CFUNC(SetWatchSynced);
+	REGISTER_LUA_CFUNC(GetWatchSynced);
+	return true;
+}
+
+
+/******************************************************************************/
+
+void LuaSyncedTable::UpdateWatched(lua_State* dstL, lua_State* srcL, std::vector<WatchedEntry>& watched)
+{
+	if (watched.empty())
+		return;
+
+	const int dstTop = lua_gettop(dstL);
+
+	luaL_checkstack(dstL, 2, __func__);
+
+	lua_pushlightuserdata(dstL, &syncedProxyKey);
+	lua_rawget(dstL, LUA_REGISTRYINDEX);
+
+	if (!lua_istable(dstL, -1)) {
+		lua_settop(dstL, dstTop);
+		return;
+	}
+
+	PushReadOnlyMetatable(dstL);
+	LuaSyncedSnapshot::Update(dstL, dstTop + 1, dstTop + 2, srcL, watched);
+
+	lua_settop(dstL, dstTop);
+}
+
+
+/******************************************************************************/
+
+/***
+ * Keep a snapshot of a synced global instead of copying it on each access.
+ *
+ * Once watched, `SYNCED[name]` is a read-only snapshot that is updated after
+ * every simulation frame. Only changed entries are rewritten, so unchanged
+ * subtables keep their identity. Tables used as keys are not snapshotted.
+ *
+ * @function Script.SetWatchSynced
+ * @param name string Name of the synced global.
+ * @param watch boolean
+ *
+ * @see Script.GetWatchSynced
+ */
+int LuaSyncedTable::SetWatchSynced(lua_State* L)
+{
+	const std::string name = luaL_checksstring(L, 1);
+	const bool watch = luaL_checkboolean(L, 2);
+
+	auto ulh = CSplitLuaHandle::GetUnsyncedHandle(L);
+	auto& watched = ulh->watchedSynced;
+
+	const auto pred = [&](const WatchedEntry& e) { return (e.name == name); };
+	const auto iter = std::find_if(watched.begin(), watched.end(), pred);
+
+	if (!watch) {
+		if (iter == watched.end())
+			return 0;
+
+		watched.erase(iter);
+
+		// back to copying on access
+		lua_pushlightuserdata(L, &syncedProxyKey);
+		lua_rawget(L, LUA_REGISTRYINDEX);
+
+		if (lua_istable(L, -1)) {
+			lua_pushsstring(L, name);
+			lua_pushnil(L);
+			lua_rawset(L, -3);
+		}
+
+		lua_pop(L, 1);
+		return 0;
+	}
+
+	if (iter != watched.end())
+		return 0;
+
+	std::vector<WatchedEntry> entry = {{name, 0}};
+
+	// take the first snapshot right away
+	auto slh = CSplitLuaHandle::GetSyncedHandle(L);
+
+	if (slh->IsValid())
+		UpdateWatched(L, slh->GetLuaState(), entry);
+
+	watched.push_back(std::move(entry[0]));
+	return 0;
+}
+
+
+/***
+ * @function Script.GetWatchSynced
+ * @param name string Name of the synced global.
+ * @return integer? version Incremented every time the snapshot changes, `nil` if not watched.
+ *
+ * @see Script.SetWatchSynced
+ */
+int LuaSyncedTable::GetWatchSynced(lua_State* L)
+{
+	const std::string name = luaL_checksstring(L, 1);
+
+	const auto ulh = CSplitLuaHandle::GetUnsyncedHandle(L);
+	const auto& watched = ulh->watchedSynced;
+
+	const auto pred = [&](const WatchedEntry& e) { return (e.name == name); };
+	const auto iter = std::find_if(watched.begin(), watched.end(), pred);
+
+	if (iter == watched.end())
+		return 0;
+
+	lua_pushnumber(L, iter->version);
+	return 1;
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
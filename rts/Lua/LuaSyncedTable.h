@@ -5,11 +5,31 @@
 
 // Adds the `SYNCED` proxy table
 
+#include <string>
+#include <vector>
+
 struct lua_State;
 
 class LuaSyncedTable {
+	public:
+		// a SYNCED entry that is mirrored into the proxy table after every
+		// frame instead of being copied on each access
+		struct WatchedEntry {
+			std::string name;
+			// bumped whenever the snapshot changed
+			unsigned int version = 0;
+		};
+
 	public:
 		static bool PushEntries(lua_State* L);
+		static bool PushWatchEntries(lua_State* L);
+
+		// incrementally updates the snapshots of all watched entries in dstL from srcL's globals
+		static void UpdateWatched(lua_State* dstL, lua_State* srcL, std::vector<WatchedEntry>& watched);
+
+	private:
+		static int SetWatchSynced(lua_State* L);
+		static int GetWatchSynced(lua_State* L);
 };
 
 #endif /* LUA_SYNCED_TABLE_H */
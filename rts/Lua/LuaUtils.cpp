@@ -179,6 +179,244 @@ int LuaUtils::CopyData(lua_State* dst, lua_State* src, int count)
 /******************************************************************************/
 /******************************************************************************/
 
+enum {
+	PACKED_NIL,
+	PACKED_FALSE,
+	PACKED_TRUE,
+	PACKED_NUMBER,
+	PACKED_STRING,
+	PACKED_TABLE,
+	PACKED_TABLE_END,
+	// strings and tables seen before in the same PackData call, by order of appearance
+	PACKED_REF,
+};
+
+template<typename T>
+static void PackRaw(std::vector<uint8_t>& buffer, const T& value)
+{
+	const size_t pos = buffer.size();
+
+	buffer.resize(pos + sizeof(T));
+	std::memcpy(&buffer[pos], &value, sizeof(T));
+}
+
+template<typename T>
+static T UnpackRaw(const uint8_t*& data, const uint8_t* dataEnd)
+{
+	T value;
+
+	assert((data + sizeof(T)) <= dataEnd);
+	std::memcpy(&value, data, sizeof(T));
+
+	data += sizeof(T);
+	return value;
+}
+
+
+static bool PackValue(std::vector<uint8_t>& buffer, lua_State* src, int index, int depth, spring::unsynced_map<const void*, uint32_t>& alreadyPacked);
+
+static bool PackRef(std::vector<uint8_t>& buffer, const void* p, const spring::unsynced_map<const void*, uint32_t>& alreadyPacked)
+{
+	const auto it = alreadyPacked.find(p);
+
+	if (it == alreadyPacked.end())
+		return false;
+
+	buffer.push_back(PACKED_REF);
+	PackRaw<uint32_t>(buffer, it->second);
+	return true;
+}
+
+static bool PackTable(std::vector<uint8_t>& buffer, lua_State* src, int index, int depth, spring::unsynced_map<const void*, uint32_t>& alreadyPacked)
+{
+	const int table = PosAbsLuaIndex(src, index);
+	const void* p = lua_topointer(src, table);
+
+	if (PackRef(buffer, p, alreadyPacked))
+		return true;
+
+	// check table depth
+	if (depth++ > maxDepth) {
+		LOG("PackTable: reached max table depth '%i'", depth);
+		buffer.push_back(PACKED_NIL);
+		return false;
+	}
+
+	// refs are numbered in the order UnpackValue creates them
+	alreadyPacked.emplace(p, alreadyPacked.size());
+
+	buffer.push_back(PACKED_TABLE);
+	PackRaw<uint32_t>(buffer, lua_objlen(src, table));
+
+	for (lua_pushnil(src); lua_next(src, table) != 0; lua_pop(src, 1)) {
+		PackValue(buffer, src, -2, depth, alreadyPacked); // pack the key
+		PackValue(buffer, src, -1, depth, alreadyPacked); // pack the value
+	}
+
+	buffer.push_back(PACKED_TABLE_END);
+	return true;
+}
+
+static bool PackValue(std::vector<uint8_t>& buffer, lua_State* src, int index, int depth, spring::unsynced_map<const void*, uint32_t>& alreadyPacked)
+{
+	switch (lua_type(src, index)) {
+		case LUA_TNIL: {
+			buffer.push_back(PACKED_NIL);
+		} break;
+
+		case LUA_TBOOLEAN: {
+			buffer.push_back(lua_toboolean(src, index)? PACKED_TRUE: PACKED_FALSE);
+		} break;
+
+		case LUA_TNUMBER: {
+			buffer.push_back(PACKED_NUMBER);
+			PackRaw<lua_Number>(buffer, lua_tonumber(src, index));
+		} break;
+
+		case LUA_TSTRING: {
+			size_t len;
+			const char* data = lua_tolstring(src, index, &len);
+
+			if (PackRef(buffer, data, alreadyPacked))
+				break;
+
+			alreadyPacked.emplace(data, alreadyPacked.size());
+
+			buffer.push_back(PACKED_STRING);
+			PackRaw<uint32_t>(buffer, len);
+			buffer.insert(buffer.end(), data, data + len);
+		} break;
+
+		case LUA_TTABLE: {
+			return PackTable(buffer, src, index, depth, alreadyPacked);
+		} break;
+
+		default: {
+			buffer.push_back(PACKED_NIL); // unhandled type
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static void UnpackValue(lua_State* dst, const uint8_t*& data, const uint8_t* dataEnd, int refsTable, int& numRefs)
+{
+	switch (UnpackRaw<uint8_t>(data, dataEnd)) {
+		case PACKED_NIL: {
+			lua_pushnil(dst);
+		} break;
+
+		case PACKED_FALSE: {
+			lua_pushboolean(dst, false);
+		} break;
+
+		case PACKED_TRUE: {
+			lua_pushboolean(dst, true);
+		} break;
+
+		case PACKED_NUMBER: {
+			lua_pushnumber(dst, UnpackRaw<lua_Number>(data, dataEnd));
+		} break;
+
+		case PACKED_STRING: {
+			const uint32_t len = UnpackRaw<uint32_t>(data, dataEnd);
+
+			assert((data + len) <= dataEnd);
+			lua_pushlstring(dst, reinterpret_cast<const char*>(data), len);
+			data += len;
+
+			lua_pushvalue(dst, -1);
+			lua_rawseti(dst, refsTable, ++numRefs);
+		} break;
+
+		case PACKED_TABLE: {
+			lua_checkstack(dst, 3);
+			lua_createtable(dst, UnpackRaw<uint32_t>(data, dataEnd), 5);
+
+			lua_pushvalue(dst, -1);
+			lua_rawseti(dst, refsTable, ++numRefs);
+
+			while (*data != PACKED_TABLE_END) {
+				UnpackValue(dst, data, dataEnd, refsTable, numRefs); // the key
+				UnpackValue(dst, data, dataEnd, refsTable, numRefs); // the value
+
+				// unsupported key types were packed as nil, NaN is not a valid key either
+				if (lua_isnil(dst, -2) || (lua_type(dst, -2) == LUA_TNUMBER && math::isnan(lua_tonumber(dst, -2)))) {
+					lua_pop(dst, 2);
+					continue;
+				}
+
+				lua_rawset(dst, -3);
+			}
+
+			data += 1;
+		} break;
+
+		case PACKED_REF: {
+			lua_rawgeti(dst, refsTable, UnpackRaw<uint32_t>(data, dataEnd) + 1);
+		} break;
+
+		default: {
+			assert(false);
+		} break;
+	}
+}
+
+
+int LuaUtils::PackData(std::vector<uint8_t>& buffer, lua_State* src, int count)
+{
+	SCOPED_TIMER("Lua::PackData");
+
+	const int srcTop = lua_gettop(src);
+	if (srcTop < count) {
+		LOG_L(L_ERROR, "LuaUtils::PackData: tried to pack more data than there is");
+		return 0;
+	}
+	lua_checkstack(src, 3);
+	lua_lock(src); // we need to be sure tables aren't changed while we iterate them
+
+	// strings and recursive tables are packed once, later occurrences refer back
+	// note: only within one call, the source may change tables between calls
+	spring::unsynced_map<const void*, uint32_t> alreadyPacked;
+
+	PackRaw<uint32_t>(buffer, count);
+
+	for (int i = srcTop - count + 1; i <= srcTop; i++) {
+		PackValue(buffer, src, i, 0, alreadyPacked);
+	}
+
+	assert(srcTop == lua_gettop(src));
+	lua_unlock(src);
+	return count;
+}
+
+int LuaUtils::UnpackData(lua_State* dst, const uint8_t*& data, const uint8_t* dataEnd)
+{
+	SCOPED_TIMER("Lua::UnpackData");
+
+	const int count = UnpackRaw<uint32_t>(data, dataEnd);
+
+	lua_checkstack(dst, count + 4);
+
+	// holds the unpacked strings and tables for PACKED_REF's, removed at the end
+	lua_newtable(dst);
+
+	const int refsTable = lua_gettop(dst);
+	int numRefs = 0;
+
+	for (int i = 0; i < count; i++) {
+		UnpackValue(dst, data, dataEnd, refsTable, numRefs);
+	}
+
+	lua_remove(dst, refsTable);
+	return count;
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
 // The functions below are not used anymore for anything in the engine.
 // There are left behind here disabled for archival purposes.
 #if 0
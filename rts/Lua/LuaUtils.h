@@ -3,7 +3,9 @@
 #ifndef LUA_UTILS_H
 #define LUA_UTILS_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "lib/fmt/printf.h"
 
@@ -107,6 +109,11 @@ class LuaUtils {
 		// Copies lua data between 2 lua_States
 		static int CopyData(lua_State* dst, lua_State* src, int count);
 
+		// Appends the top <count> values of <src> to <buffer>, same rules as CopyData
+		static int PackData(std::vector<uint8_t>& buffer, lua_State* src, int count);
+		// Pushes the values of one PackData call starting at <data>, advances <data> past them
+		static int UnpackData(lua_State* dst, const uint8_t*& data, const uint8_t* dataEnd);
+
 		// returns stack index of traceback function
 		static int PushDebugTraceback(lua_State* L);
 
@@ -2,6 +2,8 @@
 
 
 #include <cmath>
+#include <future>
+#include <new>
 #include <string_view>
 
 #include "LuaVFS.h"
@@ -18,6 +20,7 @@
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
 #include "../tools/pr-downloader/src/pr-downloader.h"
 #include "fmt/format.h"
 
@@ -207,9 +210,11 @@ bool LuaVFS::PushCommon(lua_State* L)
 bool LuaVFS::PushSynced(lua_State* L)
 {
 	PushCommon(L);
+	CreateAsyncFileMetatable(L);
 
 	HSTR_PUSH_CFUNC(L, "Include",    SyncInclude);
 	HSTR_PUSH_CFUNC(L, "LoadFile",   SyncLoadFile);
+	HSTR_PUSH_CFUNC(L, "LoadFileAsync", SyncLoadFileAsync);
 	HSTR_PUSH_CFUNC(L, "FileExists", SyncFileExists);
 	HSTR_PUSH_CFUNC(L, "DirList",    SyncDirList);
 	HSTR_PUSH_CFUNC(L, "SubDirs",    SyncSubDirs);
@@ -221,9 +226,11 @@ bool LuaVFS::PushSynced(lua_State* L)
 bool LuaVFS::PushUnsynced(lua_State* L)
 {
 	PushCommon(L);
+	CreateAsyncFileMetatable(L);
 
 	HSTR_PUSH_CFUNC(L, "Include",             UnsyncInclude);
 	HSTR_PUSH_CFUNC(L, "LoadFile",            UnsyncLoadFile);
+	HSTR_PUSH_CFUNC(L, "LoadFileAsync",       UnsyncLoadFileAsync);
 	HSTR_PUSH_CFUNC(L, "FileExists",          UnsyncFileExists);
 	HSTR_PUSH_CFUNC(L, "DirList",             UnsyncDirList);
 	HSTR_PUSH_CFUNC(L, "SubDirs",             UnsyncSubDirs);
@@ -440,6 +447,174 @@ int LuaVFS::UnsyncLoadFile(lua_State* L)
 }
 
 
+
+/******************************************************************************/
+
+struct AsyncFileResult {
+	int loadCode = 0;
+	std::string data;
+};
+
+struct AsyncFileUserdata {
+	std::shared_future<AsyncFileResult> result;
+	bool synced;
+};
+
+static constexpr const char* ASYNC_FILE_METATABLE = "VFSAsyncFile";
+
+
+bool LuaVFS::CreateAsyncFileMetatable(lua_State* L)
+{
+	luaL_newmetatable(L, ASYNC_FILE_METATABLE);
+
+	// metatable.__index = metatable
+	lua_pushvalue(L, -1);
+	lua_setfield(L, -2, "__index");
+
+	HSTR_PUSH_CFUNC(L, "__gc",    AsyncFileGC);
+	HSTR_PUSH_CFUNC(L, "IsReady", AsyncFileIsReady);
+	HSTR_PUSH_CFUNC(L, "GetData", AsyncFileGetData);
+
+	lua_pop(L, 1);
+	return true;
+}
+
+
+static AsyncFileUserdata* ToAsyncFile(lua_State* L)
+{
+	return static_cast<AsyncFileUserdata*>(luaL_checkudata(L, 1, ASYNC_FILE_METATABLE));
+}
+
+
+/***
+ * Asynchronous file load started by `VFS.LoadFileAsync`.
+ *
+ * @class AsyncFile
+ */
+
+/***
+ * Load raw text data from the VFS on a background thread.
+ *
+ * @function VFS.LoadFileAsync
+ *
+ * Same as `VFS.LoadFile`, but the archive member is read and decompressed by
+ * a worker thread so the calling Lua state does not stall. Call
+ * `AsyncFile:GetData` to obtain the contents; unsynced code can poll
+ * `AsyncFile:IsReady` first to never block at all.
+ *
+ * ```lua
+ * local pending = VFS.LoadFileAsync("luaui/configs/bigdata.lua")
+ *
+ * function widget:Update()
+ *   if pending and pending:IsReady() then
+ *     local data = pending:GetData()
+ *     pending = nil
+ *   end
+ * end
+ * ```
+ *
+ * @param filename string
+ *
+ * Path to file, lowercase only. Use linux style path separators, e.g.
+ * `"foo/bar.txt"`.
+ *
+ * @param mode string?
+ *
+ * VFS modes are single char strings and can be concatenated;
+ * doing specifies an order of preference for the mode (i.e. location) from
+ * which to include files.
+ *
+ * @return AsyncFile asyncFile
+ */
+int LuaVFS::LoadFileAsync(lua_State* L, bool synced)
+{
+	const std::string fileName = luaL_checkstring(L, 1);
+	const std::string vfsModes = GetModes(L, 2, synced);
+
+	luaL_checkstack(L, 2, __func__);
+
+	auto udata = static_cast<AsyncFileUserdata*>(lua_newuserdata(L, sizeof(AsyncFileUserdata)));
+	new (udata) AsyncFileUserdata();
+
+	luaL_getmetatable(L, ASYNC_FILE_METATABLE);
+	lua_setmetatable(L, -2);
+
+	// the VFS is internally locked, so the load may run on any worker
+	udata->result = ThreadPool::Enqueue([](const std::string& fileName, const std::string& vfsModes) {
+		AsyncFileResult result;
+		if ((result.loadCode = LoadFileWithModes(fileName, result.data, vfsModes)) == 1)
+			LuaUtils::TracyRemoveAlsoExtras(result.data.data());
+
+		return result;
+	}, fileName, vfsModes);
+	udata->synced = synced;
+
+	return 1;
+}
+
+
+int LuaVFS::SyncLoadFileAsync(lua_State* L)
+{
+	return LoadFileAsync(L, true);
+}
+
+
+int LuaVFS::UnsyncLoadFileAsync(lua_State* L)
+{
+	return LoadFileAsync(L, false);
+}
+
+
+int LuaVFS::AsyncFileGC(lua_State* L)
+{
+	// an unfinished job keeps its own reference to the shared state
+	ToAsyncFile(L)->~AsyncFileUserdata();
+	return 0;
+}
+
+
+/***
+ * Check whether the background load has finished.
+ *
+ * @function AsyncFile:IsReady
+ *
+ * Only available to unsynced code, since completion time differs between
+ * clients; synced code has to call `AsyncFile:GetData` directly.
+ *
+ * @return boolean ready `true` if `AsyncFile:GetData` will not block.
+ */
+int LuaVFS::AsyncFileIsReady(lua_State* L)
+{
+	const AsyncFileUserdata* f = ToAsyncFile(L);
+
+	if (f->synced)
+		luaL_error(L, "[LuaVFS::%s] not available to synced code", __func__);
+
+	lua_pushboolean(L, f->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+	return 1;
+}
+
+
+/***
+ * Retrieve the file contents, waiting for the load to finish if needed.
+ *
+ * @function AsyncFile:GetData
+ *
+ * @return string? data The contents of the file, `nil` if it could not be loaded.
+ */
+int LuaVFS::AsyncFileGetData(lua_State* L)
+{
+	const AsyncFileUserdata* f = ToAsyncFile(L);
+	const AsyncFileResult& result = f->result.get();
+
+	if (result.loadCode != 1)
+		return 0;
+
+	lua_pushsstring(L, result.data);
+	return 1;
+}
+
+
 /******************************************************************************/
 
 /***
@@ -19,6 +19,7 @@ class LuaVFS {
 
 		static int Include(lua_State* L, bool synced);
 		static int LoadFile(lua_State* L, bool synced);
+		static int LoadFileAsync(lua_State* L, bool synced);
 		static int FileExists(lua_State* L, bool synced);
 		static int DirList(lua_State* L, bool synced);
 		static int SubDirs(lua_State* L, bool synced);
@@ -34,10 +35,18 @@ class LuaVFS {
 
 		static int UnsyncInclude(lua_State* L);
 		static int UnsyncLoadFile(lua_State* L);
+		static int SyncLoadFileAsync(lua_State* L);
+		static int UnsyncLoadFileAsync(lua_State* L);
 		static int UnsyncFileExists(lua_State* L);
 		static int UnsyncDirList(lua_State* L);
 		static int UnsyncSubDirs(lua_State* L);
 
+		// AsyncFile metatable methods
+		static bool CreateAsyncFileMetatable(lua_State* L);
+		static int AsyncFileGC(lua_State* L);
+		static int AsyncFileIsReady(lua_State* L);
+		static int AsyncFileGetData(lua_State* L);
+
 		static int UseArchive(lua_State* L); ///< temporary
 
 		static int CompressFolder(lua_State* L);
@@ -58,6 +58,7 @@ CR_REG_METADATA(MapDimensions, (
 CR_BIND_INTERFACE(CReadMap)
 CR_REG_METADATA(CReadMap, (
 	CR_IGNORED(hmUpdated),
+	CR_IGNORED(hmRevision),
 	CR_IGNORED(processingHeightBounds),
 	CR_IGNORED(initHeightBounds),
 	CR_IGNORED(tempHeightBounds),
@@ -224,6 +224,8 @@ public:
 	void UpdateHeightBounds();
 
 	bool GetHeightMapUpdated() const { return hmUpdated; }
+	/// incremented whenever a height value is changed, never reset
+	unsigned int GetHeightMapRevision() const { return hmRevision; }
 
 	virtual int2 GetPatch(int hmx, int hmz) const = 0;
 	virtual const float3& GetUnsyncedHeightInfo(int patchX, int patchZ) const = 0;
@@ -303,6 +305,7 @@ private:
 
 	bool processingHeightBounds = false;
 	bool hmUpdated = false;
+	unsigned int hmRevision = 0;
 
 	float2 initHeightBounds; //< initial minimum- and maximum-height (before any deformations)
 	float2 tempHeightBounds; //< temporary minimum- and maximum-height
@@ -330,6 +333,7 @@ inline float CReadMap::SetHeightValue(float& heightRef, const int idx, const flo
 	// add=1 <--> x = x*1 + h = x+h
 	float newHeight = heightRef * add + h;
 	hmUpdated |= (newHeight != heightRef);
+	hmRevision += (newHeight != heightRef);
 	return (heightRef = newHeight);
 }
 
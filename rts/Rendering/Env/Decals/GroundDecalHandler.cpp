@@ -1666,4 +1666,16 @@ void CGroundDecalHandler::FeatureMoved(const CFeature* feature, const float3& ol
 void CGroundDecalHandler::UnitLoaded(const CUnit* unit, const CUnit* transport) { ForceRemoveSolidObject(unit); }
 void CGroundDecalHandler::UnitUnloaded(const CUnit* unit, const CUnit* transport) { AddSolidObject(unit); }
 
-void CGroundDecalHandler::UnitMoved(const CUnit* unit) { AddTrack(unit, unit->pos); }
\ No newline at end of file
+void CGroundDecalHandler::UnitMovedBatch(const std::vector<SUnitEvent>& events)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (const SUnitEvent& e: events) {
+		const CUnit* unit = unitHandler.GetUnit(e.unitID);
+
+		// died or got loaded later in the frame
+		if (unit == nullptr || unit->isDead || unit->GetTransporter() != nullptr)
+			continue;
+
+		AddTrack(unit, unit->pos);
+	}
+}
\ No newline at end of file
@@ -63,7 +63,7 @@ public:
 			|| (eventName == "RenderUnitDestroyed")
 			|| (eventName == "RenderFeatureCreated")
 			|| (eventName == "RenderFeatureDestroyed")
-			|| (eventName == "UnitMoved")
+			|| (eventName == "UnitMovedBatch")
 			|| (eventName == "UnitLoaded")
 			|| (eventName == "UnitUnloaded")
 			|| (eventName == "GameFramePost")
@@ -81,7 +81,7 @@ public:
 	void RenderFeatureCreated(const CFeature* feature) override;
 	void RenderFeatureDestroyed(const CFeature* feature) override;
 	void FeatureMoved(const CFeature* feature, const float3& oldpos) override;
-	void UnitMoved(const CUnit* unit) override;
+	void UnitMovedBatch(const std::vector<SUnitEvent>& events) override;
 	void UnitLoaded(const CUnit* unit, const CUnit* transport) override;
 	void UnitUnloaded(const CUnit* unit, const CUnit* transport) override;
 
@@ -50,7 +50,11 @@ CR_REG_METADATA(LocalModel, (
 
 	CR_MEMBER(boundingVolume),
 	CR_IGNORED(luaMaterialData),
-	CR_MEMBER(needsBoundariesRecalc)
+	CR_MEMBER(needsBoundariesRecalc),
+
+	CR_IGNORED(pieceBVH),
+	CR_IGNORED(pieceBVHBounds),
+	CR_IGNORED(needsPieceBVHRefit)
 ))
 
 static_assert(sizeof(SVertexData) == (3 + 3 + 3 + 3 + 4 + 2 + 1) * 4);
@@ -366,6 +370,7 @@ void LocalModel::SetModel(const S3DModel* model, bool initialize)
 
 		pieces[0].UpdateChildTransformRec(true);
 		UpdateBoundingVolume();
+		UpdatePieceBVH();
 		return;
 	}
 
@@ -386,6 +391,7 @@ void LocalModel::SetModel(const S3DModel* model, bool initialize)
 	}
 
 	UpdateBoundingVolume();
+	UpdatePieceBVH();
 
 	assert(pieces.size() == model->numPieces);
 }
@@ -463,6 +469,34 @@ void LocalModel::UpdateBoundingVolume()
 	needsBoundariesRecalc = false;
 }
 
+void LocalModel::UpdatePieceBVH()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!needsPieceBVHRefit && pieceBVH.GetNumLeaves() == pieces.size())
+		return;
+
+	pieceBVHBounds.resize(pieces.size());
+
+	for (size_t n = 0; n < pieces.size(); n++) {
+		const LocalModelPiece& lmp = pieces[n];
+		const CollisionVolume* vol = lmp.GetCollisionVolume();
+
+		CMatrix44f volMat = lmp.GetModelSpaceMatrix();
+		volMat.Translate(vol->GetOffsets());
+
+		pieceBVHBounds[n] = PieceBVH::GetVolumeBounds(vol, volMat);
+	}
+
+	// topology only has to be created once, afterwards refitting suffices
+	if (pieceBVH.GetNumLeaves() != pieces.size()) {
+		pieceBVH.Build(pieceBVHBounds);
+	} else {
+		pieceBVH.Refit(pieceBVHBounds);
+	}
+
+	needsPieceBVHRefit = false;
+}
+
 /** ****************************************************************************************************
  * LocalModelPiece
  */
@@ -480,6 +514,7 @@ LocalModelPiece::LocalModelPiece(const S3DModelPiece* piece)
 
 	, original(piece)
 	, parent(nullptr) // set later
+	, localModel(nullptr) // set later
 {
 	assert(piece != nullptr);
 
@@ -496,6 +531,9 @@ void LocalModelPiece::SetDirty() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	dirty = true;
 
+	if (localModel != nullptr)
+		localModel->SetPieceBVHNeedsRefit();
+
 	for (LocalModelPiece* child: children) {
 		if (child->dirty)
 			continue;
@@ -13,6 +13,7 @@
 #include "Lua/LuaObjectMaterial.h"
 #include "Rendering/GL/VBO.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "Sim/Misc/PieceBVH.h"
 #include "System/Matrix44f.h"
 #include "System/Transform.hpp"
 #include "System/type2.h"
@@ -596,6 +597,12 @@ struct LocalModel
 
 	void SetBoundariesNeedsRecalc()       { needsBoundariesRecalc = true; }
 	bool GetBoundariesNeedsRecalc() const { return needsBoundariesRecalc; }
+
+	// hierarchy over the piece volumes; nullptr while pieces moved since the last UpdatePieceBVH
+	const PieceBVH* GetPieceBVH() const { return (needsPieceBVHRefit? nullptr: &pieceBVH); }
+	void SetPieceBVHNeedsRefit() { needsPieceBVHRefit = true; }
+	bool GetPieceBVHNeedsRefit() const { return needsPieceBVHRefit; }
+	void UpdatePieceBVH();
 private:
 	LocalModelPiece* CreateLocalModelPieces(const S3DModelPiece* mpParent);
 
@@ -613,6 +620,10 @@ private:
 	LuaObjectMaterialData luaMaterialData;
 
 	bool needsBoundariesRecalc = true;
+
+	PieceBVH pieceBVH;
+	std::vector<PieceBVH::Bounds> pieceBVHBounds;
+	bool needsPieceBVHRefit = true;
 };
 
 #endif /* _3DMODEL_H */
@@ -461,6 +461,7 @@ void CModelLoader::Upload(S3DModel* model) const {
 
 	{
 		auto lock = CLoadLock::GetUniqueLock(); //mostly needed to support calls from CFeatureHandler::LoadFeaturesFromMap()
+		auto modelsLock = CModelsLock::GetScopedLock(); // preload jobs append to the S3DModelVAO buffers
 		S3DModelVAO::GetInstance().UploadVBOs();
 
 		// 3DO atlases are preloaded C3DOTextureHandler::Init()
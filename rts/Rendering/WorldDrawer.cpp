@@ -77,29 +77,37 @@ void CWorldDrawer::InitPre() const
 	CFeatureDrawer::InitStatic();
 }
 
-void CWorldDrawer::InitPost() const
+void CWorldDrawer::PreloadModels() const
 {
-	char buf[512] = {0};
-
 	CModelsLock::SetThreadSafety(true);
-	const bool preloadMode = configHandler->GetBool("PreloadModels");
-	{
-		loadscreen->SetLoadMessage("Loading Models");
 
-		if (preloadMode) {
-			for (const auto& def : unitDefHandler->GetUnitDefsVec()) {
-				def.PreloadModel();
-			}
+	if (!configHandler->GetBool("PreloadModels"))
+		return;
 
-			for (const auto& def : featureDefHandler->GetFeatureDefsVec()) {
-				def.PreloadModel();
-			}
+	loadscreen->SetLoadMessage("Loading Models");
 
-			for (const auto& def : weaponDefHandler->GetWeaponDefsVec()) {
-				def.PreloadModel();
-			}
-		}
+	// models are parsed (and their textures decoded) by the ThreadPool while
+	// loading continues; called again by InitPost for map-specific features,
+	// models that are already cached return early
+	for (const auto& def : unitDefHandler->GetUnitDefsVec()) {
+		def.PreloadModel();
+	}
+
+	for (const auto& def : featureDefHandler->GetFeatureDefsVec()) {
+		def.PreloadModel();
+	}
+
+	for (const auto& def : weaponDefHandler->GetWeaponDefsVec()) {
+		def.PreloadModel();
 	}
+}
+
+void CWorldDrawer::InitPost() const
+{
+	char buf[512] = {0};
+
+	PreloadModels();
+
 	auto lock = CLoadLock::GetUniqueLock();
 	{
 		loadscreen->SetLoadMessage("Creating ShadowHandler");
@@ -152,21 +160,30 @@ void CWorldDrawer::InitPost() const
 	{
 		ISky::GetSky()->SetupFog();
 	}
-	lock = {}; //unlock
+}
+
+void CWorldDrawer::WaitPreloadedModels() const
+{
+	loadscreen->SetLoadMessage("Waiting for Models");
+	modelLoader.DrainPreloadFutures(0);
+}
+
+void CWorldDrawer::FinalizeModels() const
+{
+	loadscreen->SetLoadMessage("Finalizing Models");
+	modelLoader.DrainPreloadFutures(0);
+
+	if (!configHandler->GetBool("PreloadModels"))
+		return;
+
+	auto& mv = S3DModelVAO::GetInstance();
 	{
-		loadscreen->SetLoadMessage("Finalizing Models");
-		modelLoader.DrainPreloadFutures(0);
-		auto& mv = S3DModelVAO::GetInstance();
-		if (preloadMode) {
-			{
-				auto lock = CLoadLock::GetUniqueLock();
-				mv.UploadVBOs();
-			}
-			mv.SetSafeToDeleteVectors();
-			modelLoader.LogErrors();
-			CModelsLock::SetThreadSafety(false); //all models are already preloaded
-		}
+		auto lock = CLoadLock::GetUniqueLock();
+		mv.UploadVBOs();
 	}
+	mv.SetSafeToDeleteVectors();
+	modelLoader.LogErrors();
+	CModelsLock::SetThreadSafety(false); //all models are already preloaded
 }
 
 
@@ -8,6 +8,9 @@ class CWorldDrawer
 public:
 	void InitPre() const;
 	void InitPost() const;
+	void PreloadModels() const;
+	void WaitPreloadedModels() const;
+	void FinalizeModels() const;
 	void Kill();
 
 	void Update(bool newSimFrame);
@@ -2,19 +2,26 @@
 
 #include "CollisionHandler.h"
 #include "CollisionVolume.h"
+#ifndef UNIT_TEST
 #include "Map/ReadMap.h" // mapDims
 #include "Rendering/Models/3DModel.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Objects/SolidObject.h"
+#endif
 #include "System/Matrix44f.h"
 #include "System/Log/ILog.h"
 
+#include "xsimd/xsimd.hpp"
+
 #include "System/Misc/TracyDefs.h"
 
 unsigned int CCollisionHandler::numDiscTests = 0;
 unsigned int CCollisionHandler::numContTests = 0;
 
+// below this many pieces a linear sweep beats the hierarchy
+static constexpr size_t PIECE_BVH_MIN_PIECES = 8;
+
 
 
 void CCollisionHandler::PrintStats()
@@ -24,6 +31,7 @@ void CCollisionHandler::PrintStats()
 
 
 
+#ifndef UNIT_TEST
 bool CCollisionHandler::DetectHit(
 	const CSolidObject* o,
 	const CMatrix44f& m,
@@ -138,6 +146,7 @@ bool CCollisionHandler::CollisionFootPrint(const CSolidObject* o, const float3&
 
 	return (groundBlockingObjectMap.ObjectInCell(idx, o));
 }
+#endif // UNIT_TEST
 
 
 bool CCollisionHandler::Collision(const CollisionVolume* v, const CMatrix44f& m, const float3& p)
@@ -200,6 +209,7 @@ bool CCollisionHandler::Collision(const CollisionVolume* v, const CMatrix44f& m,
 }
 
 
+#ifndef UNIT_TEST
 bool CCollisionHandler::MouseHit(
 	const CSolidObject* o,
 	const CMatrix44f& m,
@@ -267,46 +277,51 @@ bool CCollisionHandler::IntersectPiecesHelper(
 	CollisionQuery* cq
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
-	CMatrix44f volMat;
-
-	float minDistSq = std::numeric_limits<float>::max();
-	float curDistSq = minDistSq;
+	const LocalModel& lm = o->localModel;
 
-	for (unsigned int n = 0; n < o->localModel.pieces.size(); n++) {
-		const LocalModelPiece* lmp = o->localModel.GetPiece(n);
+	const auto GetPieceVolume = [&](unsigned int n, CMatrix44f& volMat) -> const CollisionVolume* {
+		const LocalModelPiece* lmp = lm.GetPiece(n);
 		const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
 
 		if (!lmp->GetScriptVisible() || lmpVol->IgnoreHits())
-			continue;
+			return nullptr;
 
 		volMat = m * lmp->GetModelSpaceMatrix();
 		volMat.Translate(lmpVol->GetOffsets());
+		return lmpVol;
+	};
 
-		CollisionQuery cqn;
-		if (!CCollisionHandler::Intersect(lmpVol, volMat, p0, p1, &cqn))
-			continue;
+	// the hierarchy is refitted once per frame, pieces moved since then are tested linearly
+	const PieceBVH* pieceBVH = (lm.pieces.size() >= PIECE_BVH_MIN_PIECES)? lm.GetPieceBVH(): nullptr;
 
-		// skip if neither an ingress nor an egress hit
-		if (!cqn.AnyHit())
-			continue;
+	int hitIdx = -1;
 
-		// save the closest intersection (others are not needed)
-		if ((curDistSq = (cqn.GetHitPos()).SqDistance(p0)) >= minDistSq)
-			continue;
+	if (pieceBVH == nullptr) {
+		hitIdx = IntersectClosestVolume(GetPieceVolume, nullptr, lm.pieces.size(), p0, p1, cq);
+	} else {
+		static thread_local std::vector<unsigned int> pieceIndices;
+
+		// the hierarchy lives in model-space
+		const CMatrix44f mInv = m.InvertAffine();
 
-		minDistSq = curDistSq;
+		pieceIndices.clear();
+		pieceBVH->QuerySegment(mInv.Mul(p0), mInv.Mul(p1), pieceIndices);
 
-		// return early if caller only wants to know a collision exists
-		if (cq == nullptr)
-			return true;
+		// visit candidates in piece order so ties resolve as in a linear sweep
+		std::sort(pieceIndices.begin(), pieceIndices.end());
 
-		*cq = cqn;
-		cq->SetHitPiece(lmp);
+		hitIdx = IntersectClosestVolume(GetPieceVolume, pieceIndices.data(), pieceIndices.size(), p0, p1, cq);
 	}
 
 	// true iff at least one piece was intersected
 	// (query must have been reset by calling code)
-	return (cq != nullptr && cq->GetHitPiece() != nullptr);
+	if (hitIdx < 0)
+		return false;
+
+	if (cq != nullptr)
+		cq->SetHitPiece(lm.GetPiece(hitIdx));
+
+	return true;
 }
 
 
@@ -353,6 +368,7 @@ inline bool CCollisionHandler::Intersect(
 
 	return (CCollisionHandler::Intersect(v, mr, p0, p1, cq));
 }
+#endif // UNIT_TEST
 
 bool CCollisionHandler::Intersect(const CollisionVolume* v, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* q)
 {
@@ -362,6 +378,12 @@ bool CCollisionHandler::Intersect(const CollisionVolume* v, const CMatrix44f& m,
 	const CMatrix44f mInv = m.InvertAffine();
 	const float3 pi0 = mInv.Mul(p0);
 	const float3 pi1 = mInv.Mul(p1);
+
+	return (CCollisionHandler::IntersectVolumeSpace(v, m, pi0, pi1, q));
+}
+
+bool CCollisionHandler::IntersectVolumeSpace(const CollisionVolume* v, const CMatrix44f& m, const float3& pi0, const float3& pi1, CollisionQuery* q)
+{
 	bool intersect = false;
 
 	// minimum and maximum (x, y, z) coordinates of transformed ray
@@ -406,6 +428,134 @@ bool CCollisionHandler::Intersect(const CollisionVolume* v, const CMatrix44f& m,
 	return intersect;
 }
 
+
+
+using FloatBatch = xsimd::simd_type<float>;
+static constexpr size_t BATCH_LANES = xsimd::simd_traits<float>::size;
+
+// CMatrix44f element indices of the inverse rotation and translation, in CollisionVolumeBatch::invMatrices order
+static constexpr std::array<int, 12> BATCH_MATRIX_ELEMS = {0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14};
+
+void CollisionVolumeBatch::Clear()
+{
+	volumes.clear();
+	matrices.clear();
+
+	for (auto& elems: invMatrices) {
+		elems.clear();
+	}
+	for (auto& elems: hScales) {
+		elems.clear();
+	}
+}
+
+void CollisionVolumeBatch::Add(const CollisionVolume* v, const CMatrix44f& m)
+{
+	// same inversion as the scalar Intersect, so the lanes see identical inputs
+	const CMatrix44f mInv = m.InvertAffine();
+
+	const size_t idx = volumes.size();
+	const size_t paddedSize = ((idx + BATCH_LANES) / BATCH_LANES) * BATCH_LANES;
+
+	volumes.push_back(v);
+	matrices.push_back(m);
+
+	for (size_t i = 0; i < invMatrices.size(); i++) {
+		invMatrices[i].resize(paddedSize, 0.0f);
+		invMatrices[i][idx] = mInv[BATCH_MATRIX_ELEMS[i]];
+	}
+	for (size_t i = 0; i < hScales.size(); i++) {
+		hScales[i].resize(paddedSize, 0.0f);
+		hScales[i][idx] = v->GetHScales()[i];
+	}
+}
+
+
+int CCollisionHandler::IntersectBatch(
+	const CollisionVolumeBatch& batch,
+	const float3& p0,
+	const float3& p1,
+	CollisionQuery* cqs,
+	bool* hits,
+	bool firstHitOnly
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// volume-space ray terminals (per component) and bounding-box rejections
+	static thread_local std::array<std::vector<float>, 6> rayElems;
+	static thread_local std::vector<float> rejected;
+
+	const size_t numVolumes = batch.Size();
+	const size_t paddedSize = batch.hScales[0].size();
+
+	if (numVolumes == 0)
+		return -1;
+
+	for (auto& elems: rayElems) {
+		elems.resize(paddedSize);
+	}
+
+	rejected.resize(paddedSize);
+	numContTests += numVolumes;
+
+	const FloatBatch zeros(0.0f);
+	const FloatBatch ones(1.0f);
+
+	for (size_t i = 0; i < paddedSize; i += BATCH_LANES) {
+		xsimd::batch_bool<float, BATCH_LANES> reject(false);
+
+		for (size_t c = 0; c < 3; c++) {
+			const FloatBatch mx = xsimd::load_unaligned(&batch.invMatrices[c    ][i]);
+			const FloatBatch my = xsimd::load_unaligned(&batch.invMatrices[c + 3][i]);
+			const FloatBatch mz = xsimd::load_unaligned(&batch.invMatrices[c + 6][i]);
+			const FloatBatch mt = xsimd::load_unaligned(&batch.invMatrices[c + 9][i]);
+			const FloatBatch hs = xsimd::load_unaligned(&batch.hScales[c][i]);
+
+			// same operation order as CMatrix44f::Mul, results are bit-identical
+			const FloatBatch pi0 = ((mx * FloatBatch(p0.x) + my * FloatBatch(p0.y)) + mz * FloatBatch(p0.z)) + mt;
+			const FloatBatch pi1 = ((mx * FloatBatch(p1.x) + my * FloatBatch(p1.y)) + mz * FloatBatch(p1.z)) + mt;
+
+			pi0.store_unaligned(&rayElems[c    ][i]);
+			pi1.store_unaligned(&rayElems[c + 3][i]);
+
+			// segment lies entirely on one side of the box along this axis
+			reject = reject || ((pi0 < -hs) && (pi1 < -hs)) || ((pi0 > hs) && (pi1 > hs));
+		}
+
+		xsimd::select(reject, ones, zeros).store_unaligned(&rejected[i]);
+	}
+
+	int firstHit = -1;
+
+	for (size_t i = 0; i < numVolumes; i++) {
+		CollisionQuery* cq = (cqs != nullptr)? &cqs[i]: nullptr;
+
+		// the scalar bounding-box test leaves the query untouched as well
+		bool hit = false;
+
+		if (rejected[i] == 0.0f) {
+			const float3 pi0 = {rayElems[0][i], rayElems[1][i], rayElems[2][i]};
+			const float3 pi1 = {rayElems[3][i], rayElems[4][i], rayElems[5][i]};
+
+			hit = IntersectVolumeSpace(batch.volumes[i], batch.matrices[i], pi0, pi1, cq);
+		}
+
+		if (hits != nullptr)
+			hits[i] = hit;
+
+		if (!hit || firstHit >= 0)
+			continue;
+
+		firstHit = i;
+
+		if (firstHitOnly)
+			break;
+	}
+
+	return firstHit;
+}
+
+
+
 bool CCollisionHandler::IntersectEllipsoid(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* q)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
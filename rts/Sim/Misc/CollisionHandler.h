@@ -8,6 +8,9 @@
 #include "System/Matrix44f.h"
 
 #include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
 
 class CSolidObject;
 struct LocalModelPiece;
@@ -86,6 +89,35 @@ private:
 	const LocalModelPiece* lmp = nullptr;
 };
 
+/**
+ * Packed set of volumes that are ray-tested together by
+ * CCollisionHandler::IntersectBatch. The inverse (world-
+ * to volume-space) transforms and half-scales are kept
+ * as one array per component so a SIMD batch can load
+ * consecutive volumes at once.
+ */
+struct CollisionVolumeBatch {
+public:
+	void Clear();
+	/**
+	 * @param v volume
+	 * @param m volume-space to world-space transform, as passed to Intersect
+	 */
+	void Add(const CollisionVolume* v, const CMatrix44f& m);
+
+	size_t Size() const { return volumes.size(); }
+
+private:
+	friend class CCollisionHandler;
+
+	std::vector<const CollisionVolume*> volumes;
+	std::vector<CMatrix44f> matrices;
+
+	// rotation and translation elements of each inverse matrix, padded to the SIMD width
+	std::array<std::vector<float>, 12> invMatrices;
+	std::array<std::vector<float>, 3> hScales;
+};
+
 /**
  * Responsible for detecting hits between projectiles
  * and solid objects (units, features), each SO has a
@@ -151,6 +183,29 @@ class CCollisionHandler {
 		static bool Collision(const CollisionVolume* v, const CMatrix44f& m, const float3& p);
 		static bool CollisionFootPrint(const CSolidObject* o, const float3& p);
 
+		// Intersect, with the ray already in volume-space
+		static bool IntersectVolumeSpace(const CollisionVolume* v, const CMatrix44f& m, const float3& pi0, const float3& pi1, CollisionQuery* cq);
+		static bool IntersectPieceTree(const CSolidObject* o, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* cq);
+		static bool IntersectPiecesHelper(const CSolidObject* o, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* cqp);
+
+	public:
+		/**
+		 * Find the closest ray-hit among a set of volumes; getVolume(n, volMat)
+		 * returns the n-th volume (or nullptr to skip it) and its volume-space
+		 * to world-space transform. Volumes are visited in <indices> order, or
+		 * [0, count) if <indices> is null. Returns the index of the closest hit
+		 * (the first one found if cq is null) or -1, cq is only written on hits.
+		 */
+		template<typename GetVolumeFunc>
+		static int IntersectClosestVolume(
+			GetVolumeFunc getVolume,
+			const unsigned int* indices,
+			unsigned int count,
+			const float3& p0,
+			const float3& p1,
+			CollisionQuery* cq
+		);
+
 		/**
 		 * Test if a ray intersects a volume.
 		 * @param v volume
@@ -159,10 +214,24 @@ class CCollisionHandler {
 		 * @param p1 end of ray (in world-coordinates)
 		 */
 		static bool Intersect(const CollisionVolume* v, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* cq);
-		static bool IntersectPieceTree(const CSolidObject* o, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* cq);
-		static bool IntersectPiecesHelper(const CSolidObject* o, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* cqp);
+		/**
+		 * Test one ray against every volume of <batch>; the ray is transformed
+		 * into volume-space and checked against the volumes' bounding boxes in
+		 * SIMD lanes, survivors get the exact per-shape test. Entry i of <cqs>
+		 * and <hits> (either may be null) receive exactly what Intersect(v_i,
+		 * m_i, p0, p1, &cqs[i]) would produce. If <firstHitOnly> is set, the
+		 * entries following the first hit are not evaluated.
+		 * @return index of the first volume hit, or -1
+		 */
+		static int IntersectBatch(
+			const CollisionVolumeBatch& batch,
+			const float3& p0,
+			const float3& p1,
+			CollisionQuery* cqs,
+			bool* hits,
+			bool firstHitOnly = false
+		);
 
-	public:
 		static bool IntersectEllipsoid(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq);
 		static bool IntersectCylinder(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq);
 		static bool IntersectBox(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq);
@@ -172,4 +241,54 @@ class CCollisionHandler {
 		static unsigned int numContTests; // number of continuous hit-tests executed (inc. unsynced)
 };
 
+
+
+template<typename GetVolumeFunc>
+int CCollisionHandler::IntersectClosestVolume(
+	GetVolumeFunc getVolume,
+	const unsigned int* indices,
+	unsigned int count,
+	const float3& p0,
+	const float3& p1,
+	CollisionQuery* cq
+) {
+	CMatrix44f volMat;
+
+	float minDistSq = std::numeric_limits<float>::max();
+	float curDistSq = minDistSq;
+
+	int hitIdx = -1;
+
+	for (unsigned int i = 0; i < count; i++) {
+		const unsigned int n = (indices != nullptr)? indices[i]: i;
+		const CollisionVolume* vol = getVolume(n, volMat);
+
+		if (vol == nullptr)
+			continue;
+
+		CollisionQuery cqn;
+		if (!CCollisionHandler::Intersect(vol, volMat, p0, p1, &cqn))
+			continue;
+
+		// skip if neither an ingress nor an egress hit
+		if (!cqn.AnyHit())
+			continue;
+
+		// save the closest intersection (others are not needed)
+		if ((curDistSq = (cqn.GetHitPos()).SqDistance(p0)) >= minDistSq)
+			continue;
+
+		minDistSq = curDistSq;
+		hitIdx = n;
+
+		// return early if caller only wants to know a collision exists
+		if (cq == nullptr)
+			return hitIdx;
+
+		*cq = cqn;
+	}
+
+	return hitIdx;
+}
+
 #endif // COLLISION_HANDLER_H
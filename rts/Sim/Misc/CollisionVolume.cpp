@@ -1,9 +1,11 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "CollisionVolume.h"
+#ifndef UNIT_TEST
 #include "Rendering/Models/3DModel.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Features/Feature.h"
+#endif
 #include "System/Matrix44f.h"
 #include "System/SpringMath.h"
 #include "System/StringUtil.h"
@@ -229,7 +231,7 @@ void CollisionVolume::FixTypeAndScale(float3& scales) {
 }
 
 
-
+#ifndef UNIT_TEST
 float3 CollisionVolume::GetWorldSpacePos(const CSolidObject* o, const float3& extOffsets) const {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// collision-volumes are always centered on midPos
@@ -274,6 +276,7 @@ float CollisionVolume::GetPointSurfaceDistance(
 
 	return (GetPointSurfaceDistance(vm, pos));
 }
+#endif // UNIT_TEST
 
 
 
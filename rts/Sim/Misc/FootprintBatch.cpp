@@ -0,0 +1,187 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "FootprintBatch.h"
+#include "Sim/Misc/GlobalConstants.h"
+
+#include "lib/streflop/streflop_cond.h"
+
+#include <algorithm>
+#include <utility>
+
+
+void CFootprintClusters::Init(const std::vector<int2>& corners, int2 size_, int buffer_)
+{
+	size = size_;
+	buffer = buffer_;
+
+	clusters.clear();
+	cornerCounts.clear();
+
+	// a tile is as wide as the area near one footprint, so the bounds of a
+	// cluster are at most about twice as wide as those of its footprints
+	const int tileSize = std::max(size.x, size.y) + buffer * 2;
+
+	// round towards -inf so corners outside the map get tiles of their own
+	const auto GetTile = [&](int v) { return ((v >= 0)? v: (v - tileSize + 1)) / tileSize; };
+
+	std::vector<std::pair<int2, int2>> tiledCorners;
+	tiledCorners.reserve(corners.size());
+
+	for (const int2& corner: corners) {
+		tiledCorners.emplace_back(int2{GetTile(corner.x), GetTile(corner.y)}, corner);
+	}
+
+	std::stable_sort(tiledCorners.begin(), tiledCorners.end(), [](const auto& a, const auto& b) { return (a.first < b.first); });
+
+	for (size_t i = 0, j = 0; i < tiledCorners.size(); i = j) {
+		int2 mins = tiledCorners[i].second;
+		int2 maxs = tiledCorners[i].second;
+
+		for (j = i + 1; j < tiledCorners.size() && tiledCorners[j].first == tiledCorners[i].first; j++) {
+			mins.x = std::min(mins.x, tiledCorners[j].second.x);
+			mins.y = std::min(mins.y, tiledCorners[j].second.y);
+			maxs.x = std::max(maxs.x, tiledCorners[j].second.x);
+			maxs.y = std::max(maxs.y, tiledCorners[j].second.y);
+		}
+
+		Cluster& c = clusters.emplace_back();
+		c.mins = mins;
+		c.dims = {maxs.x - mins.x + 1, maxs.y - mins.y + 1};
+		c.offset = cornerCounts.size();
+
+		// summed-area table, one extra (zero) row and column
+		const int stride = c.dims.x + 1;
+
+		cornerCounts.resize(c.offset + stride * (c.dims.y + 1), 0);
+
+		int* counts = &cornerCounts[c.offset];
+
+		for (size_t k = i; k < j; k++) {
+			const int2 corner = tiledCorners[k].second - mins;
+			counts[(corner.y + 1) * stride + (corner.x + 1)] += 1;
+		}
+
+		for (int z = 1; z <= c.dims.y; z++) {
+			for (int x = 1; x <= c.dims.x; x++) {
+				counts[z * stride + x] += (counts[(z - 1) * stride + x] + counts[z * stride + x - 1] - counts[(z - 1) * stride + x - 1]);
+			}
+		}
+	}
+}
+
+void CFootprintClusters::GetBounds(size_t i, int2& mins, int2& maxs) const
+{
+	const Cluster& c = clusters[i];
+
+	mins = c.mins - buffer;
+	maxs = c.mins + c.dims - 1 + size + buffer;
+}
+
+bool CFootprintClusters::IsNear(size_t i, float x, float z) const
+{
+	// a rectangle query per footprint tests
+	//   (corner - buffer) * SQUARE_SIZE <= p <= (corner + size + buffer) * SQUARE_SIZE
+	// which for integer corners is
+	//   ceil(p / SQUARE_SIZE) - size - buffer <= corner <= floor(p / SQUARE_SIZE) + buffer
+	// (dividing by a power of two is exact)
+	const float sx = x / SQUARE_SIZE;
+	const float sz = z / SQUARE_SIZE;
+
+	const int2 lo = {int(math::ceil(sx)) - size.x - buffer, int(math::ceil(sz)) - size.y - buffer};
+	const int2 hi = {int(math::floor(sx)) + buffer, int(math::floor(sz)) + buffer};
+
+	return (CountCorners(clusters[i], lo, hi) > 0);
+}
+
+int CFootprintClusters::CountCorners(const Cluster& c, int2 lo, int2 hi) const
+{
+	lo.x = std::max(lo.x - c.mins.x, 0);
+	lo.y = std::max(lo.y - c.mins.y, 0);
+	hi.x = std::min(hi.x - c.mins.x, c.dims.x - 1);
+	hi.y = std::min(hi.y - c.mins.y, c.dims.y - 1);
+
+	if (lo.x > hi.x || lo.y > hi.y)
+		return 0;
+
+	const int stride = c.dims.x + 1;
+	const int* counts = &cornerCounts[c.offset];
+
+	return (counts[(hi.y + 1) * stride + (hi.x + 1)] - counts[lo.y * stride + (hi.x + 1)] - counts[(hi.y + 1) * stride + lo.x] + counts[lo.y * stride + lo.x]);
+}
+
+
+
+CFootprintHeightRanges::CFootprintHeightRanges(const float* heightMap_, int mapWidth_, int2 mins_, int2 maxs_, int2 size_, size_t numFootprints)
+	: heightMap(heightMap_)
+	, mapWidth(mapWidth_)
+	, mins(mins_)
+	, size(size_)
+{
+	dims = {maxs_.x - mins_.x + 1, maxs_.y - mins_.y + 1};
+
+	const size_t tableCost = size_t(dims.x) * (dims.y + size.y - 1) * size.x + size_t(dims.x) * dims.y * size.y;
+	const size_t directCost = numFootprints * size.x * size.y;
+
+	if (tableCost >= directCost)
+		return;
+
+	// min/max over each row-window, then over each column of those
+	const int numRows = dims.y + size.y - 1;
+
+	std::vector<float2> rowRanges(dims.x * numRows);
+
+	for (int z = 0; z < numRows; z++) {
+		const float* row = &heightMap[(mins.y + z) * mapWidth + mins.x];
+
+		for (int x = 0; x < dims.x; x++) {
+			rowRanges[z * dims.x + x] = GetRange(row + x, size.x);
+		}
+	}
+
+	ranges.resize(dims.x * dims.y);
+
+	for (int z = 0; z < dims.y; z++) {
+		for (int x = 0; x < dims.x; x++) {
+			float2 range = rowRanges[z * dims.x + x];
+
+			for (int k = 1; k < size.y; k++) {
+				const float2& r = rowRanges[(z + k) * dims.x + x];
+
+				range.x = std::min(range.x, r.x);
+				range.y = std::max(range.y, r.y);
+			}
+
+			ranges[z * dims.x + x] = range;
+		}
+	}
+}
+
+float2 CFootprintHeightRanges::Get(int2 corner) const
+{
+	if (ranges.empty()) {
+		float2 range = GetRange(&heightMap[corner.y * mapWidth + corner.x], size.x);
+
+		for (int k = 1; k < size.y; k++) {
+			const float2 r = GetRange(&heightMap[(corner.y + k) * mapWidth + corner.x], size.x);
+
+			range.x = std::min(range.x, r.x);
+			range.y = std::max(range.y, r.y);
+		}
+
+		return range;
+	}
+
+	return ranges[(corner.y - mins.y) * dims.x + (corner.x - mins.x)];
+}
+
+float2 CFootprintHeightRanges::GetRange(const float* values, int count)
+{
+	float2 range = {values[0], values[0]};
+
+	for (int i = 1; i < count; i++) {
+		range.x = std::min(range.x, values[i]);
+		range.y = std::max(range.y, values[i]);
+	}
+
+	return range;
+}
@@ -0,0 +1,87 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef FOOTPRINT_BATCH_H
+#define FOOTPRINT_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "System/type2.h"
+
+/**
+ * Work shared by a batch of equally sized footprints, as tested by
+ * CGameHelper::TestUnitBuildSquares. Footprints are given by their corner
+ * squares.
+ */
+
+/**
+ * Groups the footprints by map tiles so the units near them can be gathered
+ * with one rectangle query per group, instead of one query per footprint or
+ * one over the bounding box of the whole batch (which can span the map).
+ */
+class CFootprintClusters
+{
+public:
+	/**
+	 * A point is near a footprint if it is at most <buffer> squares away from
+	 * it. Corners may lie outside the map, their footprints still count.
+	 */
+	void Init(const std::vector<int2>& corners, int2 size, int buffer);
+
+	size_t GetNumClusters() const { return clusters.size(); }
+
+	/// squares [mins, maxs] that contain every point near a footprint of cluster <i>
+	void GetBounds(size_t i, int2& mins, int2& maxs) const;
+
+	/**
+	 * Whether the world-space point <x, z> is near any footprint of cluster
+	 * <i>, with the same inclusive bounds as a rectangle query per footprint.
+	 */
+	bool IsNear(size_t i, float x, float z) const;
+
+private:
+	struct Cluster {
+		// bounding box of the corners
+		int2 mins;
+		int2 dims;
+		// start of the summed-area table of corner counts
+		size_t offset;
+	};
+
+	int CountCorners(const Cluster& c, int2 lo, int2 hi) const;
+
+	int2 size;
+	int buffer = 0;
+
+	std::vector<Cluster> clusters;
+	std::vector<int> cornerCounts;
+};
+
+
+/**
+ * Min and max center-heightmap values under every footprint of a given size
+ * whose corner lies in [mins, maxs]. Overlapping footprints (grid searches)
+ * share a separable sliding-window table, sparse candidates are scanned
+ * directly.
+ */
+class CFootprintHeightRanges
+{
+public:
+	CFootprintHeightRanges(const float* heightMap, int mapWidth, int2 mins, int2 maxs, int2 size, size_t numFootprints);
+
+	float2 Get(int2 corner) const;
+
+private:
+	static float2 GetRange(const float* values, int count);
+
+	const float* heightMap;
+	int mapWidth;
+
+	int2 mins;
+	int2 dims;
+	int2 size;
+
+	std::vector<float2> ranges;
+};
+
+#endif // FOOTPRINT_BATCH_H
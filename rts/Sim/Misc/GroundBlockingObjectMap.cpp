@@ -7,6 +7,7 @@
 #include "Map/Ground.h"
 #include "Map/ReadMap.h"
 #include "Sim/Misc/YardmapStatusEffectsMap.h"
+#include "Sim/Objects/YardMapMasks.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Units/Unit.h"
@@ -17,6 +18,10 @@
 
 CGroundBlockingObjectMap groundBlockingObjectMap;
 
+static constexpr int EXITONLY_PLANES    = CYardMapMasks::GetStatePlanes(YARDMAP_EXITONLY);
+static constexpr int UNBUILDABLE_PLANES = CYardMapMasks::GetStatePlanes(YARDMAP_UNBUILDABLE);
+static constexpr int YARD_PLANES        = CYardMapMasks::GetStatePlanes(YARDMAP_YARD | YARDMAP_YARDINV);
+
 CR_BIND_TEMPLATE(CGroundBlockingObjectMap::ArrCell, )
 CR_REG_METADATA_TEMPLATE(CGroundBlockingObjectMap::ArrCell, (
 	CR_MEMBER(arr),
@@ -75,34 +80,33 @@ void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object, con
 	const int xminSqr = bx, xmaxSqr = bx + sx;
 	const int zminSqr = bz, zmaxSqr = bz + sz;
 
-	ObjectCollisionMapHelper objectCol(*object);
+	// without a yardmap every square is YARDMAP_OPEN and nothing gets added
+	if (const CYardMapMasks* yardMapMasks = object->GetYardMapMasks(); yardMapMasks != nullptr) {
+		ObjectCollisionMapHelper objectCol(*object);
+
+		const int facing = object->buildFacing;
+		const int maskPlanes = CYardMapMasks::GetStatePlanes(YardmapStates(mask));
+		const int2 size = yardMapMasks->GetClippedSize(facing, {sx, sz});
 
-	for (int z = zminSqr; z < zmaxSqr; z++) {
-		for (int x = xminSqr; x < xmaxSqr; x++) {
-			auto yardmapState = object->GetGroundBlockingMaskAtPos({x * SQUARE_SIZE * 1.0f, 0.0f, z * SQUARE_SIZE * 1.0f});
+		for (int z = 0; z < size.y; z++) {
+			const int zSqr = zminSqr + z;
 
 			// Add Exit-only zone
-			if (yardmapState & YARDMAP_EXITONLY){
-				objectCol.SetExitOnlyAt(x, z);
-				objectCol.SetBlockBuildingAt(x, z);
-				continue;
-			}
-			if (yardmapState & YARDMAP_UNBUILDABLE) {
-				objectCol.SetBlockBuildingAt(x, z);
-				continue;
-			}
-			// Hold off on this because BAR is using these yardmap types for controlling building upgrades.
-			// if (yardmapState & (YARDMAP_YARD|YARDMAP_YARDINV)) {
-			// 	objectCol.SetBlockBuildingAt(x, z);
-			// 	// may still need to be added to ground map.
-			// }
+			yardMapMasks->ForEachSquare(facing, z, size.x, EXITONLY_PLANES, 0, [&](int x) {
+				objectCol.SetExitOnlyAt(xminSqr + x, zSqr);
+				objectCol.SetBlockBuildingAt(xminSqr + x, zSqr);
+			});
+			yardMapMasks->ForEachSquare(facing, z, size.x, UNBUILDABLE_PLANES, EXITONLY_PLANES, [&](int x) {
+				objectCol.SetBlockBuildingAt(xminSqr + x, zSqr);
+			});
+			// Hold off on blocking building on YARDMAP_YARD|YARDMAP_YARDINV squares because BAR is
+			// using these yardmap types for controlling building upgrades.
 
 			// unit yardmaps always contain sx=UnitDef::xsize * sz=UnitDef::zsize
 			// cells (the unit->moveDef footprint can have different dimensions)
-			if ((yardmapState & mask) == 0)
-				continue;
-
-			CellInsertUnique(z * mapDims.mapx + x, object);
+			yardMapMasks->ForEachSquare(facing, z, size.x, maskPlanes, EXITONLY_PLANES | UNBUILDABLE_PLANES, [&](int x) {
+				CellInsertUnique(zSqr * mapDims.mapx + xminSqr + x, object);
+			});
 		}
 	}
 
@@ -123,28 +127,31 @@ void CGroundBlockingObjectMap::RemoveGroundBlockingObject(CSolidObject* object)
 	const int sz = object->zsize;
 
 	object->ClearPhysicalStateBit(CSolidObject::PSTATE_BIT_BLOCKING);
-	ObjectCollisionMapHelper objectCol(*object);
 
+	// erase every square, squares outside the (rotated) yardmap are open
 	for (int z = bz; z < bz + sz; ++z) {
 		for (int x = bx; x < bx + sx; ++x) {
-			auto yardmapState = object->GetGroundBlockingMaskAtPos({x * SQUARE_SIZE * 1.0f, 0.0f, z * SQUARE_SIZE * 1.0f});
+			CellErase(z * mapDims.mapx + x, object);
+		}
+	}
 
-			// Remove Exit-only zone
-			if (yardmapState & YARDMAP_EXITONLY){
-				objectCol.ClearExitOnlyAt(x, z);
-				objectCol.ClearBlockBuildingAt(x, z);
-				continue;
-			}
-			if (yardmapState & YARDMAP_UNBUILDABLE) {
-				objectCol.ClearBlockBuildingAt(x, z);
-				continue;
-			}
-			if (yardmapState & (YARDMAP_YARD|YARDMAP_YARDINV)) {
-				objectCol.ClearBlockBuildingAt(x, z);
-				// may need to be removed from ground map
-			}
+	if (const CYardMapMasks* yardMapMasks = object->GetYardMapMasks(); yardMapMasks != nullptr) {
+		ObjectCollisionMapHelper objectCol(*object);
 
-			CellErase(z * mapDims.mapx + x, object);
+		const int facing = object->buildFacing;
+		const int2 size = yardMapMasks->GetClippedSize(facing, {sx, sz});
+
+		for (int z = 0; z < size.y; z++) {
+			const int zSqr = bz + z;
+
+			// Remove Exit-only zone
+			yardMapMasks->ForEachSquare(facing, z, size.x, EXITONLY_PLANES, 0, [&](int x) {
+				objectCol.ClearExitOnlyAt(bx + x, zSqr);
+				objectCol.ClearBlockBuildingAt(bx + x, zSqr);
+			});
+			yardMapMasks->ForEachSquare(facing, z, size.x, UNBUILDABLE_PLANES | YARD_PLANES, EXITONLY_PLANES, [&](int x) {
+				objectCol.ClearBlockBuildingAt(bx + x, zSqr);
+			});
 		}
 	}
 
@@ -249,20 +256,26 @@ void CGroundBlockingObjectMap::CloseBlockingYard(CSolidObject* object)
 bool CGroundBlockingObjectMap::CheckYard(const CSolidObject* yardUnit, const YardMapStatus& mask) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	const CYardMapMasks* yardMapMasks = yardUnit->GetYardMapMasks();
+
+	// without a yardmap no square matches any mask
+	if (yardMapMasks == nullptr)
+		return true;
+
 	const int2 mins = yardUnit->mapPos;
-	const int2 maxs = mins + int2(yardUnit->xsize, yardUnit->zsize);
+	const int facing = yardUnit->buildFacing;
+	const int maskPlanes = CYardMapMasks::GetStatePlanes(YardmapStates(mask));
+	const int2 size = yardMapMasks->GetClippedSize(facing, {yardUnit->xsize, yardUnit->zsize});
 
-	for (int z = mins.y; z < maxs.y; ++z) {
-		for (int x = mins.x; x < maxs.x; ++x) {
-			if ((yardUnit->GetGroundBlockingMaskAtPos(float3(x * SQUARE_SIZE, 0.0f, z * SQUARE_SIZE)) & mask) == 0)
-				continue;
+	bool blocked = false;
 
-			if (GroundBlocked(x, z, yardUnit))
-				return false;
-		}
+	for (int z = 0; z < size.y && !blocked; ++z) {
+		yardMapMasks->ForEachSquare(facing, z, size.x, maskPlanes, 0, [&](int x) {
+			blocked = blocked || GroundBlocked(mins.x + x, mins.y + z, yardUnit);
+		});
 	}
 
-	return true;
+	return !blocked;
 }
 
 
@@ -754,7 +754,7 @@ void CLosHandler::Kill()
 		}
 		memUsage += lt->losMaps.size() * sizeof(CLosMap);
 		for (CLosMap& lm: lt->losMaps) {
-			memUsage += lm.losmap.capacity() * sizeof(unsigned short);
+			memUsage += lm.GetTileMap().GetMemUsage();
 		}
 	}
 	LOG_L(L_WARNING, "LosHandler MemUsage: ~%.1fMB", memUsage / (1024.f * 1024.f));*/
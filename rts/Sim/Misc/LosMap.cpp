@@ -416,12 +416,10 @@ void CLosMap::AddCircle(SLosInstance* instance, int amount)
 		const unsigned y_ = instance->basePos.y + y;
 
 		if (y_ < size.y) {
-			const unsigned sx = std::clamp(instance->basePos.x - width,     0, size.x);
-			const unsigned ex = std::clamp(instance->basePos.x + width + 1, 0, size.x);
+			const int sx = std::clamp(instance->basePos.x - width,     0, size.x);
+			const int ex = std::clamp(instance->basePos.x + width + 1, 0, size.x);
 
-			for (unsigned x_ = sx; x_ < ex; ++x_) {
-				losmap[(y_ * size.x) + x_] += amount;
-			}
+			losmap.AddSpan(sx, ex, y_, amount);
 		}
 	});
 }
@@ -439,32 +437,34 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 	const bool visibleInstanceSquares = (instance->allyteam >= 0 && (instance->allyteam == gu->myAllyTeam || gu->spectatingFullView));
 	const bool updateUnsyncedHeightMap = sendReadmapEvents && visibleInstanceSquares;
 
-	if ((amount > 0) && updateUnsyncedHeightMap) {
+	const auto AddRuns = [&](auto&& onEnter) {
 		for (const SLosInstance::RLE rle: losSquares) {
-			for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
-				losmap[idx] += amount;
+			int2 p = IdxToCoord(rle.start, size.x);
 
-				// skip if this los-square did not *enter* LOS
-				if (losmap[idx] != amount)
-					continue;
-
-				const int2 lm = IdxToCoord(idx, size.x);
-				const int2 p1 = (lm             ) * LOS2HEIGHT;
-				const int2 p2 = (lm + int2(1, 1)) * LOS2HEIGHT;
-				const int2 p3 = {std::min(p2.x, mapDims.mapxm1), std::min(p2.y, mapDims.mapym1)};
+			// split runs at row ends, the tiles are not contiguous across rows
+			for (int len = rle.length; len > 0; p = {0, p.y + 1}) {
+				const int n = std::min(len, size.x - p.x);
 
-				readMap->UpdateLOS(SRectangle(p1.x, p1.y,  p3.x, p3.y));
+				losmap.AddSpan(p.x, p.x + n, p.y, amount, onEnter);
+				len -= n;
 			}
 		}
+	};
+
+	if ((amount > 0) && updateUnsyncedHeightMap) {
+		AddRuns([&](int x, int y) {
+			const int2 lm = {x, y};
+			const int2 p1 = (lm             ) * LOS2HEIGHT;
+			const int2 p2 = (lm + int2(1, 1)) * LOS2HEIGHT;
+			const int2 p3 = {std::min(p2.x, mapDims.mapxm1), std::min(p2.y, mapDims.mapym1)};
+
+			readMap->UpdateLOS(SRectangle(p1.x, p1.y,  p3.x, p3.y));
+		});
 
 		return;
 	}
 
-	for (const SLosInstance::RLE rle: losSquares) {
-		for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
-			losmap[idx] += amount;
-		}
-	}
+	AddRuns([](int, int) {});
 }
 
 
@@ -6,6 +6,7 @@
 #define LOS_MAP_H
 
 #include <vector>
+#include "LosTileMap.h"
 #include "System/type2.h"
 #include "System/SpringMath.h"
 
@@ -22,8 +23,7 @@ public:
 		size = size_;
 		LOS2HEIGHT = mapDims / size;
 
-		losmap.clear();
-		losmap.resize(size.x * size.y, 0);
+		losmap.Init(size);
 
 		ctrHeightMap = ctrHeightMap_;
 		mipHeightMap = mipHeightMap_;
@@ -47,12 +47,14 @@ public:
 	int At(int2 p) const {
 		p.x = std::clamp(p.x, 0, size.x - 1);
 		p.y = std::clamp(p.y, 0, size.y - 1);
-		return losmap[p.y * size.x + p.x];
+		return losmap.At(p.x, p.y);
 	}
 
 	// FIXME temp fix for CBaseGroundDrawer and AI interface, which need raw data
-	const unsigned short& front() const { return losmap.front(); }
-	const auto& GetLosMap() const { return losmap; }
+	// (kept up to date from the first call on, see CLosTileMap::GetDense)
+	const unsigned short& front() { return GetLosMap().front(); }
+	const std::vector<unsigned short>& GetLosMap() { return losmap.GetDense(); }
+	const CLosTileMap& GetTileMap() const { return losmap; }
 private:
 	void LosAdd(SLosInstance* instance) const;
 	void UnsafeLosAdd(SLosInstance* instance) const;
@@ -64,7 +66,7 @@ protected:
 	int2 size;
 	int2 LOS2HEIGHT;
 
-	std::vector<unsigned short> losmap;
+	CLosTileMap losmap;
 
 	const float* ctrHeightMap = nullptr;
 	const float* mipHeightMap = nullptr;
@@ -0,0 +1,104 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LosTileMap.h"
+
+#include <cstring>
+
+
+void CLosTileMap::Init(int2 size_)
+{
+	size = size_;
+	numTiles = {(size.x + TILE_MASK) >> TILE_SHIFT, (size.y + TILE_MASK) >> TILE_SHIFT};
+
+	// keeps the capacity of all vectors when reloading
+	tileSlots.clear();
+	tileSlots.resize(numTiles.x * numTiles.y, -1);
+
+	slotData.clear();
+	slotCounts.clear();
+	freeSlots.clear();
+
+	denseMap.clear();
+	haveDense = false;
+}
+
+
+int CLosTileMap::AllocSlot()
+{
+	if (!freeSlots.empty()) {
+		const int slot = freeSlots.back();
+		freeSlots.pop_back();
+		return slot;
+	}
+
+	const int slot = slotCounts.size();
+
+	slotData.resize(slotData.size() + TILE_CELLS, 0);
+	slotCounts.push_back(0);
+	return slot;
+}
+
+void CLosTileMap::FreeSlot(int tileIdx)
+{
+	const int slot = tileSlots[tileIdx];
+
+	assert(slot >= 0);
+	assert(slotCounts[slot] == 0);
+
+	freeSlots.push_back(slot);
+	tileSlots[tileIdx] = -1;
+}
+
+
+void CLosTileMap::CopyTileToDense(int tileIdx)
+{
+	const int tx = (tileIdx % numTiles.x) * TILE_SIZE;
+	const int ty = (tileIdx / numTiles.x) * TILE_SIZE;
+
+	// border tiles extend beyond the map
+	const int w = std::min(TILE_SIZE, size.x - tx);
+	const int h = std::min(TILE_SIZE, size.y - ty);
+
+	const int slot = tileSlots[tileIdx];
+
+	for (int y = 0; y < h; y++) {
+		unsigned short* dst = &denseMap[(ty + y) * size.x + tx];
+
+		if (slot < 0) {
+			std::fill(dst, dst + w, 0);
+		} else {
+			std::memcpy(dst, &slotData[slot * TILE_CELLS + y * TILE_SIZE], w * sizeof(unsigned short));
+		}
+	}
+}
+
+const std::vector<unsigned short>& CLosTileMap::GetDense()
+{
+	if (haveDense)
+		return denseMap;
+
+	denseMap.clear();
+	denseMap.resize(size.x * size.y, 0);
+	haveDense = true;
+
+	for (int tileIdx = 0, numTileSlots = tileSlots.size(); tileIdx < numTileSlots; tileIdx++) {
+		if (tileSlots[tileIdx] >= 0)
+			CopyTileToDense(tileIdx);
+	}
+
+	return denseMap;
+}
+
+
+size_t CLosTileMap::GetMemUsage() const
+{
+	size_t memUsage = 0;
+
+	memUsage += tileSlots.capacity() * sizeof(int);
+	memUsage += slotData.capacity() * sizeof(unsigned short);
+	memUsage += slotCounts.capacity() * sizeof(unsigned short);
+	memUsage += freeSlots.capacity() * sizeof(int);
+	memUsage += denseMap.capacity() * sizeof(unsigned short);
+
+	return memUsage;
+}
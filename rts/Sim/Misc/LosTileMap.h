@@ -0,0 +1,136 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LOS_TILE_MAP_H
+#define LOS_TILE_MAP_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "System/type2.h"
+
+/**
+ * Sparse storage for the per-square sight counters of a CLosMap. The map
+ * is split into TILE_SIZE x TILE_SIZE tiles and only tiles that contain a
+ * non-zero counter are allocated, so allyteams that see (or radar, jam,
+ * ...) only small parts of a large map need little memory and the counters
+ * that are touched together stay close together.
+ *
+ * Tiles are returned to a free-list as soon as their last counter drops to
+ * zero; freed tiles are all-zero by construction and are reused without
+ * clearing.
+ */
+class CLosTileMap
+{
+public:
+	static constexpr int TILE_SHIFT = 4;
+	static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+	static constexpr int TILE_MASK = TILE_SIZE - 1;
+	static constexpr int TILE_CELLS = TILE_SIZE * TILE_SIZE;
+
+public:
+	void Init(int2 size_);
+
+	/// adds <amount> to the squares [x1, x2) of row <y>
+	void AddSpan(int x1, int x2, int y, int amount) { AddSpan(x1, x2, y, amount, [](int, int) {}); }
+
+	/// as above, calls onEnter(x, y) for every square whose counter was zero before
+	template<typename EnterFunc>
+	void AddSpan(int x1, int x2, int y, int amount, EnterFunc&& onEnter);
+
+	unsigned short At(int x, int y) const {
+		assert(x >= 0 && x < size.x && y >= 0 && y < size.y);
+
+		const int slot = tileSlots[(y >> TILE_SHIFT) * numTiles.x + (x >> TILE_SHIFT)];
+
+		if (slot < 0)
+			return 0;
+
+		return slotData[slot * TILE_CELLS + (y & TILE_MASK) * TILE_SIZE + (x & TILE_MASK)];
+	}
+
+	/**
+	 * @brief dense (size.x * size.y) mirror of all counters, for code that needs raw data
+	 * the mirror is created by the first call and from then on updated by AddSpan, so the
+	 * returned data stays current (and at the same address) until the next Init
+	 */
+	const std::vector<unsigned short>& GetDense();
+
+	int2 GetSize() const { return size; }
+
+	size_t GetNumTiles() const { return tileSlots.size(); }
+	size_t GetNumUsedTiles() const { return (slotCounts.size() - freeSlots.size()); }
+	size_t GetMemUsage() const;
+
+private:
+	int AllocSlot();
+	void FreeSlot(int tileIdx);
+
+	void CopyTileToDense(int tileIdx);
+
+private:
+	int2 size;
+	int2 numTiles;
+
+	/// per tile, index of its slot or -1 if all of its counters are zero
+	std::vector<int> tileSlots;
+
+	/// TILE_CELLS counters per slot, row-major within the tile
+	std::vector<unsigned short> slotData;
+	/// number of non-zero counters per slot
+	std::vector<unsigned short> slotCounts;
+	std::vector<int> freeSlots;
+
+	std::vector<unsigned short> denseMap;
+	bool haveDense = false;
+};
+
+
+template<typename EnterFunc>
+inline void CLosTileMap::AddSpan(int x1, int x2, int y, int amount, EnterFunc&& onEnter)
+{
+	assert(x1 >= 0 && x2 <= size.x && y >= 0 && y < size.y);
+
+	const int tileRow = (y >> TILE_SHIFT) * numTiles.x;
+	const int cellRow = (y & TILE_MASK) * TILE_SIZE;
+
+	unsigned short* denseRow = haveDense? &denseMap[y * size.x]: nullptr;
+
+	for (int x = x1; x < x2; ) {
+		const int tileIdx = tileRow + (x >> TILE_SHIFT);
+		const int xe = std::min(x2, (x | TILE_MASK) + 1);
+
+		int slot = tileSlots[tileIdx];
+
+		if (slot < 0) {
+			// counters can only be decreased where they were increased before
+			assert(amount > 0);
+			slot = (tileSlots[tileIdx] = AllocSlot());
+		}
+
+		unsigned short* cells = &slotData[slot * TILE_CELLS + cellRow];
+		int count = slotCounts[slot];
+
+		for (; x < xe; ++x) {
+			unsigned short& cell = cells[x & TILE_MASK];
+			const unsigned short prev = cell;
+
+			cell += amount;
+			count += int(prev == 0) - int(cell == 0);
+
+			if (denseRow != nullptr)
+				denseRow[x] = cell;
+
+			if (prev == 0 && cell != 0)
+				onEnter(x, y);
+		}
+
+		slotCounts[slot] = count;
+
+		if (count == 0)
+			FreeSlot(tileIdx);
+	}
+}
+
+#endif // LOS_TILE_MAP_H
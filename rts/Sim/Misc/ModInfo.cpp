@@ -51,6 +51,7 @@ void CModInfo::ResetState()
 	}
 	{
 		debrisDamage = 50.0f;
+		batchExplosionDamage = false;
 	}
 	{
 		multiReclaim                   = 0;
@@ -223,6 +224,7 @@ void CModInfo::Init(const std::string& modFileName)
 		const LuaTable& damageTbl = root.SubTable("damage");
 
 		debrisDamage = damageTbl.GetFloat("debris", debrisDamage);
+		batchExplosionDamage = damageTbl.GetBool("batchExplosions", batchExplosionDamage);
 	}
 	{
 		// reclaim
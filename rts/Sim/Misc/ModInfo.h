@@ -75,6 +75,9 @@ public:
 	// Damage behaviour
 	/// unit pieces flying off (usually on death)
 	float debrisDamage;
+	/// resolve projectile explosion damage once per frame in one batched (parallel)
+	/// sweep instead of per explosion; order of application stays deterministic
+	bool batchExplosionDamage;
 
 	/* FIXME: ideally things like debris / forest fire AoE would also
 	 * be configurable, but it would be best to implement it as a fake
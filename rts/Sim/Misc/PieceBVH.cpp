@@ -0,0 +1,174 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PieceBVH.h"
+#include "CollisionVolume.h"
+#include "System/Matrix44f.h"
+#include "System/SpringMath.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+#include "System/Misc/TracyDefs.h"
+
+// leaf bounds are grown by this much (in elmos) so float error between
+// the model-space cull and the per-volume exact test can never drop a hit
+static constexpr float BOUNDS_PADDING = 1.0f;
+static constexpr unsigned int MAX_TREE_DEPTH = 64;
+
+
+static bool SegmentOverlapsBounds(const float3& p0, const float3& dir, const PieceBVH::Bounds& b)
+{
+	float tmin = 0.0f;
+	float tmax = 1.0f;
+
+	for (int i = 0; i < 3; i++) {
+		if (math::fabs(dir[i]) < 1e-6f) {
+			if (p0[i] < b.mins[i] || p0[i] > b.maxs[i])
+				return false;
+
+			continue;
+		}
+
+		const float invDir = 1.0f / dir[i];
+
+		float t0 = (b.mins[i] - p0[i]) * invDir;
+		float t1 = (b.maxs[i] - p0[i]) * invDir;
+
+		if (t0 > t1)
+			std::swap(t0, t1);
+
+		tmin = std::max(tmin, t0);
+		tmax = std::min(tmax, t1);
+
+		if (tmin > tmax)
+			return false;
+	}
+
+	return true;
+}
+
+
+PieceBVH::Bounds PieceBVH::GetVolumeBounds(const CollisionVolume* vol, const CMatrix44f& volMat)
+{
+	// box around the volume's half-scales covers every volume type
+	const float3& hs = vol->GetHScales();
+	const float3& cx = volMat.GetX();
+	const float3& cy = volMat.GetY();
+	const float3& cz = volMat.GetZ();
+
+	const float3 ext = {
+		math::fabs(cx.x) * hs.x + math::fabs(cy.x) * hs.y + math::fabs(cz.x) * hs.z + BOUNDS_PADDING,
+		math::fabs(cx.y) * hs.x + math::fabs(cy.y) * hs.y + math::fabs(cz.y) * hs.z + BOUNDS_PADDING,
+		math::fabs(cx.z) * hs.x + math::fabs(cy.z) * hs.y + math::fabs(cz.z) * hs.z + BOUNDS_PADDING,
+	};
+
+	return {volMat.GetPos() - ext, volMat.GetPos() + ext};
+}
+
+
+void PieceBVH::Build(const std::vector<Bounds>& leafBounds)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<unsigned int> indices(leafBounds.size());
+	std::iota(indices.begin(), indices.end(), 0);
+
+	nodes.clear();
+	nodes.reserve(std::max(size_t(1), leafBounds.size() * 2) - 1);
+
+	numLeaves = leafBounds.size();
+
+	if (numLeaves == 0)
+		return;
+
+	BuildRec(leafBounds, indices.data(), indices.size());
+}
+
+unsigned int PieceBVH::BuildRec(const std::vector<Bounds>& leafBounds, unsigned int* indices, unsigned int count)
+{
+	const unsigned int nodeIdx = nodes.size();
+
+	nodes.emplace_back();
+
+	if (count == 1) {
+		nodes[nodeIdx] = {leafBounds[indices[0]], indices[0], 0};
+		return nodeIdx;
+	}
+
+	Bounds bounds = leafBounds[indices[0]];
+	Bounds centers = {bounds.GetCenter(), bounds.GetCenter()};
+
+	for (unsigned int i = 1; i < count; i++) {
+		const float3 c = leafBounds[indices[i]].GetCenter();
+
+		bounds.AddBounds(leafBounds[indices[i]]);
+		centers.AddBounds({c, c});
+	}
+
+	// median split along the axis with the largest spread of centers
+	const float3 spread = centers.maxs - centers.mins;
+	const int axis = (spread.x >= spread.y && spread.x >= spread.z)? 0: ((spread.y >= spread.z)? 1: 2);
+	const unsigned int half = count / 2;
+
+	std::nth_element(indices, indices + half, indices + count, [&](unsigned int a, unsigned int b) {
+		const float ca = leafBounds[a].GetCenter()[axis];
+		const float cb = leafBounds[b].GetCenter()[axis];
+		return (ca < cb || (ca == cb && a < b));
+	});
+
+	const unsigned int left = BuildRec(leafBounds, indices, half);
+	const unsigned int right = BuildRec(leafBounds, indices + half, count - half);
+
+	nodes[nodeIdx] = {bounds, left, right};
+	return nodeIdx;
+}
+
+void PieceBVH::Refit(const std::vector<Bounds>& leafBounds)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(leafBounds.size() == numLeaves);
+
+	// children follow their parents, so a reverse sweep visits them first
+	for (size_t i = nodes.size(); i > 0; i--) {
+		Node& node = nodes[i - 1];
+
+		if (node.IsLeaf()) {
+			node.bounds = leafBounds[node.left];
+			continue;
+		}
+
+		node.bounds = nodes[node.left].bounds;
+		node.bounds.AddBounds(nodes[node.right].bounds);
+	}
+}
+
+
+void PieceBVH::QuerySegment(const float3& p0, const float3& p1, std::vector<unsigned int>& leaves) const
+{
+	if (nodes.empty())
+		return;
+
+	const float3 dir = p1 - p0;
+
+	unsigned int stack[MAX_TREE_DEPTH * 2];
+	unsigned int stackSize = 0;
+
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0) {
+		const Node& node = nodes[stack[--stackSize]];
+
+		if (!SegmentOverlapsBounds(p0, dir, node.bounds))
+			continue;
+
+		if (node.IsLeaf()) {
+			leaves.push_back(node.left);
+			continue;
+		}
+
+		assert((stackSize + 2) <= (MAX_TREE_DEPTH * 2));
+
+		stack[stackSize++] = node.right;
+		stack[stackSize++] = node.left;
+	}
+}
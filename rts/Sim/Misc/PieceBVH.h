@@ -0,0 +1,77 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PIECE_BVH_H
+#define PIECE_BVH_H
+
+#include <vector>
+
+#include "System/float3.h"
+
+class CMatrix44f;
+struct CollisionVolume;
+
+/**
+ * Bounding-volume hierarchy over the (model-space) piece collision volumes
+ * of a LocalModel, used to cull ray tests for objects that are hit-tested
+ * per piece. The tree topology is built once per piece count; when pieces
+ * move only the node bounds are refitted.
+ *
+ * Queries are conservative: every piece whose volume could be intersected
+ * by a segment is returned, so the caller still performs the exact tests.
+ */
+class PieceBVH
+{
+public:
+	struct Bounds {
+		void AddBounds(const Bounds& b) {
+			mins = float3::min(mins, b.mins);
+			maxs = float3::max(maxs, b.maxs);
+		}
+
+		float3 GetCenter() const { return ((mins + maxs) * 0.5f); }
+
+		float3 mins;
+		float3 maxs;
+	};
+
+	/**
+	 * @brief axis-aligned bounds of a volume
+	 * @param volMat volume-space to model-space transform, including the volume offsets
+	 */
+	static Bounds GetVolumeBounds(const CollisionVolume* vol, const CMatrix44f& volMat);
+
+	void Build(const std::vector<Bounds>& leafBounds);
+	void Refit(const std::vector<Bounds>& leafBounds);
+	void Clear() { nodes.clear(); numLeaves = 0; }
+
+	/**
+	 * @brief appends the indices of all leaves whose bounds overlap segment [p0, p1]
+	 * Indices are appended in traversal order, not sorted.
+	 */
+	void QuerySegment(const float3& p0, const float3& p1, std::vector<unsigned int>& leaves) const;
+
+	size_t GetNumLeaves() const { return numLeaves; }
+	size_t GetNumNodes() const { return nodes.size(); }
+
+private:
+	struct Node {
+		Bounds bounds;
+
+		// for leaves <right> is 0 (the root is never a child)
+		// and <left> holds the index of the leaf's volume
+		unsigned int left;
+		unsigned int right;
+
+		bool IsLeaf() const { return (right == 0); }
+	};
+
+	unsigned int BuildRec(const std::vector<Bounds>& leafBounds, unsigned int* indices, unsigned int count);
+
+private:
+	// stored in pre-order; children always follow their parent
+	std::vector<Node> nodes;
+
+	size_t numLeaves = 0;
+};
+
+#endif // PIECE_BVH_H
@@ -16,6 +16,7 @@
 	#include "Sim/Projectiles/Projectile.h"
 	#include "Sim/Units/Unit.h"
 	#include "Sim/Weapons/PlasmaRepulser.h"
+	#include "Sim/Weapons/WeaponDef.h"
 #endif
 
 #include "System/Misc/TracyDefs.h"
@@ -33,7 +34,8 @@ CR_REG_METADATA(CQuadField, (
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
 	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(tempQuads),
+	CR_IGNORED(revision)
 ))
 
 CR_BIND(CQuadField::Quad, )
@@ -43,6 +45,7 @@ CR_REG_METADATA_SUB(CQuadField, Quad, (
 	CR_MEMBER(features),
 	CR_MEMBER(projectiles),
 	CR_MEMBER(repulsers),
+	CR_IGNORED(unitsRevision),
 
 	CR_POSTLOAD(PostLoad)
 ))
@@ -60,12 +63,15 @@ void CQuadField::Quad::PostLoad()
 	for (CUnit* unit: units) {
 		spring::VectorInsertUnique(teamUnits[unit->allyteam], unit, false);
 	}
+
+	unitsRevision++;
 #endif
 }
 
 void CQuadField::Init(int2 mapDims, int quadSize)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	revision++;
 	quadSizeX = quadSize;
 	quadSizeZ = quadSize;
 	numQuadsX = (mapDims.x * SQUARE_SIZE) / quadSize;
@@ -393,6 +399,7 @@ bool CQuadField::InsertUnitIf(CUnit* unit, const float3& wpos)
 
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].units, unit, false);
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit, false);
+	revision++;
 	return true;
 }
 
@@ -424,6 +431,7 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 
 	spring::VectorErase(baseQuads[wposQuadIdx].units, unit);
 	spring::VectorErase(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit);
+	revision++;
 	return true;
 }
 #endif
@@ -434,6 +442,7 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 void CQuadField::MovedUnit(CUnit* unit)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	revision++;
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, unit->pos, unit->radius);
 
@@ -446,11 +455,13 @@ void CQuadField::MovedUnit(CUnit* unit)
 	for (const int qi: unit->quads) {
 		spring::VectorErase(baseQuads[qi].units, unit);
 		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		baseQuads[qi].unitsRevision++;
 	}
 
 	for (const int qi: *qfQuery.quads) {
 		spring::VectorInsertUnique(baseQuads[qi].units, unit, false);
 		spring::VectorInsertUnique(baseQuads[qi].teamUnits[unit->allyteam], unit, false);
+		baseQuads[qi].unitsRevision++;
 	}
 
 	unit->quads = std::move(*qfQuery.quads);
@@ -459,9 +470,11 @@ void CQuadField::MovedUnit(CUnit* unit)
 void CQuadField::RemoveUnit(CUnit* unit)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	revision++;
 	for (const int qi: unit->quads) {
 		spring::VectorErase(baseQuads[qi].units, unit);
 		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		baseQuads[qi].unitsRevision++;
 	}
 
 	unit->quads.clear();
@@ -481,6 +494,7 @@ void CQuadField::RemoveUnit(CUnit* unit)
 void CQuadField::MovedRepulser(CPlasmaRepulser* repulser)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	revision++;
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, repulser->weaponMuzzlePos, repulser->GetRadius());
 
@@ -506,6 +520,7 @@ void CQuadField::MovedRepulser(CPlasmaRepulser* repulser)
 void CQuadField::RemoveRepulser(CPlasmaRepulser* repulser)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	revision++;
 	for (const int qi: repulser->GetQuads()) {
 		spring::VectorErase(baseQuads[qi].repulsers, repulser);
 	}
@@ -525,6 +540,7 @@ void CQuadField::RemoveRepulser(CPlasmaRepulser* repulser)
 void CQuadField::AddFeature(CFeature* feature)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	revision++;
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
@@ -536,6 +552,7 @@ void CQuadField::AddFeature(CFeature* feature)
 void CQuadField::RemoveFeature(CFeature* feature)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	revision++;
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
@@ -925,7 +942,8 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 	const float radius,
 	std::vector<CUnit*>& units,
 	std::vector<CFeature*>& features,
-	std::vector<CPlasmaRepulser*>* repulsers
+	std::vector<CPlasmaRepulser*>* repulsers,
+	unsigned int repulserMask
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const int tempNum = gs->GetTempNum();
@@ -970,6 +988,9 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		}
 		if (repulsers != nullptr) {
 			for (CPlasmaRepulser* r: quad.repulsers) {
+				if ((r->weaponDef->shieldInterceptType & repulserMask) == 0)
+					continue;
+
 				// prevent double adding
 				if (r->tempNum == tempNum)
 					continue;
@@ -987,4 +1008,235 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		}
 	}
 }
+
+// thread-safe variant of the above, results are returned in the same order
+void CQuadField::GetUnitsAndFeaturesColVol(QuadFieldQuery& qfq, const float3& pos, const float radius)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	auto curThread = qfq.threadOwner;
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = curThread;
+	GetQuads(qfQuery, pos, radius);
+	const int tempNum = gs->GetMtTempNum(curThread);
+	qfq.units = tempUnits[curThread].ReserveVector();
+	qfq.features = tempFeatures[curThread].ReserveVector();
+
+	for (const int qi: *qfQuery.quads) {
+		const Quad& quad = baseQuads[qi];
+
+		for (CUnit* u: quad.units) {
+			if (u->mtTempNum[curThread] == tempNum)
+				continue;
+
+			u->mtTempNum[curThread] = tempNum;
+
+			const auto* colvol = &u->collisionVolume;
+			const float totRad = radius + colvol->GetBoundingRadius();
+
+			if (pos.SqDistance(colvol->GetWorldSpacePos(u)) >= (totRad * totRad))
+				continue;
+
+			qfq.units->push_back(u);
+		}
+
+		for (CFeature* f: quad.features) {
+			if (f->mtTempNum[curThread] == tempNum)
+				continue;
+
+			f->mtTempNum[curThread] = tempNum;
+
+			const auto* colvol = &f->collisionVolume;
+			const float totRad = radius + colvol->GetBoundingRadius();
+
+			if (pos.SqDistance(colvol->GetWorldSpacePos(f)) >= (totRad * totRad))
+				continue;
+
+			qfq.features->push_back(f);
+		}
+	}
+}
+
+
+// stable counting-sort of (query, object) pairs into per-query ranges
+template<typename T>
+static void GroupColVolCandidates(
+	const std::vector<std::pair<unsigned int, T*>>& pairs,
+	size_t numQueries,
+	std::vector<unsigned int>& offsets,
+	std::vector<T*>& objects
+) {
+	static std::vector<unsigned int> cursors;
+
+	offsets.clear();
+	offsets.resize(numQueries + 1, 0);
+	objects.resize(pairs.size());
+
+	for (const auto& pair: pairs) {
+		offsets[pair.first + 1]++;
+	}
+	for (size_t i = 0; i < numQueries; i++) {
+		offsets[i + 1] += offsets[i];
+	}
+
+	cursors.assign(offsets.begin(), offsets.end() - 1);
+
+	for (const auto& pair: pairs) {
+		objects[cursors[pair.first]++] = pair.second;
+	}
+}
+
+void CQuadField::GetUnitsAndFeaturesColVol(QuadFieldColVolBatch& batch)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	static std::vector<std::pair<unsigned int, CUnit*>> unitPairs;
+	static std::vector<std::pair<unsigned int, CFeature*>> featurePairs;
+	static std::vector<std::pair<unsigned int, CPlasmaRepulser*>> repulserPairs;
+	// world-space volume centers and bounding radii of one quad's objects
+	static std::vector<std::pair<float3, float>> spheres;
+
+	const size_t numQueries = batch.queries.size();
+
+	batch.quadQueries.clear();
+	batch.revision = revision;
+
+	unitPairs.clear();
+	featurePairs.clear();
+	repulserPairs.clear();
+
+	for (size_t i = 0; i < numQueries; i++) {
+		const QuadFieldColVolBatch::Query& q = batch.queries[i];
+
+		if (q.radius < 0.0f)
+			continue;
+
+		QuadFieldQuery qfQuery;
+		GetQuads(qfQuery, q.pos, q.radius);
+
+		for (const int qi: *qfQuery.quads) {
+			batch.quadQueries.emplace_back(qi, i);
+		}
+	}
+
+	// GetQuads returns quads in ascending order, so after sorting each
+	// query still visits its quads in the same order as a single query
+	std::sort(batch.quadQueries.begin(), batch.quadQueries.end());
+
+	const auto TestBucket = [&](auto& pairs, const auto& objects, size_t bucketBeg, size_t bucketEnd, const auto& canPair) {
+		for (size_t k = bucketBeg; k < bucketEnd; k++) {
+			const unsigned int queryIdx = batch.quadQueries[k].second;
+			const QuadFieldColVolBatch::Query& q = batch.queries[queryIdx];
+
+			for (size_t j = 0; j < objects.size(); j++) {
+				if (!canPair(q, objects[j]))
+					continue;
+
+				const float totRad = q.radius + spheres[j].second;
+
+				if (q.pos.SqDistance(spheres[j].first) >= (totRad * totRad))
+					continue;
+
+				pairs.emplace_back(queryIdx, objects[j]);
+			}
+		}
+	};
+
+	const auto PairAny = [](const QuadFieldColVolBatch::Query& q, const CSolidObject* o) { return true; };
+	// shields that can not intercept a query's projectile are never paired with it
+	const auto PairRepulser = [](const QuadFieldColVolBatch::Query& q, const CPlasmaRepulser* r) {
+		return ((r->weaponDef->shieldInterceptType & q.repulserMask) != 0);
+	};
+
+	for (size_t bucketBeg = 0, bucketEnd = 0; bucketBeg < batch.quadQueries.size(); bucketBeg = bucketEnd) {
+		const int qi = batch.quadQueries[bucketBeg].first;
+		const Quad& quad = baseQuads[qi];
+
+		for (bucketEnd = bucketBeg + 1; bucketEnd < batch.quadQueries.size(); bucketEnd++) {
+			if (batch.quadQueries[bucketEnd].first != qi)
+				break;
+		}
+
+		spheres.clear();
+
+		for (const CUnit* u: quad.units) {
+			spheres.emplace_back(u->collisionVolume.GetWorldSpacePos(u), u->collisionVolume.GetBoundingRadius());
+		}
+
+		TestBucket(unitPairs, quad.units, bucketBeg, bucketEnd, PairAny);
+		spheres.clear();
+
+		for (const CFeature* f: quad.features) {
+			spheres.emplace_back(f->collisionVolume.GetWorldSpacePos(f), f->collisionVolume.GetBoundingRadius());
+		}
+
+		TestBucket(featurePairs, quad.features, bucketBeg, bucketEnd, PairAny);
+
+		if (quad.repulsers.empty())
+			continue;
+
+		spheres.clear();
+
+		for (const CPlasmaRepulser* r: quad.repulsers) {
+			spheres.emplace_back(r->weaponMuzzlePos, r->collisionVolume.GetBoundingRadius());
+		}
+
+		TestBucket(repulserPairs, quad.repulsers, bucketBeg, bucketEnd, PairRepulser);
+	}
+
+	GroupColVolCandidates(unitPairs, numQueries, batch.unitOffsets, batch.units);
+	GroupColVolCandidates(featurePairs, numQueries, batch.featureOffsets, batch.features);
+	GroupColVolCandidates(repulserPairs, numQueries, batch.repulserOffsets, batch.repulsers);
+}
+
+void CQuadField::GetUnitsAndFeaturesColVol(
+	const QuadFieldColVolBatch& batch,
+	size_t queryIdx,
+	std::vector<CUnit*>& units,
+	std::vector<CFeature*>& features,
+	std::vector<CPlasmaRepulser*>* repulsers
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(IsValidColVolBatch(batch));
+	assert(queryIdx < batch.queries.size());
+
+	// objects overlapping several of the query's quads were paired once per quad
+	const int tempNum = gs->GetTempNum();
+
+	for (unsigned int j = batch.unitOffsets[queryIdx]; j < batch.unitOffsets[queryIdx + 1]; j++) {
+		CUnit* u = batch.units[j];
+
+		if (u->tempNum == tempNum)
+			continue;
+
+		u->tempNum = tempNum;
+		units.push_back(u);
+	}
+
+	for (unsigned int j = batch.featureOffsets[queryIdx]; j < batch.featureOffsets[queryIdx + 1]; j++) {
+		CFeature* f = batch.features[j];
+
+		if (f->tempNum == tempNum)
+			continue;
+
+		f->tempNum = tempNum;
+		features.push_back(f);
+	}
+
+	if (repulsers == nullptr)
+		return;
+
+	for (unsigned int j = batch.repulserOffsets[queryIdx]; j < batch.repulserOffsets[queryIdx + 1]; j++) {
+		CPlasmaRepulser* r = batch.repulsers[j];
+
+		if (r->tempNum == tempNum)
+			continue;
+
+		r->tempNum = tempNum;
+		repulsers->push_back(r);
+	}
+}
+
+bool CQuadField::IsValidColVolBatch(const QuadFieldColVolBatch& batch) const
+{
+	return (batch.revision == revision);
+}
 #endif // UNIT_TEST
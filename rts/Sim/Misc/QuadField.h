@@ -19,6 +19,7 @@ class CProjectile;
 class CSolidObject;
 class CPlasmaRepulser;
 struct QuadFieldQuery;
+struct QuadFieldColVolBatch;
 
 template<typename T>
 class QueryVectorCache {
@@ -90,13 +91,39 @@ public:
 	void GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const float3& dir, float length);
 	void GetQuadsOnWideRay(QuadFieldQuery& qfq, const float3& start, const float3& dir, float length, float width);
 
+	/**
+	 * @param repulserMask only shields whose intercept-type shares a bit
+	 * with this mask (i.e. that could intercept the querying projectile)
+	 * are returned in @c repulsers
+	 */
 	void GetUnitsAndFeaturesColVol(
 		const float3& pos,
 		const float radius,
 		std::vector<CUnit*>& units,
 		std::vector<CFeature*>& features,
+		std::vector<CPlasmaRepulser*>* repulsers = nullptr,
+		unsigned int repulserMask = -1u
+	);
+	void GetUnitsAndFeaturesColVol(QuadFieldQuery& qfq, const float3& pos, const float radius);
+
+	/**
+	 * Resolves all query spheres of @c batch at once: the spheres are
+	 * bucketed by the quads they overlap and each occupied quad's objects
+	 * are tested against its bucket in one pass. The per-query results
+	 * are retrieved with the overload below and equal those of the
+	 * single-query GetUnitsAndFeaturesColVol (incl. order) as long as
+	 * IsValidColVolBatch holds.
+	 */
+	void GetUnitsAndFeaturesColVol(QuadFieldColVolBatch& batch);
+	void GetUnitsAndFeaturesColVol(
+		const QuadFieldColVolBatch& batch,
+		size_t queryIdx,
+		std::vector<CUnit*>& units,
+		std::vector<CFeature*>& features,
 		std::vector<CPlasmaRepulser*>* repulsers = nullptr
 	);
+	// false if objects were added, moved or removed since @c batch was resolved
+	bool IsValidColVolBatch(const QuadFieldColVolBatch& batch) const;
 
 	/**
 	 * Returns all units within @c radius of @c pos,
@@ -184,6 +211,7 @@ public:
 			features = std::move(q.features);
 			projectiles = std::move(q.projectiles);
 			repulsers = std::move(q.repulsers);
+			unitsRevision = q.unitsRevision;
 			return *this;
 		}
 
@@ -199,6 +227,7 @@ public:
 			features.clear();
 			projectiles.clear();
 			repulsers.clear();
+			unitsRevision++;
 		}
 
 	public:
@@ -207,6 +236,9 @@ public:
 		std::vector<CFeature*> features;
 		std::vector<CProjectile*> projectiles;
 		std::vector<CPlasmaRepulser*> repulsers;
+
+		// changes whenever a unit enters or leaves this quad
+		unsigned int unitsRevision = 0;
 	};
 
 	const Quad& GetQuad(unsigned i) const {
@@ -243,6 +275,9 @@ private:
 
 	float2 invQuadSize;
 
+	// bumped whenever quad contents change, see QuadFieldColVolBatch
+	unsigned int revision = 0;
+
 	int numQuadsX;
 	int numQuadsZ;
 
@@ -271,4 +306,49 @@ struct QuadFieldQuery {
 };
 
 
+struct QuadFieldColVolBatch {
+public:
+	void Clear() { queries.clear(); }
+	// queries with a negative radius are never resolved and return nothing
+	// <repulserMask> is the same shield intercept-type filter as for a single query
+	void AddQuery(const float3& pos, float radius, unsigned int repulserMask = -1u) { queries.push_back({pos, radius, repulserMask}); }
+
+	size_t GetNumQueries() const { return queries.size(); }
+
+	// exact comparison, float3::operator== has a tolerance
+	bool HasQuery(size_t queryIdx, const float3& pos, float radius, unsigned int repulserMask = -1u) const {
+		if (queryIdx >= queries.size())
+			return false;
+
+		const Query& q = queries[queryIdx];
+		return (q.pos.x == pos.x && q.pos.y == pos.y && q.pos.z == pos.z && q.radius == radius && q.repulserMask == repulserMask);
+	}
+
+private:
+	friend class CQuadField;
+
+	struct Query {
+		float3 pos;
+		float radius;
+		unsigned int repulserMask;
+	};
+
+	std::vector<Query> queries;
+
+	// (quad, query) pairs sorted by quad; each run is one cell's bucket
+	std::vector<std::pair<int, unsigned int>> quadQueries;
+
+	// candidates of query i are [offsets[i], offsets[i + 1]), still containing duplicates
+	std::vector<unsigned int> unitOffsets;
+	std::vector<unsigned int> featureOffsets;
+	std::vector<unsigned int> repulserOffsets;
+
+	std::vector<CUnit*> units;
+	std::vector<CFeature*> features;
+	std::vector<CPlasmaRepulser*> repulsers;
+
+	unsigned int revision = -1u;
+};
+
+
 #endif /* QUAD_FIELD_H */
@@ -135,9 +135,19 @@ const CResourceMapAnalyzer* CResourceHandler::GetResourceMapAnalyzer(int resourc
 
 	CResourceMapAnalyzer* rma = &resourceMapAnalyzers[resourceId];
 
-	if (rma->GetNumSpots() < 0)
-		rma->Init();
+	if (!rma->IsInitStarted())
+		rma->StartInit();
 
+	rma->WaitInit();
 	return rma;
 }
 
+void CResourceHandler::PrefetchResourceMapAnalyzers()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (CResourceMapAnalyzer& rma: resourceMapAnalyzers) {
+		if (!rma.IsInitStarted())
+			rma.StartInit();
+	}
+}
+
@@ -23,6 +23,12 @@ public:
 
 	void Init() { AddResources(); }
 	void Kill() {
+		// background analyses still reference their analyzer
+		for (CResourceMapAnalyzer& rma: resourceMapAnalyzers) {
+			if (rma.IsInitStarted())
+				rma.WaitInit();
+		}
+
 		resourceDescriptions.clear();
 		resourceMapAnalyzers.clear();
 	}
@@ -103,6 +109,11 @@ public:
 	 * Returns the resource map analyzer by index.
 	 */
 	const CResourceMapAnalyzer* GetResourceMapAnalyzer(int resourceId);
+	/**
+	 * Starts analyzing all resource maps in the background (if not cached),
+	 * so the first GetResourceMapAnalyzer call does not have to wait as long.
+	 */
+	void PrefetchResourceMapAnalyzers();
 
 	size_t GetNumResources() const { return resourceDescriptions.size(); }
 
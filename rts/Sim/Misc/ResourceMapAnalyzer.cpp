@@ -22,12 +22,14 @@ using std::fclose;
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <stdexcept>
 
 #include "System/Misc/TracyDefs.h"
 
 static constexpr float3 ERRORVECTOR(-1, 0, 0);
+
 static std::string CACHE_BASE("");
 
 CResourceMapAnalyzer::CResourceMapAnalyzer(int resourceId)
@@ -36,23 +38,16 @@ CResourceMapAnalyzer::CResourceMapAnalyzer(int resourceId)
 
 	, extractorRadius(-1.0f)
 	, averageIncome(0.0f)
+	, maxWorth(0.0f)
 
-	, stopMe(false)
+	, initStarted(false)
 
 	, maxSpots(10000)
 	, mapHeight(0)
 	, mapWidth(0)
 	, totalCells(0)
-	, squareRadius(0)
-	, doubleSquareRadius(0)
-	, totalResources(0)
-	, maxResource(0)
-	, tempResources(0)
-	, coordX(0)
-	, coordZ(0)
 	, minIncomeForSpot(50)
 	, xtractorRadius(0)
-	, doubleRadius(0)
 {
 	if (CACHE_BASE.empty())
 		CACHE_BASE = dataDirsAccess.LocateDir(FileSystem::GetCacheDir() + FileSystemAbstraction::GetNativePathSeparator() + "analyzedResourceMaps" + FileSystemAbstraction::GetNativePathSeparator(), FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
@@ -114,8 +109,11 @@ float3 CResourceMapAnalyzer::GetNearestSpot(float3 fromPos, int team, const Unit
 }
 
 
-void CResourceMapAnalyzer::Init() {
+void CResourceMapAnalyzer::StartInit() {
 	RECOIL_DETAILED_TRACY_ZONE;
+	assert(!initStarted);
+	initStarted = true;
+
 	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
 
 	mapWidth = resourceHandler->GetResourceMapWidth(resourceId);
@@ -124,22 +122,35 @@ void CResourceMapAnalyzer::Init() {
 	totalCells = mapHeight * mapWidth;
 	extractorRadius = resource->extractorRadius;
 	xtractorRadius = static_cast<int>(extractorRadius / (SQUARE_SIZE * 2));
-	doubleRadius = xtractorRadius * 2;
-	squareRadius = xtractorRadius * xtractorRadius;
-	doubleSquareRadius = doubleRadius * doubleRadius;
+	maxWorth = resource->maxWorth;
+
+	cacheFileName = GetCacheFileName();
 
-	rexArrayA.resize(totalCells);
-	rexArrayB.resize(totalCells);
-	// used for drawing the TGA, not really needed with a couple of changes
-	rexArrayC.resize(totalCells);
+	if (LoadResourceMap())
+		return;
 
-	tempAverage.resize(totalCells);
+	// if there's no available load file, create one and save it; the map is
+	// copied up front since Lua can change it while the analysis is running
+	spotFinder.Init(resourceHandler->GetResourceMap(resourceId), mapWidth, mapHeight, xtractorRadius);
 
-	// if there's no available load file, create one and save it
-	if (!LoadResourceMap()) {
+	// the job must not use for_mt, which is only safe to call from the main thread
+	analysisJob = ThreadPool::Enqueue([this]() {
 		GetResourcePoints();
 		SaveResourceMap();
-	}
+		spotFinder.Kill();
+	});
+}
+
+void CResourceMapAnalyzer::WaitInit() {
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(initStarted);
+
+	if (!analysisJob.valid())
+		return;
+
+	// also rethrows anything thrown by the job
+	analysisJob.get();
+	analysisJob = {};
 }
 
 float CResourceMapAnalyzer::GetAverageIncome() const {
@@ -150,358 +161,28 @@ float CResourceMapAnalyzer::GetAverageIncome() const {
 
 void CResourceMapAnalyzer::GetResourcePoints() {
 	RECOIL_DETAILED_TRACY_ZONE;
-	std::vector<int> xend(doubleRadius + 1);
-
-	for (int a = 0; a < doubleRadius + 1; a++) {
-		float z = a - xtractorRadius;
-		float floatsqrradius = squareRadius;
-		xend[a] = int(math::sqrt(floatsqrradius - z * z));
-	}
-
-	// load up the resource values in each pixel
-	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
-	double totalResourcesDouble  = 0;
 
-	for (int i = 0; i < totalCells; i++) {
-		// count the total resources so you can work out
-		// an average of the whole map
-		totalResourcesDouble +=  rexArrayA[i] = resourceMapArray[i];
-	}
+	std::vector<CResourceSpotFinder::Spot> spots;
 
 	// do the average
-	averageIncome = totalResourcesDouble / totalCells;
-	numSpotsFound = 0;
-
-	// if the map does not have any resource (quick test), just stop
-	if (totalResourcesDouble < 0.9)
-		return;
-
-	// Now work out how much resources each spot can make
-	// by adding up the resources from nearby spots
-	for (int y = 0; y < mapHeight; y++) {
-		for (int x = 0; x < mapWidth; x++) {
-			totalResources = 0;
-
-			// first spot needs full calculation
-			if (x == 0 && y == 0)
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight){
-						for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
-							if (sx >= 0 && sx < mapWidth) {
-								// get the resources from all pixels around the extractor radius
-								totalResources += rexArrayA[sy * mapWidth + sx];
-							}
-						}
-					}
-				}
-
-			// quick calc test
-			if (x > 0) {
-				totalResources = tempAverage[y * mapWidth + x - 1];
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight) {
-						const int addX = x + xend[a];
-						const int remX = x - xend[a] - 1;
-
-						if (addX < mapWidth) {
-							totalResources += rexArrayA[sy * mapWidth + addX];
-						}
-						if (remX >= 0) {
-							totalResources -= rexArrayA[sy * mapWidth + remX];
-						}
-					}
-				}
-			} else if (y > 0) {
-				// x == 0 here
-				totalResources = tempAverage[(y - 1) * mapWidth];
-				// remove the top half
-				int a = xtractorRadius;
-
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int remY = y - xend[a] - 1;
-
-						if (remY >= 0) {
-							totalResources -= rexArrayA[remY * mapWidth + sx];
-						}
-					}
-				}
-
-				// add the bottom half
-				a = xtractorRadius;
-
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int addY = y + xend[a];
-
-						if (addY < mapHeight) {
-							totalResources += rexArrayA[addY * mapWidth + sx];
-						}
-					}
-				}
-			}
-
-			// set that spot's resource making ability
-			// (divide by cells to values are small)
-			tempAverage[y * mapWidth + x] = totalResources;
-
-			if (maxResource < totalResources) {
-				// find the spot with the highest resource value to set as the map's max
-				maxResource = totalResources;
-			}
-		}
-	}
+	averageIncome = spotFinder.GetTotalResources() / totalCells;
+	spotFinder.FindSpots(spots, maxSpots, minIncomeForSpot);
 
-	// make a list for the distribution of values
-	std::vector<int> valueDist(256, 0);
+	vectoredSpots.clear();
+	vectoredSpots.reserve(spots.size());
 
-	// this will get the total resources a rex placed at each spot would make
-	for (int i = 0; i < totalCells; i++) {
-		// scale the resources so any map will have values 0-255,
-		// no matter how much resources it has
-		rexArrayB[i] = tempAverage[i] * 255 / maxResource;
-		// clear out the array since it has never been used
-		rexArrayC[i] = 0;
+	for (const CResourceSpotFinder::Spot& spot: spots) {
+		float3 bufferSpot;
 
-		int value = rexArrayB[i];
-		valueDist[value]++;
+		// format resource coords to game-coords
+		bufferSpot.x = spot.x * (SQUARE_SIZE * 2) + SQUARE_SIZE;
+		bufferSpot.z = spot.z * (SQUARE_SIZE * 2) + SQUARE_SIZE;
+		// gets the actual amount of resource an extractor can make
+		bufferSpot.y = spot.value * maxWorth * spotFinder.GetMaxResource() / 255;
+		vectoredSpots.push_back(bufferSpot);
 	}
 
-	// find the current best value
-	int bestValue = 0;
-	int numberOfValues = 0;
-	int usedSpots = 0;
-
-	for (int i = 255; i >= 0; i--) {
-		if (valueDist[i] != 0) {
-			bestValue = i;
-			numberOfValues = valueDist[i];
-			break;
-		}
-	}
-
-	// make a list of the indexes of the best spots
-	// (make sure that the list wont be too big)
-	if (numberOfValues > 256) {
-		numberOfValues = 256;
-	}
-
-	std::vector<int> bestSpotList(numberOfValues);
-
-	for (int i = 0; i < totalCells; i++) {
-		if (rexArrayB[i] == bestValue) {
-			// add the index of this spot to the list
-			bestSpotList[usedSpots] = i;
-			usedSpots++;
-
-			if (usedSpots == numberOfValues) {
-				// the list is filled, stop the loop
-				usedSpots = 0;
-				break;
-			}
-		}
-	}
-
-	for (int a = 0; a < maxSpots; a++) {
-		if (!stopMe) {
-			// reset temporary resources so it can find new spots
-			tempResources = 0;
-			// take the first spot
-			int speedTempResources_x = 0;
-			int speedTempResources_y = 0;
-			int speedTempResources = 0;
-			bool found = false;
-
-			while (!found) {
-				if (usedSpots == numberOfValues) {
-					// the list is empty now, refill it
-
-					// make a list of all the best spots
-					for (int i = 0; i < 256; i++) {
-						// clear the array
-						valueDist[i] = 0;
-					}
-
-					// find the resource distribution
-					for (int i = 0; i < totalCells; i++) {
-						int value = rexArrayB[i];
-						valueDist[value]++;
-					}
-
-					// find the current best value
-					bestValue = 0;
-					numberOfValues = 0;
-					usedSpots = 0;
-
-					for (int i = 255; i >= 0; i--) {
-						if (valueDist[i] != 0) {
-							bestValue = i;
-							numberOfValues = valueDist[i];
-							break;
-						}
-					}
-
-					// make a list of the indexes of the best spots
-					// (make sure that the list wont be too big)
-					if (numberOfValues > 256) {
-						numberOfValues = 256;
-					}
-
-					bestSpotList.clear();
-					bestSpotList.resize(numberOfValues);
-
-					for (int i = 0; i < totalCells; i++) {
-						if (rexArrayB[i] == bestValue) {
-							// add the index of this spot to the list
-							bestSpotList[usedSpots] = i;
-							usedSpots++;
-
-							if (usedSpots == numberOfValues) {
-								// the list is filled, stop the loop
-								usedSpots = 0;
-								break;
-							}
-						}
-					}
-				}
-
-				// The list is not empty now.
-				int spotIndex = bestSpotList[usedSpots];
-
-				if (rexArrayB[spotIndex] == bestValue) {
-					// the spot is still valid, so use it
-					speedTempResources_x = spotIndex % mapWidth;
-					speedTempResources_y = spotIndex / mapWidth;
-					speedTempResources = bestValue;
-					found = true;
-				}
-
-				// update the bestSpotList index
-				usedSpots++;
-			}
-
-			coordX = speedTempResources_x;
-			coordZ = speedTempResources_y;
-			tempResources = speedTempResources;
-		}
-
-		if (tempResources < minIncomeForSpot) {
-			// if the spots get too crappy it will stop running the loops to speed it all up
-			stopMe = true;
-		}
-
-		if (!stopMe) {
-			// format resource coords to game-coords
-			bufferSpot.x = coordX * (SQUARE_SIZE * 2) + SQUARE_SIZE;
-			bufferSpot.z = coordZ * (SQUARE_SIZE * 2) + SQUARE_SIZE;
-			// gets the actual amount of resource an extractor can make
-			const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
-			bufferSpot.y = tempResources * (resource->maxWorth) * maxResource / 255;
-			vectoredSpots.push_back(bufferSpot);
-
-			// plot TGA array (not necessary) for debug
-			rexArrayC[coordZ * mapWidth + coordX] = tempResources;
-			numSpotsFound += 1;
-
-			// small speedup of "wipes the resources around the spot so it is not counted twice"
-			for (int sy = coordZ - xtractorRadius, a = 0;  sy <= coordZ + xtractorRadius;  sy++, a++) {
-				if (sy >= 0 && sy < mapHeight) {
-					int clearXStart = coordX - xend[a];
-					int clearXEnd = coordX + xend[a];
-
-					if (clearXStart < 0) {
-						clearXStart = 0;
-					}
-					if (clearXEnd >= mapWidth) {
-						clearXEnd = mapWidth - 1;
-					}
-
-					for (int xClear = clearXStart; xClear <= clearXEnd; xClear++) {
-						// wipes the resources around the spot so it is not counted twice
-						rexArrayA[sy * mapWidth + xClear] = 0;
-						rexArrayB[sy * mapWidth + xClear] = 0;
-						tempAverage[sy * mapWidth + xClear] = 0;
-					}
-				}
-			}
-
-			// redo the whole averaging process around the picked spot so other spots can be found around it
-			for (int y = coordZ - doubleRadius; y <= coordZ + doubleRadius; y++) {
-				if (y >=0 && y < mapHeight) {
-					for (int x = coordX - doubleRadius; x <= coordX + doubleRadius; x++) {
-						if (x >=0 && x < mapWidth) {
-							totalResources = 0;
-
-							// comment out for debug
-							if (x == 0 && y == 0) {
-								for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-									if (sy >= 0 && sy < mapHeight) {
-										for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
-											if (sx >= 0 && sx < mapWidth) {
-												// get the resources from all pixels around the extractor radius
-												totalResources += rexArrayA[sy * mapWidth + sx];
-											}
-										}
-									}
-								}
-							}
-
-							// quick calc test
-							if (x > 0) {
-								totalResources = tempAverage[y * mapWidth + x - 1];
-
-								for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-									if (sy >= 0 && sy < mapHeight) {
-										int addX = x + xend[a];
-										int remX = x - xend[a] - 1;
-
-										if (addX < mapWidth) {
-											totalResources += rexArrayA[sy * mapWidth + addX];
-										}
-										if (remX >= 0) {
-											totalResources -= rexArrayA[sy * mapWidth + remX];
-										}
-									}
-								}
-							} else if (y > 0) {
-								// x == 0 here
-								totalResources = tempAverage[(y - 1) * mapWidth];
-								// remove the top half
-								int a = xtractorRadius;
-
-								for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-									if (sx < mapWidth) {
-										int remY = y - xend[a] - 1;
-
-										if (remY >= 0) {
-											totalResources -= rexArrayA[remY * mapWidth + sx];
-										}
-									}
-								}
-
-								// add the bottom half
-								a = xtractorRadius;
-
-								for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-									if (sx < mapWidth) {
-										int addY = y + xend[a];
-
-										if (addY < mapHeight) {
-											totalResources += rexArrayA[addY * mapWidth + sx];
-										}
-									}
-								}
-							}
-
-							tempAverage[y * mapWidth + x] = totalResources;
-							// set that spot's resource amount
-							rexArrayB[y * mapWidth + x] = totalResources * 255 / maxResource;
-						}
-					}
-				}
-			}
-		}
-	}
+	numSpotsFound = vectoredSpots.size();
 }
 
 
@@ -517,7 +198,6 @@ static inline void writeToFile(const T& value, FILE* file) {
 void CResourceMapAnalyzer::SaveResourceMap() {
 	RECOIL_DETAILED_TRACY_ZONE;
 
-	const std::string cacheFileName = GetCacheFileName();
 	FILE* saveFile = fopen(cacheFileName.c_str(), "wb");
 
 	try {
@@ -550,8 +230,6 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 
 	bool loaded = false;
 
-	const std::string cacheFileName = GetCacheFileName();
-
 	FILE* cacheFile = fopen(cacheFileName.c_str(), "rb");
 
 	if (cacheFile != nullptr) {
@@ -3,7 +3,11 @@
 #ifndef _RESOURCE_MAP_ANALYZER_H
 #define _RESOURCE_MAP_ANALYZER_H
 
+#include "ResourceSpotFinder.h"
 #include "System/float3.h"
+
+#include <future>
+#include <string>
 #include <vector>
 
 class CResource;
@@ -14,7 +18,17 @@ public:
 	CResourceMapAnalyzer(int resourceId);
 
 	// deferred to ResourceHandler
-	void Init();
+	void Init() { StartInit(); WaitInit(); }
+
+	/**
+	 * Loads the spots from the cache, or on a miss starts analyzing the
+	 * resource map as a background job; WaitInit must be called before
+	 * any results are read.
+	 */
+	void StartInit();
+	void WaitInit();
+
+	bool IsInitStarted() const { return initStarted; }
 
 	/**
 	 * Returns positions indicating where to place resource extractors on the map.
@@ -44,36 +58,29 @@ private:
 
 	float extractorRadius;
 	float averageIncome;
+	float maxWorth;
 
-	bool stopMe;
+	bool initStarted;
 
 	// if more spots than this are found the map is considered a resource-map (eg. speed-metal), tweak as needed
 	int maxSpots;
 	int mapHeight;
 	int mapWidth;
 	int totalCells;
-	int squareRadius;
-	int doubleSquareRadius;
-	int totalResources;
-	int maxResource;
-	int tempResources;
-	int coordX;
-	int coordZ;
 	// from 0-255, the minimum percentage of resources a spot needs to have from
 	// the maximum to be saved, prevents crappier spots in between taken spaces
 	// (they are still perfectly valid and will generate resources mind you!)
 	int minIncomeForSpot;
 	int xtractorRadius;
-	int doubleRadius;
 
-	float3 bufferSpot;
+	std::vector<float3> vectoredSpots;
 
-	std::vector<unsigned char> rexArrayA;
-	std::vector<unsigned char> rexArrayB;
-	std::vector<unsigned char> rexArrayC;
-	std::vector<int> tempAverage;
+	// holds the copied resource map while the analysis job runs
+	CResourceSpotFinder spotFinder;
 
-	std::vector<float3> vectoredSpots;
+	// GetResourcePoints and SaveResourceMap run as a job, see StartInit
+	std::shared_future<void> analysisJob;
+	std::string cacheFileName;
 };
 
 #endif // _RESOURCE_MAP_ANALYZER_H
@@ -0,0 +1,319 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ResourceSpotFinder.h"
+
+#include "lib/streflop/streflop_cond.h"
+
+#include <algorithm>
+#include <array>
+
+#include "System/Misc/TracyDefs.h"
+
+// rows per value histogram, see FindBestSpots
+static constexpr int STRIPE_ROWS = 32;
+static constexpr int MAX_BEST_SPOTS = 256;
+
+
+void CResourceSpotFinder::Init(const unsigned char* resourceMap, int mapWidth, int mapHeight, int extractorRadius)
+{
+	this->mapWidth = mapWidth;
+	this->mapHeight = mapHeight;
+
+	totalCells = mapWidth * mapHeight;
+	xtractorRadius = extractorRadius;
+	doubleRadius = xtractorRadius * 2;
+	maxResource = 0;
+
+	xend.resize(doubleRadius + 1);
+
+	for (int a = 0; a < doubleRadius + 1; a++) {
+		float z = a - xtractorRadius;
+		float floatsqrradius = xtractorRadius * xtractorRadius;
+		xend[a] = int(math::sqrt(floatsqrradius - z * z));
+	}
+
+	rexArrayA.assign(resourceMap, resourceMap + totalCells);
+	rexArrayB.resize(totalCells);
+	tempAverage.resize(totalCells);
+
+	totalResources = 0.0;
+
+	for (int i = 0; i < totalCells; i++) {
+		// count the total resources so you can work out
+		// an average of the whole map
+		totalResources += rexArrayA[i];
+	}
+}
+
+void CResourceSpotFinder::Kill()
+{
+	xend.clear();
+	rexArrayA.clear();
+	rexArrayB.clear();
+	tempAverage.clear();
+
+	rexArrayA.shrink_to_fit();
+	rexArrayB.shrink_to_fit();
+	tempAverage.shrink_to_fit();
+}
+
+
+void CResourceSpotFinder::FindSpots(std::vector<Spot>& spots, int maxSpots, int minValue)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	// if the map does not have any resource (quick test), just stop
+	if (totalResources < 0.9)
+		return;
+
+	// Now work out how much resources each spot can make
+	// by adding up the resources from nearby spots
+	for (int y = 0; y < mapHeight; y++) {
+		CalcAverageRow(y);
+	}
+
+	// find the spot with the highest resource value to set as the map's max
+	maxResource = std::max(maxResource, *std::max_element(tempAverage.begin(), tempAverage.end()));
+
+	// this will get the total resources a rex placed at each spot would make
+	for (int i = 0; i < totalCells; i++) {
+		// scale the resources so any map will have values 0-255,
+		// no matter how much resources it has
+		rexArrayB[i] = tempAverage[i] * 255 / maxResource;
+	}
+
+	// make a list of the indexes of the best spots
+	std::vector<int> bestSpotList;
+
+	int bestValue = 0;
+	int numberOfValues = 0;
+	int usedSpots = 0;
+
+	FindBestSpots(bestSpotList, bestValue, numberOfValues);
+
+	for (int n = 0; n < maxSpots; n++) {
+		Spot spot = {0, 0, 0};
+		bool found = false;
+
+		while (!found) {
+			if (usedSpots == numberOfValues) {
+				// the list is empty now, refill it
+				FindBestSpots(bestSpotList, bestValue, numberOfValues);
+				usedSpots = 0;
+			}
+
+			// The list is not empty now.
+			const int spotIndex = bestSpotList[usedSpots];
+
+			if (rexArrayB[spotIndex] == bestValue) {
+				// the spot is still valid, so use it
+				spot.x = spotIndex % mapWidth;
+				spot.z = spotIndex / mapWidth;
+				spot.value = bestValue;
+				found = true;
+			}
+
+			// update the bestSpotList index
+			usedSpots++;
+		}
+
+		// if the spots get too crappy stop running the loops to speed it all up
+		if (spot.value < minValue)
+			break;
+
+		spots.push_back(spot);
+
+		// small speedup of "wipes the resources around the spot so it is not counted twice"
+		for (int sy = spot.z - xtractorRadius, a = 0;  sy <= spot.z + xtractorRadius;  sy++, a++) {
+			if (sy >= 0 && sy < mapHeight) {
+				const int clearXStart = std::max(spot.x - xend[a], 0);
+				const int clearXEnd = std::min(spot.x + xend[a], mapWidth - 1);
+
+				for (int xClear = clearXStart; xClear <= clearXEnd; xClear++) {
+					// wipes the resources around the spot so it is not counted twice
+					rexArrayA[sy * mapWidth + xClear] = 0;
+					rexArrayB[sy * mapWidth + xClear] = 0;
+					tempAverage[sy * mapWidth + xClear] = 0;
+				}
+			}
+		}
+
+		// redo the whole averaging process around the picked spot so other spots can be found around it
+		for (int y = spot.z - doubleRadius; y <= spot.z + doubleRadius; y++) {
+			if (y >= 0 && y < mapHeight) {
+				for (int x = spot.x - doubleRadius; x <= spot.x + doubleRadius; x++) {
+					if (x >= 0 && x < mapWidth) {
+						CalcAverageSquare(x, y);
+					}
+				}
+			}
+		}
+	}
+}
+
+
+// sums the resources within extractor range of every pixel in row <y>; the
+// first pixel is summed in full so that rows do not depend on each other
+void CResourceSpotFinder::CalcAverageRow(int y)
+{
+	int rowResources = 0;
+
+	for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+		if (sy >= 0 && sy < mapHeight) {
+			for (int sx = 0; sx <= xend[a] && sx < mapWidth; sx++) {
+				rowResources += rexArrayA[sy * mapWidth + sx];
+			}
+		}
+	}
+
+	tempAverage[y * mapWidth] = rowResources;
+
+	for (int x = 1; x < mapWidth; x++) {
+		for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+			if (sy >= 0 && sy < mapHeight) {
+				const int addX = x + xend[a];
+				const int remX = x - xend[a] - 1;
+
+				if (addX < mapWidth) {
+					rowResources += rexArrayA[sy * mapWidth + addX];
+				}
+				if (remX >= 0) {
+					rowResources -= rexArrayA[sy * mapWidth + remX];
+				}
+			}
+		}
+
+		tempAverage[y * mapWidth + x] = rowResources;
+	}
+}
+
+// re-sums pixel <x,y> from its left (or upper) neighbour after resources were
+// wiped around a picked spot, and rescales it
+void CResourceSpotFinder::CalcAverageSquare(int x, int y)
+{
+	int squareResources = 0;
+
+	if (x == 0 && y == 0) {
+		for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+			if (sy >= 0 && sy < mapHeight) {
+				for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
+					if (sx >= 0 && sx < mapWidth) {
+						// get the resources from all pixels around the extractor radius
+						squareResources += rexArrayA[sy * mapWidth + sx];
+					}
+				}
+			}
+		}
+	}
+
+	// quick calc test
+	if (x > 0) {
+		squareResources = tempAverage[y * mapWidth + x - 1];
+
+		for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+			if (sy >= 0 && sy < mapHeight) {
+				const int addX = x + xend[a];
+				const int remX = x - xend[a] - 1;
+
+				if (addX < mapWidth) {
+					squareResources += rexArrayA[sy * mapWidth + addX];
+				}
+				if (remX >= 0) {
+					squareResources -= rexArrayA[sy * mapWidth + remX];
+				}
+			}
+		}
+	} else if (y > 0) {
+		// x == 0 here
+		squareResources = tempAverage[(y - 1) * mapWidth];
+		// remove the top half
+		int a = xtractorRadius;
+
+		for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
+			if (sx < mapWidth) {
+				const int remY = y - xend[a] - 1;
+
+				if (remY >= 0) {
+					squareResources -= rexArrayA[remY * mapWidth + sx];
+				}
+			}
+		}
+
+		// add the bottom half
+		a = xtractorRadius;
+
+		for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
+			if (sx < mapWidth) {
+				const int addY = y + xend[a];
+
+				if (addY < mapHeight) {
+					squareResources += rexArrayA[addY * mapWidth + sx];
+				}
+			}
+		}
+	}
+
+	tempAverage[y * mapWidth + x] = squareResources;
+	// set that spot's resource amount
+	rexArrayB[y * mapWidth + x] = squareResources * 255 / maxResource;
+}
+
+// finds the highest value in rexArrayB and lists the indices (in order) of
+// at most MAX_BEST_SPOTS pixels that have it
+void CResourceSpotFinder::FindBestSpots(std::vector<int>& bestSpotList, int& bestValue, int& numberOfValues) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	const int stripeCells = STRIPE_ROWS * mapWidth;
+	const int numStripes = (mapHeight + STRIPE_ROWS - 1) / STRIPE_ROWS;
+
+	// distribution of values per stripe of rows, so only stripes that
+	// contain the best value have to be searched for it again
+	std::vector<std::array<int, 256>> stripeValueDists(numStripes);
+	std::array<int, 256> valueDist = {};
+
+	for (int s = 0; s < numStripes; s++) {
+		std::array<int, 256>& stripeValueDist = stripeValueDists[s];
+		stripeValueDist.fill(0);
+
+		for (int i = s * stripeCells, e = std::min(i + stripeCells, totalCells); i < e; i++) {
+			stripeValueDist[rexArrayB[i]]++;
+		}
+		for (int i = 0; i < 256; i++) {
+			valueDist[i] += stripeValueDist[i];
+		}
+	}
+
+	// find the current best value
+	bestValue = 0;
+	numberOfValues = 0;
+
+	for (int i = 255; i >= 0; i--) {
+		if (valueDist[i] != 0) {
+			bestValue = i;
+			numberOfValues = valueDist[i];
+			break;
+		}
+	}
+
+	// make sure that the list wont be too big
+	numberOfValues = std::min(numberOfValues, MAX_BEST_SPOTS);
+
+	bestSpotList.clear();
+	bestSpotList.reserve(numberOfValues);
+
+	for (int s = 0; s < numStripes && static_cast<int>(bestSpotList.size()) < numberOfValues; s++) {
+		if (stripeValueDists[s][bestValue] == 0)
+			continue;
+
+		for (int i = s * stripeCells, e = std::min(i + stripeCells, totalCells); i < e; i++) {
+			if (rexArrayB[i] != bestValue)
+				continue;
+
+			bestSpotList.push_back(i);
+
+			if (static_cast<int>(bestSpotList.size()) == numberOfValues)
+				break;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _RESOURCE_SPOT_FINDER_H
+#define _RESOURCE_SPOT_FINDER_H
+
+#include <vector>
+
+/**
+ * Greedy search for extractor spots on a resource map, the part of
+ * CResourceMapAnalyzer that does not depend on the running game.
+ * Runs serially, since the analyzer calls it from a background job.
+ */
+class CResourceSpotFinder {
+public:
+	struct Spot {
+		// resource map coordinates
+		int x;
+		int z;
+		// from 0-255, relative to the richest spot (see GetMaxResource)
+		int value;
+	};
+
+public:
+	/// copies <resourceMap>, <mapWidth> * <mapHeight> pixels
+	void Init(const unsigned char* resourceMap, int mapWidth, int mapHeight, int extractorRadius);
+	void Kill();
+
+	/**
+	 * Appends at most <maxSpots> spots whose value is at least <minValue>
+	 * to <spots>, in the order they are picked. Consumes the copied map.
+	 */
+	void FindSpots(std::vector<Spot>& spots, int maxSpots, int minValue);
+
+	double GetTotalResources() const { return totalResources; }
+	/// extractor-range sum of the richest spot, valid after FindSpots
+	int GetMaxResource() const { return maxResource; }
+
+private:
+	void CalcAverageRow(int y);
+	void CalcAverageSquare(int x, int y);
+	void FindBestSpots(std::vector<int>& bestSpotList, int& bestValue, int& numberOfValues) const;
+
+	int mapWidth = 0;
+	int mapHeight = 0;
+	int totalCells = 0;
+	int xtractorRadius = 0;
+	int doubleRadius = 0;
+	int maxResource = 0;
+
+	double totalResources = 0.0;
+
+	// half-widths of the extractor disc per row
+	std::vector<int> xend;
+
+	std::vector<unsigned char> rexArrayA;
+	std::vector<unsigned char> rexArrayB;
+	std::vector<int> tempAverage;
+};
+
+#endif // _RESOURCE_SPOT_FINDER_H
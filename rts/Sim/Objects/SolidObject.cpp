@@ -3,6 +3,7 @@
 
 #include "SolidObject.h"
 #include "SolidObjectDef.h"
+#include "YardMapMasks.h"
 #include "Map/ReadMap.h"
 #include "Map/Ground.h"
 #include "Sim/Misc/CollisionVolume.h"
@@ -277,32 +278,11 @@ YardMapStatus CSolidObject::GetGroundBlockingMaskAtPos(float3 gpos) const
 	if (blockMap == nullptr)
 		return YARDMAP_OPEN;
 
-	const int2 hFootprint{footprint.x >> 1, footprint.y >> 1};
-	const int2 hSize{ xsize >> 1, zsize >> 1};
-
 	const int2 gPos2
 			{ int(gpos.x / SQUARE_SIZE)
 			, int(gpos.z / SQUARE_SIZE)};
-	const int2 diff = gPos2 - (mapPos + hSize);
-
-	constexpr int2 rotationDirs[] = { {0,1}, {1,0}, {0,-1}, {-1,0}, {0,1} };
-	const int2 front = rotationDirs[buildFacing];
-	const int2 right = rotationDirs[buildFacing+1];
-
-	// corrections needed because the rotation is off centre.
-	constexpr int2 rotationCorrections[] = { {0,0}, {-1,0}, {-1,-1}, {0,-1} };
-	const int2 adjust = rotationCorrections[buildFacing];
-
-	// Translate from map-space to yardmap-space
-	// negative result overflows to super high number
-	const uint32_t by = (front.x*diff.x) + (front.y*diff.y) + hFootprint.y + adjust.y;
-	const uint32_t bx = (right.x*diff.x) + (right.y*diff.y) + hFootprint.x + adjust.x;
-
-	if ((bx >= footprint.x) || (by >= footprint.y))
-		return YARDMAP_OPEN;
 
-	// read from blockmap
-	return blockMap[bx + by*footprint.x];
+	return CYardMapMasks::GetBlockingState(blockMap, footprint, buildFacing, gPos2.x - mapPos.x, gPos2.y - mapPos.y);
 }
 
 int2 CSolidObject::GetMapPosStatic(const float3& position, int xsize, int zsize)
@@ -9,10 +9,10 @@
 #include "Lua/LuaRulesParams.h"
 #include "Rendering/Models/3DModel.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "Sim/Objects/YardMapStatus.h"
 #include "System/Matrix44f.h"
 #include "System/type2.h"
 #include "System/Ecs/EcsMain.h"
-#include "System/Misc/BitwiseEnum.h"
 #include "System/Sync/SyncedFloat3.h"
 #include "System/Sync/SyncedPrimitive.h"
 
@@ -20,6 +20,7 @@ struct MoveDef;
 struct LocalModelPiece;
 struct SolidObjectDef;
 
+class CYardMapMasks;
 class DamageArray;
 class CUnit;
 
@@ -32,24 +33,6 @@ enum TerrainChangeTypes {
 	TERRAINCHANGE_OBJECT_DELETED       = 5,
 };
 
-enum YardmapStates {
-	YARDMAP_OPEN         = 0,    // always free      (    walkable      buildable)
-	YARDMAP_STACKABLE    = 1,    // can be built on top of YARDMAP_BLOCKED
-	YARDMAP_GEOSTACKABLE = 2,    // can be built on top of YARDMAP_BLOCKED and needs GEO
-	YARDMAP_YARD         = 4,    // walkable when yard is open
-	YARDMAP_YARDINV      = 8,    // walkable when yard is closed
-	YARDMAP_UNBUILDABLE  = 16,   // open for walk    (    walkable, not buildable)
-	YARDMAP_BUILDONLY	 = 32,	 // open for build   (not walkable,     buildable)	
-	YARDMAP_EXITONLY     = 64,   // closed for walk into, closed for build
-	YARDMAP_BLOCKED      = 0xFF & ~(YARDMAP_YARDINV|YARDMAP_EXITONLY|YARDMAP_UNBUILDABLE), // always block     (not walkable, not buildable)
-
-	// helpers
-	YARDMAP_YARDBLOCKED  = (YARDMAP_YARD|YARDMAP_EXITONLY|YARDMAP_UNBUILDABLE),
-	YARDMAP_YARDFREE     = ~(YARDMAP_YARD|YARDMAP_EXITONLY|YARDMAP_UNBUILDABLE),
-	YARDMAP_GEO          = YARDMAP_BLOCKED,
-};
-typedef Bitwise::BitwiseEnum<YardmapStates> YardMapStatus;
-
 
 
 class CSolidObject: public CWorldObject {
@@ -136,6 +119,7 @@ public:
 	virtual int GetBlockingMapID() const { return -1; }
 
 	virtual const YardMapStatus* GetBlockMap() const { return nullptr; }
+	virtual const CYardMapMasks* GetYardMapMasks() const { return nullptr; }
 
 	virtual void ForcedMove(const float3& newPos) {}
 	virtual void ForcedSpin(const float3& newDir);
@@ -0,0 +1,101 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "YardMapMasks.h"
+
+#include <utility>
+
+
+void CYardMapMasks::Init(const YardMapStatus* yardMap, int2 footprint)
+{
+	for (int facing = 0; facing < NUM_FACINGS; facing++) {
+		Facing& f = facings[facing];
+
+		f.size = ((facing & 1) == 0)? footprint: int2(footprint.y, footprint.x);
+		f.rowWords = (f.size.x + WORD_BITS - 1) / WORD_BITS;
+
+		f.bits.clear();
+		f.bits.resize(f.size.y * f.rowWords * NUM_PLANES, 0);
+
+		if (yardMap == nullptr)
+			continue;
+
+		for (int z = 0; z < f.size.y; z++) {
+			for (int x = 0; x < f.size.x; x++) {
+				const int blockState = YardmapStates(GetBlockingState(yardMap, footprint, facing, x, z));
+				const int buildState = YardmapStates(yardMap[GetBuildIndex(footprint, facing, x, z)]);
+
+				for (int plane = 0; plane < NUM_STATE_PLANES; plane++) {
+					if ((blockState >> plane) & 1)
+						f.SetBit(x, z, plane);
+				}
+
+				f.SetBit(x, z, PLANE_FOOTPRINT);
+
+				if (buildState <= YARDMAP_STACKABLE)
+					f.SetBit(x, z, PLANE_STACKABLE);
+				if (buildState <= YARDMAP_GEOSTACKABLE)
+					f.SetBit(x, z, PLANE_GEOSTACKABLE);
+				if (buildState == YARDMAP_BUILDONLY)
+					f.SetBit(x, z, PLANE_BUILDONLY);
+			}
+		}
+	}
+}
+
+
+YardMapStatus CYardMapMasks::GetBlockingState(const YardMapStatus* yardMap, int2 footprint, int facing, int x, int z)
+{
+	// rotated around the footprint center, squares outside the yardmap are open
+	const int2 hFootprint{footprint.x >> 1, footprint.y >> 1};
+	const int2 hSize = ((facing & 1) == 0)? hFootprint: int2(hFootprint.y, hFootprint.x);
+	const int2 diff = int2(x, z) - hSize;
+
+	constexpr int2 rotationDirs[] = { {0,1}, {1,0}, {0,-1}, {-1,0}, {0,1} };
+	const int2 front = rotationDirs[facing];
+	const int2 right = rotationDirs[facing + 1];
+
+	// corrections needed because the rotation is off centre.
+	constexpr int2 rotationCorrections[] = { {0,0}, {-1,0}, {-1,-1}, {0,-1} };
+	const int2 adjust = rotationCorrections[facing];
+
+	const uint32_t by = (front.x * diff.x) + (front.y * diff.y) + hFootprint.y + adjust.y;
+	const uint32_t bx = (right.x * diff.x) + (right.y * diff.y) + hFootprint.x + adjust.x;
+
+	if ((bx >= uint32_t(footprint.x)) || (by >= uint32_t(footprint.y)))
+		return YARDMAP_OPEN;
+
+	return yardMap[bx + by * footprint.x];
+}
+
+int CYardMapMasks::GetBuildIndex(int2 footprint, int facing, int x, int z)
+{
+	int yardX = x;
+	int yardZ = z;
+	int yardXR = ((facing & 1) == 0)? footprint.x: footprint.y;
+	int yardZR = ((facing & 1) == 0)? footprint.y: footprint.x;
+
+	switch (facing) {
+		default: {
+			// FACING_SOUTH don't need to do any remapping
+		} break;
+
+		case 2: { // FACING_NORTH
+			yardX = yardXR - yardX - 1; //mirror yardX
+			yardZ = yardZR - yardZ - 1; //mirror yardZ
+		} break;
+
+		case 1: { // FACING_EAST
+			yardZ = yardZR - yardZ - 1; //mirror yardZ
+			std::swap(yardX , yardZ );  //swap yard{X,Z}
+			std::swap(yardXR, yardZR);  //swap yard{XR,ZR}
+		} break;
+
+		case 3: { // FACING_WEST
+			yardX = yardXR - yardX - 1; //mirror yardX
+			std::swap(yardX , yardZ );  //swap yard{X,Z}
+			std::swap(yardXR, yardZR);  //swap yard{XR,ZR}
+		} break;
+	}
+
+	return yardX + yardXR * yardZ;
+}
@@ -0,0 +1,135 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef YARDMAP_MASKS_H
+#define YARDMAP_MASKS_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "Sim/Objects/YardMapStatus.h"
+#include "System/type2.h"
+
+/**
+ * Yardmap of a building type precompiled per facing into rows of bitmasks,
+ * one bit per footprint square, so stamping a building into (or clearing it
+ * from) the blocking-map and testing build sites can skip whole words instead
+ * of translating and rotating every square individually.
+ *
+ * Each row stores one bit-plane per YardmapStates bit plus a few derived
+ * planes; rows are laid out in map-space relative to the object's mapPos.
+ */
+class CYardMapMasks
+{
+public:
+	typedef uint64_t Word;
+
+	static constexpr int WORD_BITS = 64;
+	static constexpr int NUM_FACINGS = 4;
+
+	enum Planes {
+		// planes 0-7 hold the YardmapStates bits, in blocking-map layout
+		NUM_STATE_PLANES   = 8,
+		// every square of the footprint
+		PLANE_FOOTPRINT    = NUM_STATE_PLANES + 0,
+		// squares whose state is <= YARDMAP_STACKABLE / YARDMAP_GEOSTACKABLE or
+		// equal to YARDMAP_BUILDONLY, in build-test layout (see GetBuildIndex)
+		PLANE_STACKABLE    = NUM_STATE_PLANES + 1,
+		PLANE_GEOSTACKABLE = NUM_STATE_PLANES + 2,
+		PLANE_BUILDONLY    = NUM_STATE_PLANES + 3,
+		NUM_PLANES         = NUM_STATE_PLANES + 4,
+	};
+
+	static constexpr int ALL_SQUARES = 1 << PLANE_FOOTPRINT;
+
+public:
+	void Init(const YardMapStatus* yardMap, int2 footprint);
+
+	/// converts a yardmap-state mask to the equivalent set of state planes
+	static constexpr int GetStatePlanes(int stateMask) { return (stateMask & ((1 << NUM_STATE_PLANES) - 1)); }
+
+	/// state of square <x,z> as CSolidObject::GetGroundBlockingMaskAtPos would return it
+	static YardMapStatus GetBlockingState(const YardMapStatus* yardMap, int2 footprint, int facing, int x, int z);
+	/// yardmap index of square <x,z> as seen by build-site tests
+	static int GetBuildIndex(int2 footprint, int facing, int x, int z);
+
+	int2 GetSize(int facing) const { return facings[facing].size; }
+	/**
+	 * part of the yardmap rotated by <facing> that overlaps an object footprint
+	 * of <size> squares; these differ when buildFacing was changed without also
+	 * changing xsize and zsize (e.g. by CMD_UNLOAD_UNIT), squares outside the
+	 * yardmap are open
+	 */
+	int2 GetClippedSize(int facing, int2 size) const {
+		return {std::min(size.x, facings[facing].size.x), std::min(size.y, facings[facing].size.y)};
+	}
+
+	/**
+	 * calls func(x) for every square <x> < <numSquares> in row <z> of the yardmap
+	 * rotated by <facing> that is set in any of the <include> planes and in none
+	 * of the <exclude> planes
+	 */
+	template<typename Func>
+	void ForEachSquare(int facing, int z, int numSquares, int include, int exclude, Func&& func) const;
+
+	bool TestSquare(int facing, int x, int z, int plane) const {
+		const Facing& f = facings[facing];
+
+		if (static_cast<unsigned>(x) >= static_cast<unsigned>(f.size.x) || static_cast<unsigned>(z) >= static_cast<unsigned>(f.size.y))
+			return false;
+
+		return ((f.GetRow(z)[(x / WORD_BITS) * NUM_PLANES + plane] >> (x % WORD_BITS)) & 1);
+	}
+
+private:
+	struct Facing {
+		const Word* GetRow(int z) const { return &bits[z * rowWords * NUM_PLANES]; }
+
+		void SetBit(int x, int z, int plane) {
+			bits[(z * rowWords + x / WORD_BITS) * NUM_PLANES + plane] |= (Word(1) << (x % WORD_BITS));
+		}
+
+		int2 size;
+		int rowWords = 0;
+
+		/// NUM_PLANES words per row-word, rows in increasing z
+		std::vector<Word> bits;
+	};
+
+	std::array<Facing, NUM_FACINGS> facings;
+};
+
+
+template<typename Func>
+inline void CYardMapMasks::ForEachSquare(int facing, int z, int numSquares, int include, int exclude, Func&& func) const
+{
+	const Facing& f = facings[facing];
+
+	assert(z >= 0 && z < f.size.y);
+
+	const Word* row = f.GetRow(z);
+	const int numWords = std::min(f.rowWords, (numSquares + WORD_BITS - 1) / WORD_BITS);
+
+	for (int w = 0; w < numWords; w++, row += NUM_PLANES) {
+		Word incBits = 0;
+		Word excBits = 0;
+
+		for (int plane = 0; plane < NUM_PLANES; plane++) {
+			incBits |= (row[plane] * ((include >> plane) & 1));
+			excBits |= (row[plane] * ((exclude >> plane) & 1));
+		}
+
+		// drop the squares past <numSquares> in the last word
+		if ((w + 1) * WORD_BITS > numSquares)
+			incBits &= ((Word(1) << (numSquares - w * WORD_BITS)) - 1);
+
+		for (Word bits = incBits & ~excBits; bits != 0; bits &= (bits - 1)) {
+			func(w * WORD_BITS + std::countr_zero(bits));
+		}
+	}
+}
+
+#endif // YARDMAP_MASKS_H
@@ -0,0 +1,26 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef YARDMAP_STATUS_H
+#define YARDMAP_STATUS_H
+
+#include "System/Misc/BitwiseEnum.h"
+
+enum YardmapStates {
+	YARDMAP_OPEN         = 0,    // always free      (    walkable      buildable)
+	YARDMAP_STACKABLE    = 1,    // can be built on top of YARDMAP_BLOCKED
+	YARDMAP_GEOSTACKABLE = 2,    // can be built on top of YARDMAP_BLOCKED and needs GEO
+	YARDMAP_YARD         = 4,    // walkable when yard is open
+	YARDMAP_YARDINV      = 8,    // walkable when yard is closed
+	YARDMAP_UNBUILDABLE  = 16,   // open for walk    (    walkable, not buildable)
+	YARDMAP_BUILDONLY	 = 32,	 // open for build   (not walkable,     buildable)	
+	YARDMAP_EXITONLY     = 64,   // closed for walk into, closed for build
+	YARDMAP_BLOCKED      = 0xFF & ~(YARDMAP_YARDINV|YARDMAP_EXITONLY|YARDMAP_UNBUILDABLE), // always block     (not walkable, not buildable)
+
+	// helpers
+	YARDMAP_YARDBLOCKED  = (YARDMAP_YARD|YARDMAP_EXITONLY|YARDMAP_UNBUILDABLE),
+	YARDMAP_YARDFREE     = ~(YARDMAP_YARD|YARDMAP_EXITONLY|YARDMAP_UNBUILDABLE),
+	YARDMAP_GEO          = YARDMAP_BLOCKED,
+};
+typedef Bitwise::BitwiseEnum<YardmapStates> YardMapStatus;
+
+#endif // YARDMAP_STATUS_H
@@ -26,9 +26,13 @@ void PathHeatMap::Init(unsigned int scalex, unsigned int scalez) {
 	xsize  = mapDims.hmapx / xscale;
 	zsize  = mapDims.hmapy / zscale;
 
+	blockxsize = mapDims.mapx / MEDRES_PE_BLOCKSIZE;
+	blockzsize = mapDims.mapy / MEDRES_PE_BLOCKSIZE;
+
 	heatMapOffset = 0;
 
 	heatMap.resize(xsize * zsize);
+	blockHeatMap.resize(blockxsize * blockzsize);
 }
 
 unsigned int PathHeatMap::GetHeatMapIndex(unsigned int hmx, unsigned int hmz) const {
@@ -93,6 +97,30 @@ void PathHeatMap::UpdateHeatValue(unsigned int x, unsigned int y, unsigned int v
 		heatMap[idx].value = value + heatMapOffset;
 		heatMap[idx].ownerID = ownerID;
 	}
+
+	const unsigned int bx = std::min(x / MEDRES_PE_BLOCKSIZE, blockxsize - 1);
+	const unsigned int bz = std::min(y / MEDRES_PE_BLOCKSIZE, blockzsize - 1);
+	unsigned int& blockValue = blockHeatMap[bz * blockxsize + bx];
+
+	blockValue = std::max(blockValue, value + heatMapOffset);
+}
+
+unsigned int PathHeatMap::GetBlockHeatValue(unsigned int blockX, unsigned int blockZ, unsigned int blockSize) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// PE blocks are MEDRES_PE_BLOCKSIZE or a multiple thereof
+	const unsigned int scale = std::max(1u, blockSize / MEDRES_PE_BLOCKSIZE);
+	const unsigned int minx = blockX * scale, maxx = std::min(minx + scale, blockxsize);
+	const unsigned int minz = blockZ * scale, maxz = std::min(minz + scale, blockzsize);
+
+	unsigned int val = 0;
+
+	for (unsigned int z = minz; z < maxz; z++) {
+		for (unsigned int x = minx; x < maxx; x++) {
+			val = std::max(val, blockHeatMap[z * blockxsize + x]);
+		}
+	}
+
+	return ((val - heatMapOffset) * (heatMapOffset < val));
 }
 
 float PathHeatMap::GetHeatCost(unsigned int x, unsigned int z, const MoveDef& md, unsigned int ownerID) const {
@@ -24,6 +24,7 @@ public:
 	void Init(unsigned int sizex, unsigned int sizez);
 	void Kill() {
 		heatMap.clear();
+		blockHeatMap.clear();
 		pathSquares.clear();
 	}
 
@@ -44,6 +45,9 @@ public:
 
 	float GetHeatCost(unsigned int x, unsigned int z, const MoveDef&, unsigned int ownerID) const;
 
+	// max. heat within a PE block, in block coordinates
+	unsigned int GetBlockHeatValue(unsigned int blockX, unsigned int blockZ, unsigned int blockSize) const;
+
 private:
 	struct HeatCell {
 		unsigned int value = 0;
@@ -53,10 +57,13 @@ private:
 
 	// resolution is hmapx*hmapy
 	std::vector<HeatCell> heatMap;
+	// max. value per MEDRES_PE_BLOCKSIZE^2 squares
+	std::vector<unsigned int> blockHeatMap;
 	std::vector<int2> pathSquares;
 
 	unsigned int xscale = 0, xsize = 0;
 	unsigned int zscale = 0, zsize = 0;
+	unsigned int blockxsize = 0, blockzsize = 0;
 
 	// heatmap values are relative to this
 	unsigned int heatMapOffset = 0;
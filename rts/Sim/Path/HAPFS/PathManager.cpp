@@ -810,10 +810,18 @@ void CPathManager::Update()
 			frameNumToRefreshPathStateWorkloadRatio = gs->frameNum + GAME_SPEED;
 		}
 
-		if (gs->frameNum % pathStateWorkloadRatio)
-			highPriorityResPS->Update();
-		else
-			lowPriorityResPS->Update();
+		PathingState* updatePS = (gs->frameNum % pathStateWorkloadRatio)? highPriorityResPS: lowPriorityResPS;
+
+		// let the estimator refresh blocks around this frame's requests first
+		auto pathSearchView = registry.view<PathSearch>();
+		for (entt::entity entity: pathSearchView) {
+			const PathSearch& pathSearch = pathSearchView.get<PathSearch>(entity);
+
+			updatePS->AddRequestProximity(pathSearch.startPos);
+			updatePS->AddRequestProximity(pathSearch.goalPos);
+		}
+
+		updatePS->Update();
 	}
 	{
 		SCOPED_TIMER("Sim::PathRequests");
@@ -2,8 +2,9 @@
 
 #include "PathingState.h"
 
+#include <fstream>
+
 #include "zlib.h"
-#include "minizip/zip.h"
 
 #include "Game/GlobalUnsynced.h"
 #include "Game/LoadScreen.h"
@@ -16,19 +17,21 @@
 #include "IPath.h"
 #include "PathConstants.h"
 #include "PathFinderDef.h"
+#include "PathHeatMap.h"
 #include "PathLog.h"
 #include "Sim/Path/HAPFS/PathGlobal.h"
 #include "PathMemPool.h"
 
 #include "System/Config/ConfigHandler.h"
-#include "System/FileSystem/Archives/IArchive.h"
-#include "System/FileSystem/ArchiveLoader.h"
+#include "System/CRC.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/Platform/Threading.h"
 #include "System/StringUtil.h"
+#include "System/Sync/SHA512.hpp"
 #include "System/Threading/ThreadPool.h" // for_mt
+#include "System/TimeProfiler.h"
 
 #include "System/Misc/TracyDefs.h"
 
@@ -36,6 +39,27 @@
 
 static constexpr int BLOCK_UPDATE_DELAY_FRAMES = GAME_SPEED / 2;
 
+// blocks within this distance of a pending request are updated first
+static constexpr int REQUEST_PROXIMITY_RADIUS = 2;
+
+// cache-file layout: header | chunk-table | page-aligned chunks
+// chunk 0 holds the block-offsets of all pathTypes and is read
+// eagerly, chunk 1+N holds the vertex-costs of pathType N which
+// are only inflated once the estimator first touches them
+static constexpr char CACHE_FILE_MAGIC[8] = "HAPFSPE";
+static constexpr std::uint32_t CACHE_FILE_VERSION = 1;
+static constexpr std::uint64_t CACHE_FILE_CHUNK_ALIGNMENT = 4096;
+
+struct CacheFileHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t hashCode;
+	std::uint32_t numMoveDefs;
+	std::uint32_t numBlocks;
+	std::uint32_t numChunks;
+	std::uint32_t chunkAlignment;
+};
+
 namespace HAPFS {
 
 bool TEST_ACTIVE = false;
@@ -53,7 +77,7 @@ static const std::string GetPathCacheDir() {
 
 static const std::string GetCacheFileName(const std::string& fileHashCode, const std::string& peFileName, const std::string& mapFileName) {
 	RECOIL_DETAILED_TRACY_ZONE;
-	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".zip");
+	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".pecache");
 }
 
 void PathingState::KillStatic() { pathingStates = 0; }
@@ -117,6 +141,11 @@ void PathingState::Init(std::vector<IPathFinder*> pathFinderlist, PathingState*
 		updatedBlocks.clear();
 		consumedBlocks.clear();
 		offsetBlocksSortedByCost.clear();
+
+		blockPriorities.clear();
+		requestProximity.clear();
+		requestProximity.resize(mapBlockCount, 0);
+		requestProximityBlocks.clear();
 	}
 
 	PathingState*  childPE = this;
@@ -490,7 +519,8 @@ void PathingState::CalcVertexPathCost(
 
 
 /**
- * Try to read offset and vertices data from file, return false on failure
+ * Try to map the cache-file and read the offset and vertex data, return false
+ * on failure
  */
 bool PathingState::ReadFile(const std::string& peFileName, const std::string& mapFileName)
 {
@@ -503,57 +533,99 @@ bool PathingState::ReadFile(const std::string& peFileName, const std::string& ma
 	if (!FileSystem::FileExists(cacheFileName))
 		return false;
 
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
+	CMappedFile cacheFile;
+	std::vector<CacheFileChunk> cacheFileChunks;
 
-	if (upfile == nullptr || !upfile->IsOpen()) {
+	const auto RejectFile = [&]() {
+		cacheFile.Close();
 		FileSystem::Remove(cacheFileName);
 		return false;
-	}
+	};
+
+	if (!cacheFile.Open(dataDirsAccess.LocateFile(cacheFileName)))
+		return RejectFile();
 
 	char calcMsg[512];
 	sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
 	loadscreen->SetLoadMessage(calcMsg);
 
-	const unsigned fid = upfile->FindFile("pathinfo");
-	if (fid >= upfile->NumFiles()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+	const std::uint8_t* fileData = cacheFile.GetData();
+	const std::uint64_t fileSize = cacheFile.GetSize();
 
-	std::vector<std::uint8_t> buffer;
+	const unsigned int numMoveDefs = moveDefHandler.GetNumMoveDefs();
+	const unsigned int numBlocks = blockStates.GetSize();
 
-	if (!upfile->GetFile(fid, buffer) || buffer.size() < 4) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+	CacheFileHeader header;
 
-	const unsigned int filehash = *(reinterpret_cast<unsigned int*>(&buffer[0]));
-	const unsigned int blockSize = blockStates.GetSize() * sizeof(short2);
-	unsigned int pos = sizeof(unsigned);
+	if (fileSize < sizeof(header))
+		return RejectFile();
 
-	if (filehash != fileHashCode) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+	std::memcpy(&header, fileData, sizeof(header));
 
-	if (buffer.size() < (pos + blockSize * moveDefHandler.GetNumMoveDefs())) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+	if (std::memcmp(header.magic, CACHE_FILE_MAGIC, sizeof(header.magic)) != 0)
+		return RejectFile();
+	if (header.version != CACHE_FILE_VERSION || header.hashCode != fileHashCode)
+		return RejectFile();
+	if (header.numMoveDefs != numMoveDefs || header.numBlocks != numBlocks || header.numChunks != (1 + numMoveDefs))
+		return RejectFile();
+	if (fileSize < (sizeof(header) + header.numChunks * sizeof(CacheFileChunk)))
+		return RejectFile();
+
+	cacheFileChunks.resize(header.numChunks);
+	std::memcpy(cacheFileChunks.data(), fileData + sizeof(header), header.numChunks * sizeof(CacheFileChunk));
+
+	const std::uint64_t offsetsSize = numMoveDefs * numBlocks * sizeof(short2);
+	const std::uint64_t costsSize = numBlocks * PATH_DIRECTION_VERTICES * sizeof(float);
+
+	// verify every chunk up-front; only the compressed bytes are touched which is
+	// cheap compared to inflating, and a damaged file is rejected before any of it
+	std::atomic<bool> validChunks = {true};
+
+	for_mt(0, cacheFileChunks.size(), [&](const int i) {
+		const CacheFileChunk& chunk = cacheFileChunks[i];
+
+		if (chunk.rawSize != ((i == 0)? offsetsSize: costsSize) || chunk.offset > fileSize || chunk.packedSize > (fileSize - chunk.offset)) {
+			validChunks = false;
+			return;
+		}
+
+		if (CRC::CalcDigest(fileData + chunk.offset, chunk.packedSize) != chunk.packedCRC)
+			validChunks = false;
+	});
+
+	if (!validChunks)
+		return RejectFile();
 
 	// read center-offset data
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		std::memcpy(&blockStates.peNodeOffsets[pathType][0], &buffer[pos], blockSize);
-		pos += blockSize;
+	{
+		std::vector<std::uint8_t> buffer(offsetsSize);
+
+		if (!InflateChunk(cacheFile, cacheFileChunks[0], buffer.data()))
+			return RejectFile();
+
+		for (unsigned int pathType = 0, pos = 0; pathType < numMoveDefs; ++pathType) {
+			std::memcpy(&blockStates.peNodeOffsets[pathType][0], &buffer[pos], numBlocks * sizeof(short2));
+			pos += (numBlocks * sizeof(short2));
+		}
 	}
 
-	// read vertex-cost data
-	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
-		FileSystem::Remove(cacheFileName);
-		return false;
+	// read vertex-cost data, one chunk per pathType; all of it is resident and
+	// verified against its raw-data CRC before InitEstimator calculates the checksum
+	{
+		const size_t numCosts = numBlocks * PATH_DIRECTION_VERTICES;
+
+		std::atomic<bool> validCosts = {true};
+
+		for_mt(0, numMoveDefs, [&](const int pathType) {
+			if (!InflateChunk(cacheFile, cacheFileChunks[1 + pathType], vertexCosts.data() + pathType * numCosts))
+				validCosts = false;
+		});
+
+		if (!validCosts)
+			return RejectFile();
 	}
 
-	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
+	cacheFile.Close();
 	return true;
 }
 
@@ -573,44 +645,109 @@ bool PathingState::WriteFile(const std::string& peFileName, const std::string& m
 
 	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
-	// open file for writing in a suitable location
-	zipFile file = zipOpen(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE).c_str(), APPEND_STATUS_CREATE);
+	const unsigned int numMoveDefs = moveDefHandler.GetNumMoveDefs();
+	const unsigned int numBlocks = blockStates.GetSize();
+	const unsigned int numCosts = numBlocks * PATH_DIRECTION_VERTICES;
+
+	std::vector<std::uint8_t> rawOffsets(numMoveDefs * numBlocks * sizeof(short2));
+	std::vector< std::vector<std::uint8_t> > packedChunks(1 + numMoveDefs);
+	std::vector<CacheFileChunk> chunks(1 + numMoveDefs);
 
-	if (file == nullptr)
+	for (unsigned int pathType = 0, pos = 0; pathType < numMoveDefs; ++pathType) {
+		std::memcpy(&rawOffsets[pos], &blockStates.peNodeOffsets[pathType][0], numBlocks * sizeof(short2));
+		pos += (numBlocks * sizeof(short2));
+	}
+
+	// compress chunks independently so they can also be inflated independently
+	for_mt(0, chunks.size(), [&](const int i) {
+		const std::uint8_t* rawData = (i == 0)? rawOffsets.data(): reinterpret_cast<const std::uint8_t*>(vertexCosts.data() + (i - 1) * numCosts);
+		const uLong rawSize = (i == 0)? rawOffsets.size(): (numCosts * sizeof(float));
+
+		uLongf packedSize = compressBound(rawSize);
+		packedChunks[i].resize(packedSize);
+
+		if (compress2(packedChunks[i].data(), &packedSize, rawData, rawSize, Z_BEST_COMPRESSION) != Z_OK)
+			packedSize = 0;
+
+		packedChunks[i].resize(packedSize);
+
+		chunks[i].offset = 0;
+		chunks[i].packedSize = packedSize;
+		chunks[i].rawSize = rawSize;
+		chunks[i].packedCRC = CRC::CalcDigest(packedChunks[i].data(), packedSize);
+		chunks[i].rawCRC = CRC::CalcDigest(rawData, rawSize);
+	});
+
+	if (std::any_of(chunks.begin(), chunks.end(), [](const CacheFileChunk& c) { return (c.packedSize == 0); }))
 		return false;
 
-	zipOpenNewFileInZip(file, "pathinfo", nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_BEST_COMPRESSION);
+	const auto AlignOffset = [](std::uint64_t offset) {
+		return ((offset + CACHE_FILE_CHUNK_ALIGNMENT - 1) & ~(CACHE_FILE_CHUNK_ALIGNMENT - 1));
+	};
 
-	// write hash-code (NOTE: this also affects the CRC!)
-	zipWriteInFileInZip(file, (const void*) &fileHashCode, 4);
+	std::uint64_t offset = AlignOffset(sizeof(CacheFileHeader) + chunks.size() * sizeof(CacheFileChunk));
 
-	// write center-offsets
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		zipWriteInFileInZip(file, (const void*) &blockStates.peNodeOffsets[pathType][0], blockStates.peNodeOffsets[pathType].size() * sizeof(short2));
+	for (CacheFileChunk& chunk: chunks) {
+		chunk.offset = offset;
+		offset = AlignOffset(offset + chunk.packedSize);
 	}
 
-	// write vertex-costs
-	zipWriteInFileInZip(file, vertexCosts.data(), vertexCosts.size() * sizeof(float));
+	CacheFileHeader header;
+	std::memcpy(header.magic, CACHE_FILE_MAGIC, sizeof(header.magic));
+	header.version = CACHE_FILE_VERSION;
+	header.hashCode = fileHashCode;
+	header.numMoveDefs = numMoveDefs;
+	header.numBlocks = numBlocks;
+	header.numChunks = chunks.size();
+	header.chunkAlignment = CACHE_FILE_CHUNK_ALIGNMENT;
 
-	zipCloseFileInZip(file);
-	zipClose(file, nullptr);
+	// open file for writing in a suitable location
+	std::ofstream file(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE), std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
 
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(CacheFileChunk));
 
-	// get the CRC over the written path data
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
+	std::uint64_t filePos = sizeof(header) + chunks.size() * sizeof(CacheFileChunk);
 
-	if (upfile == nullptr || !upfile->IsOpen()) {
+	for (size_t i = 0; i < chunks.size(); i++) {
+		// zero-pad up to the chunk's page boundary
+		for (; filePos < chunks[i].offset; filePos++) {
+			file.put(0);
+		}
+
+		file.write(reinterpret_cast<const char*>(packedChunks[i].data()), chunks[i].packedSize);
+		filePos += chunks[i].packedSize;
+	}
+
+	file.close();
+
+	if (!file.good()) {
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	assert(upfile->FindFile("pathinfo") < upfile->NumFiles());
 	return true;
 }
 
 
+bool PathingState::InflateChunk(const CMappedFile& file, const CacheFileChunk& chunk, void* rawData)
+{
+	uLongf rawSize = chunk.rawSize;
+
+	if (uncompress(reinterpret_cast<Bytef*>(rawData), &rawSize, file.GetData() + chunk.offset, chunk.packedSize) != Z_OK)
+		return false;
+	if (rawSize != chunk.rawSize)
+		return false;
+
+	return (CRC::CalcDigest(rawData, rawSize) == chunk.rawCRC);
+}
+
 /**
- * Update some obsolete blocks using the FIFO-principle
+ * Update some obsolete blocks, those on active routes first and
+ * otherwise using the FIFO-principle
  */
 void PathingState::Update()
 {
@@ -625,8 +762,10 @@ void PathingState::Update()
 	if (numMoveDefs == 0)
 		return;
 
-	if (updatedBlocks.empty())
+	if (updatedBlocks.empty()) {
+		ClearRequestProximity();
 		return;
+	}
 
 	// determine how many blocks we should update
 	int blocksToUpdate = 0;
@@ -668,6 +807,9 @@ void PathingState::UpdateVertexPathCosts(int blocksToUpdate)
 	consumedBlocks.clear();
 	consumedBlocks.reserve(consumeBlocks);
 
+	PrioritizeUpdatedBlocks(consumeBlocks / numMoveDefs);
+	ClearRequestProximity();
+
 	//LOG("PathingState::Update %d", updatedBlocks.size());
 
 	std::vector<int> blockIds;
@@ -819,6 +961,94 @@ void PathingState::MapChanged(unsigned int x1, unsigned int z1, unsigned int x2,
 }
 
 
+void PathingState::AddRequestProximity(const float3& pos)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int bx = std::clamp(int(pos.x / BLOCK_PIXEL_SIZE), 0, mapDimensionsInBlocks.x - 1);
+	const int bz = std::clamp(int(pos.z / BLOCK_PIXEL_SIZE), 0, mapDimensionsInBlocks.y - 1);
+
+	for (int z = std::max(bz - REQUEST_PROXIMITY_RADIUS, 0); z <= std::min(bz + REQUEST_PROXIMITY_RADIUS, mapDimensionsInBlocks.y - 1); z++) {
+		for (int x = std::max(bx - REQUEST_PROXIMITY_RADIUS, 0); x <= std::min(bx + REQUEST_PROXIMITY_RADIUS, mapDimensionsInBlocks.x - 1); x++) {
+			const int idx = BlockPosToIdx(int2(x, z));
+			const int dist = std::max(std::abs(x - bx), std::abs(z - bz));
+			const std::uint8_t prox = REQUEST_PROXIMITY_RADIUS + 1 - dist;
+
+			if (requestProximity[idx] == 0)
+				requestProximityBlocks.push_back(idx);
+
+			requestProximity[idx] = std::max(requestProximity[idx], prox);
+		}
+	}
+}
+
+void PathingState::ClearRequestProximity()
+{
+	for (const int idx: requestProximityBlocks) {
+		requestProximity[idx] = 0;
+	}
+
+	requestProximityBlocks.clear();
+}
+
+/**
+ * Moves the numBlocks most important obsolete blocks to the front of
+ * the queue; request proximity outranks path heat, ties (and blocks
+ * with neither) keep their FIFO order so the result is deterministic
+ */
+void PathingState::PrioritizeUpdatedBlocks(size_t numBlocks)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// everything gets consumed anyway
+	if (updatedBlocks.size() <= numBlocks)
+		return;
+
+	blockPriorities.clear();
+	blockPriorities.reserve(updatedBlocks.size());
+
+	bool prioritize = false;
+
+	for (size_t i = 0; i < updatedBlocks.size(); i++) {
+		const int2 pos = updatedBlocks[i];
+		const int idx = BlockPosToIdx(pos);
+
+		if ((blockStates.nodeMask[idx] & PATHOPT_OBSOLETE) == 0)
+			continue;
+
+		const std::uint64_t heat = gPathHeatMap.GetBlockHeatValue(pos.x, pos.y, BLOCK_SIZE);
+		const std::uint64_t prox = requestProximity[idx];
+
+		blockPriorities.push_back({(prox << 32) | heat, static_cast<std::uint32_t>(i)});
+		prioritize |= (blockPriorities.back().priority != 0);
+	}
+
+	if (!prioritize)
+		return;
+
+	numBlocks = std::min(numBlocks, blockPriorities.size());
+
+	const auto sortByPriority = [](const BlockPriority& a, const BlockPriority& b) {
+		if (a.priority != b.priority)
+			return (a.priority > b.priority);
+		return (a.queueIdx < b.queueIdx);
+	};
+	const auto sortByQueueIdx = [](const BlockPriority& a, const BlockPriority& b) {
+		return (a.queueIdx < b.queueIdx);
+	};
+
+	std::partial_sort(blockPriorities.begin(), blockPriorities.begin() + numBlocks, blockPriorities.end(), sortByPriority);
+	std::sort(blockPriorities.begin() + numBlocks, blockPriorities.end(), sortByQueueIdx);
+
+	// stale (non-obsolete) entries were skipped above and are dropped here
+	std::deque<int2> prioritizedBlocks;
+
+	for (const BlockPriority& bp: blockPriorities) {
+		prioritizedBlocks.push_back(updatedBlocks[bp.queueIdx]);
+	}
+
+	updatedBlocks = std::move(prioritizedBlocks);
+}
+
+
 std::uint32_t PathingState::CalcChecksum() const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -9,6 +9,7 @@
 
 #include "IPathFinder.h"
 #include "PathDataTypes.h"
+#include "System/Platform/MappedFile.h"
 #include "System/Threading/SpringThreading.h"
 
 #include "Sim/Path/HAPFS/PathEstimator.h"
@@ -71,6 +72,13 @@ public:
 	 */
 	void MapChanged(unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2);
 
+	/**
+	 * Marks the blocks around a pending path request such that their
+	 * dirty vertices are refreshed before those of far-away blocks on
+	 * the next Update. Hints are consumed by that Update.
+	 */
+	void AddRequestProximity(const float3& pos);
+
 	/**
 	 * Returns a checksum that can be used to check if every player has the same
 	 * path data.
@@ -141,8 +149,15 @@ private:
 	bool ReadFile(const std::string& peFileName, const std::string& mapFileName);
 	bool WriteFile(const std::string& peFileName, const std::string& mapFileName);
 
+	struct CacheFileChunk;
+
+	static bool InflateChunk(const CMappedFile& file, const CacheFileChunk& chunk, void* rawData);
+
 	std::size_t getCountOfUpdates() const { return updatedBlocks.size(); }
 
+	void PrioritizeUpdatedBlocks(size_t numBlocks);
+	void ClearRequestProximity();
+
 private:
 	friend class HAPFS::CPathEstimator;
 
@@ -177,6 +192,16 @@ private:
 
     std::vector<float> maxSpeedMods;
     std::vector<float> vertexCosts;
+
+    // on-disk layout of one zlib-compressed, page-aligned cache-file chunk
+    struct CacheFileChunk {
+        std::uint64_t offset;
+        std::uint32_t packedSize;
+        std::uint32_t rawSize;
+        std::uint32_t packedCRC;
+        std::uint32_t rawCRC;
+    };
+
     std::deque<int2> updatedBlocks;
 
     PathNodeStateBuffer blockStates;
@@ -188,6 +213,15 @@ private:
 	};
 
     std::vector<SingleBlock> consumedBlocks;
+
+	struct BlockPriority {
+		std::uint64_t priority;
+		std::uint32_t queueIdx;
+	};
+
+	std::vector<BlockPriority> blockPriorities;
+	std::vector<std::uint8_t> requestProximity;
+	std::vector<int> requestProximityBlocks;
 	std::vector<SOffsetBlock> offsetBlocksSortedByCost;
 };
 
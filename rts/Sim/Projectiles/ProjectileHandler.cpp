@@ -1,13 +1,16 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <limits>
 
 #include "Projectile.h"
 #include "ProjectileHandler.h"
 #include "ProjectileMemPool.h"
+#include "Game/GameHelper.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/TraceRay.h"
 #include "Map/Ground.h"
+#include "Map/ReadMap.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GroundFlash.h"
 #include "Sim/Features/Feature.h"
@@ -18,7 +21,10 @@
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Rendering/Env/Particles/Classes/NanoProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/MissileProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/StarburstProjectile.h"
 #include "Sim/Projectiles/WeaponProjectiles/WeaponProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/WeaponProjectileTypes.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitHandler.h"
@@ -39,6 +45,13 @@
 #define NORMAL_NANO_PRIO 0.95f
 #define HIGH_NANO_PRIO 1.0f
 
+// below this many candidates per projectile the scalar tests are cheaper than packing a batch
+static constexpr size_t MIN_BATCHED_UNIT_COLLISIONS = 4;
+// maximum number of swept collision broadphase (re)builds per pass
+static constexpr size_t MAX_COLVOL_SWEEPS = 4;
+// below this many guided projectiles their kinematics are not predicted in parallel
+static constexpr size_t MIN_PREDICTED_KINEMATICS = 32;
+
 
 CONFIG(int, MaxParticles).defaultValue(10000).headlessValue(0).minimumValue(0);
 CONFIG(int, MaxNanoParticles).defaultValue(2000).headlessValue(0).minimumValue(0);
@@ -156,6 +169,70 @@ static void MAPPOS_SANITY_CHECK(const float3 v)
 	assert(v.y <=  MAX_PROJECTILE_HEIGHT);
 }
 
+template<typename P>
+struct KinematicsPredictions {
+	void Clear() {
+		for (P* p: projectiles) {
+			p->SetKinematicsPrediction(nullptr);
+		}
+
+		projectiles.clear();
+	}
+
+	void Predict() {
+		if (projectiles.size() < MIN_PREDICTED_KINEMATICS)
+			return;
+
+		// never reallocated while the predictions are referenced
+		predictions.resize(projectiles.size());
+
+		for_mt(0, projectiles.size(), [this](int i) {
+			if (!projectiles[i]->PredictKinematics(predictions[i]))
+				return;
+
+			projectiles[i]->SetKinematicsPrediction(&predictions[i]);
+		});
+	}
+
+	std::vector<P*> projectiles;
+	std::vector<typename P::KinematicsPrediction> predictions;
+};
+
+static KinematicsPredictions<CMissileProjectile> missilePredictions;
+static KinematicsPredictions<CStarburstProjectile> starburstPredictions;
+
+template<typename Container>
+static void PredictGuidedKinematics(const Container& pc)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the steering math of guided projectiles only reads their own and their
+	// target's state, so it can be evaluated for all of them in parallel; the
+	// serial update re-gathers the inputs and falls back to computing them if
+	// anything (e.g. an explosion or Lua callin) changed them in the meantime
+	for (size_t i = 0; i < pc.size(); ++i) {
+		CProjectile* p = pc[i];
+
+		if (!p->weapon)
+			continue;
+
+		switch (p->GetProjectileType()) {
+			case WEAPON_MISSILE_PROJECTILE  : {   missilePredictions.projectiles.push_back(static_cast<  CMissileProjectile*>(p)); } break;
+			case WEAPON_STARBURST_PROJECTILE: { starburstPredictions.projectiles.push_back(static_cast<CStarburstProjectile*>(p)); } break;
+			default: {} break;
+		}
+	}
+
+	missilePredictions.Predict();
+	starburstPredictions.Predict();
+}
+
+static void ClearGuidedKinematics()
+{
+	missilePredictions.Clear();
+	starburstPredictions.Clear();
+}
+
+
 template<bool synced>
 void CProjectileHandler::UpdateProjectilesImpl()
 {
@@ -192,6 +269,8 @@ void CProjectileHandler::UpdateProjectilesImpl()
 	// WARNING: same as above but for p->Update()
 	if constexpr (synced) {
 
+		PredictGuidedKinematics(pc);
+
 		SCOPED_TIMER("Sim::Projectiles::UpdateSyncedST");
 		for (size_t i = 0; i < pc.size(); ++i) {
 			CProjectile* p = pc[i];
@@ -204,6 +283,9 @@ void CProjectileHandler::UpdateProjectilesImpl()
 
 			MAPPOS_SANITY_CHECK(p->pos);
 		}
+
+		// projectiles are only freed at the start of the next update
+		ClearGuidedKinematics();
 	}
 	else {
 		SCOPED_TIMER("Sim::Projectiles::UpdateUnsyncedMT");
@@ -324,10 +406,15 @@ void CProjectileHandler::Update()
 	{
 		SCOPED_TIMER("Sim::Projectiles");
 
+		// radius damage of everything exploding in here is resolved in one go
+		helper->BeginExplosionBatch();
+
 		// check if any projectiles have collided since the previous update
 		CheckCollisions();
 		UpdateProjectiles();
 
+		helper->EndExplosionBatch();
+
 		UPDATE_PTR_CONTAINER(groundFlashes);
 
 		// flying pieces; sort these every now and then
@@ -435,21 +522,84 @@ void CProjectileHandler::CheckUnitCollisions(
 	if (!p->checkCol)
 		return;
 
+	// units whose own volume gets the plain continuous ray-test in DetectHit
+	// are tested as one batch; others (piece-trees, discrete hit-tests) keep
+	// going through DetectHit, and hits are still resolved in tempUnits order
+	static CollisionVolumeBatch unitVolumes;
+	static std::vector<CollisionQuery> unitQueries;
+	static std::vector<int> unitBatchIndices;
+
+	constexpr int UNIT_IGNORED = -2;
+	constexpr int UNIT_UNBATCHED = -1;
+
 	CollisionQuery cq;
 
-	for (CUnit* unit: tempUnits) {
+	unitVolumes.Clear();
+	unitBatchIndices.clear();
+	unitBatchIndices.resize(tempUnits.size(), UNIT_UNBATCHED);
+
+	for (size_t i = 0; i < tempUnits.size(); i++) {
+		const CUnit* unit = tempUnits[i];
+
 		assert(unit != nullptr);
 
 		// if this unit fired this projectile, always ignore
 		if (unit == p->owner())
-			continue;
-		if (!unit->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES))
-			continue;
+			unitBatchIndices[i] = UNIT_IGNORED;
+		else if (!unit->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES))
+			unitBatchIndices[i] = UNIT_IGNORED;
+		else if (!CheckProjectileCollisionFlags(p, unit))
+			unitBatchIndices[i] = UNIT_IGNORED;
+	}
+
+	int firstBatchHit = -1;
+
+	if (tempUnits.size() >= MIN_BATCHED_UNIT_COLLISIONS) {
+		for (size_t i = 0; i < tempUnits.size(); i++) {
+			const CUnit* unit = tempUnits[i];
+			const CollisionVolume* vol = &unit->collisionVolume;
 
-		if (!CheckProjectileCollisionFlags(p, unit))
+			if (unitBatchIndices[i] == UNIT_IGNORED)
+				continue;
+			if (unit->IsInVoid() || vol->DefaultToPieceTree() || vol->IgnoreHits() || !vol->UseContHitTest())
+				continue;
+
+			// same transform DetectHit passes on to the volume test
+			CMatrix44f volMat = unit->GetTransformMatrix(true);
+
+			volMat.Translate(unit->relMidPos);
+			volMat.Translate(vol->GetOffsets());
+
+			unitBatchIndices[i] = unitVolumes.Size();
+			unitVolumes.Add(vol, volMat);
+		}
+
+		unitQueries.clear();
+		unitQueries.resize(unitVolumes.Size());
+
+		firstBatchHit = CCollisionHandler::IntersectBatch(unitVolumes, ppos0, ppos1, unitQueries.data(), nullptr, true);
+	}
+
+	for (size_t i = 0; i < tempUnits.size(); i++) {
+		CUnit* unit = tempUnits[i];
+
+		if (unitBatchIndices[i] == UNIT_IGNORED)
 			continue;
 
-		if (CCollisionHandler::DetectHit(unit, unit->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
+		bool hit = false;
+
+		if (unitBatchIndices[i] >= 0) {
+			// every batched unit before the first batched hit missed
+			if (unitBatchIndices[i] != firstBatchHit)
+				continue;
+
+			cq = unitQueries[firstBatchHit];
+			hit = true;
+		} else {
+			hit = CCollisionHandler::DetectHit(unit, unit->GetTransformMatrix(true), ppos0, ppos1, &cq);
+		}
+
+		if (hit) {
 			if (cq.GetHitPiece() != nullptr)
 				unit->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
 
@@ -560,12 +710,28 @@ void CProjectileHandler::CheckShieldCollisions(
 	}
 }
 
+// shield intercept-types that can affect <p>; zero for all non-weapon projectiles
+static unsigned int GetShieldInterceptMask(const CProjectile* p)
+{
+	if (!p->weapon)
+		return 0;
+
+	return (static_cast<const CWeaponProjectile*>(p)->GetWeaponDef()->interceptedByShieldType);
+}
+
 void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	static std::vector<CUnit*> tempUnits;
 	static std::vector<CFeature*> tempFeatures;
 	static std::vector<CPlasmaRepulser*> tempRepulsers;
+	static QuadFieldColVolBatch colVolBatch;
+
+	// index of the first projectile covered by colVolBatch
+	size_t batchBeg = 0;
+	size_t numSweeps = 0;
+
+	colVolBatch.Clear();
 
 	//can't use iterators here, because instructions inside the loop modify projectiles[synced]
 	for (size_t i = 0; i < projectiles[synced].size(); ++i) {
@@ -578,7 +744,39 @@ void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 		const float3 ppos1 = p->pos + p->speed;
 		// const float3 ppos1 = p->pos + p->dir * (p->speed.w + p->radius);
 
-		quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, tempUnits, tempFeatures, &tempRepulsers);
+		const float queryRadius = p->speed.w + p->radius;
+		// shields CheckShieldCollisions would skip anyway are never gathered
+		const unsigned int repulserMask = GetShieldInterceptMask(p);
+
+		// sweep all remaining projectiles at once; redone only when a collision
+		// changed the quad-field or spawned projectiles beyond the current batch
+		// (each sweep costs about as much as querying the rest one by one, so
+		// frames with many such changes fall back to single queries)
+		const bool sweepStale = ((i - batchBeg) >= colVolBatch.GetNumQueries() || !quadField.IsValidColVolBatch(colVolBatch));
+
+		if (sweepStale && numSweeps < MAX_COLVOL_SWEEPS) {
+			numSweeps += 1;
+			colVolBatch.Clear();
+
+			for (size_t j = (batchBeg = i); j < projectiles[synced].size(); ++j) {
+				const CProjectile* q = projectiles[synced][j];
+
+				if (!q->checkCol || q->deleteMe) {
+					colVolBatch.AddQuery(q->pos, -1.0f);
+				} else {
+					colVolBatch.AddQuery(q->pos, q->speed.w + q->radius, GetShieldInterceptMask(q));
+				}
+			}
+
+			quadField.GetUnitsAndFeaturesColVol(colVolBatch);
+		}
+
+		if (quadField.IsValidColVolBatch(colVolBatch) && colVolBatch.HasQuery(i - batchBeg, p->pos, queryRadius, repulserMask)) {
+			quadField.GetUnitsAndFeaturesColVol(colVolBatch, i - batchBeg, tempUnits, tempFeatures, &tempRepulsers);
+		} else {
+			// quad-field changed, or projectile moved or re-enabled since the sweep
+			quadField.GetUnitsAndFeaturesColVol(p->pos, queryRadius, tempUnits, tempFeatures, (repulserMask != 0)? &tempRepulsers: nullptr, repulserMask);
+		}
 
 		CheckShieldCollisions (p, tempRepulsers, ppos0, ppos1); tempRepulsers.clear();
 		CheckUnitCollisions   (p, tempUnits    , ppos0, ppos1); tempUnits.clear();
@@ -589,6 +787,42 @@ void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 void CProjectileHandler::CheckGroundCollisions(bool synced)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	// ground heights below each projectile (w), sampled in parallel for the
+	// positions (xyz) they had before the serial pass; a sample is reused as
+	// long as neither the projectile nor the heightmap changed since then
+	static std::vector<float4> groundSamples;
+
+	const auto& pc = projectiles[synced];
+	const size_t numSamples = pc.size();
+	const unsigned int hmRevision = readMap->GetHeightMapRevision();
+
+	groundSamples.resize(numSamples);
+
+	for_mt_chunk(0, numSamples, [&pc](int i) {
+		const CProjectile* p = pc[i];
+
+		if (!p->checkCol) {
+			// never matches a position
+			groundSamples[i] = {float3(std::numeric_limits<float>::quiet_NaN()), 0.0f};
+			return;
+		}
+
+		groundSamples[i] = {p->pos, CGround::GetHeightReal(p->pos.x, p->pos.z)};
+	});
+
+	const auto GetGroundHeight = [&](size_t i, float px, float pz) {
+		if (i >= numSamples || hmRevision != readMap->GetHeightMapRevision())
+			return (CGround::GetHeightReal(px, pz));
+
+		// exact comparison, float3::operator== has a tolerance
+		const float4& sample = groundSamples[i];
+
+		if (sample.x != px || sample.z != pz)
+			return (CGround::GetHeightReal(px, pz));
+
+		return sample.w;
+	};
+
 	//can't use iterators here, because instructions inside the loop modify projectiles[synced]
 	for (size_t i = 0; i < projectiles[synced].size(); ++i) {
 		CProjectile* p = projectiles[synced][i];
@@ -614,7 +848,7 @@ void CProjectileHandler::CheckGroundCollisions(bool synced)
 		const float px = p->pos.x;
 		const float py = p->pos.y;
 		const float pz = p->pos.z;
-		const float gy = CGround::GetHeightReal(px, pz);
+		const float gy = GetGroundHeight(i, px, pz);
 
 		const bool belowGround = (py < gy);
 		const bool insideWater = (py <= CGround::GetWaterLevel(px, pz));
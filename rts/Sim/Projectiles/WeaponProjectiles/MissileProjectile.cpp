@@ -20,6 +20,8 @@
 #include "System/Matrix44f.h"
 #include "System/SpringMath.h"
 
+#include <cstring>
+
 #include "System/Misc/TracyDefs.h"
 
 CR_BIND_DERIVED(CMissileProjectile, CWeaponProjectile, )
@@ -44,7 +46,8 @@ CR_REG_METADATA(CMissileProjectile,(
 	CR_MEMBER(extraHeight),
 	CR_MEMBER(extraHeightDecay),
 	CR_MEMBER(extraHeightTime),
-	CR_IGNORED(smokeTrail)
+	CR_IGNORED(smokeTrail),
+	CR_IGNORED(kinematicsPrediction)
 ))
 
 
@@ -140,82 +143,22 @@ void CMissileProjectile::Update()
 
 	if (--ttl > 0) {
 		if (!luaMoveCtrl) {
-			speed.w += (weaponDef->weaponacceleration * (speed.w < maxSpeed));
-
 			// FIXME: should go before the targeting update?
-			// const float3 orgTargPos = targetPos;
-			// const float3 targetDir = (targetPos - pos).SafeNormalize();
-			const float3& targetVel = UpdateTargeting();
-
-			UpdateWobble();
-			UpdateDance();
-
-			const float3 orgTargPos = targetPos;
-			const float3 targetDir = (targetPos - pos).SafeNormalize();
-			const float targetDist = pos.distance(targetPos) + 0.1f;
-
-			if (extraHeightTime > 0) {
-				extraHeight -= extraHeightDecay;
-				--extraHeightTime;
-
-				targetPos.y += extraHeight;
-
-				if (dir.y <= 0.0f) {
-					// missile has reached apex, smoothly transition
-					// to targetDir (can still overshoot when target
-					// is too close or height difference too large)
-					const float horDiff = (targetPos - pos).Length2D() + 0.01f;
-					const float verDiff = (targetPos.y - pos.y) + 0.01f;
-					const float dirDiff = math::fabs(targetDir.y - dir.y);
-					const float ratio = math::fabs(verDiff / horDiff);
-
-					// tilt missile up if
-					// 1. missile is pointing below target
-					// 2. AND missile height is below target
-					// This compensates for high wobble zero turnrate missiles aiming at high elevations
-					// Prevents these missiles from quickly turing directly downwards if wobble 
-					// causes them to undershoot their elevated target 
-					if (((targetDir.y - dir.y) > 0.0f) && ((targetPos.y - extraHeight - pos.y) > 0.0f)) {
-						dir.y += (dirDiff * ratio);
-					}
-					else {
-						dir.y -= (dirDiff * ratio);
-					}
-
-				} else {
-					// missile is still ascending
-					
-					// tilt missile up if
-					// 1. missile is pointing below target
-					// 2. AND missile height is below target
-					// This compensates for high wobble zero turnrate missiles aiming at high elevations
-					// Lets these missiles continue ascending to an elevated target
-					// even if wobble causes them to temporarily undershoot their elevated target 
-					if ( ((targetDir.y - dir.y) > 0.0f) && ((targetPos.y - extraHeight - pos.y) > 0.0f) ) {
-						dir.y += (extraHeightDecay / targetDist);
-					}
-					else {
-						dir.y -= (extraHeightDecay / targetDist);
-					}
-				}
-			}
+			const float3 targetVel = UpdateTargeting();
 
-			const float3 targetLeadVec = targetVel * (targetDist / maxSpeed) * 0.7f;
-			const float3 targetLeadDir = (targetPos + targetLeadVec - pos).Normalize();
+			// synced RNG draws depend on the update order, keep them here
+			UpdateWobbleAndDanceTimers();
 
-			float3 targetDirDif = targetLeadDir - dir;
+			Kinematics k;
+			GetKinematics(k, targetVel);
 
-			if (targetDirDif.SqLength() < Square(weaponDef->turnrate)) {
-				dir = targetLeadDir;
+			if (kinematicsPrediction != nullptr && std::memcmp(&kinematicsPrediction->input, &k, sizeof(k)) == 0) {
+				k = kinematicsPrediction->output;
 			} else {
-				targetDirDif = (targetDirDif - (dir * (targetDirDif.dot(dir)))).SafeNormalize();
-				dir = (dir + (targetDirDif * weaponDef->turnrate)).SafeNormalize();
+				StepKinematics(k);
 			}
 
-			targetPos = orgTargPos;
-
-			// dir and speed.w have changed, keep speed-vector in sync
-			SetDirectionAndSpeed(dir, speed.w);
+			SetKinematics(k);
 		}
 
 		explGenHandler.GenExplosion(cegID, pos, dir, ttl, damages->damageAreaOfEffect, 0.0f, owner(), nullptr);
@@ -267,7 +210,7 @@ void CMissileProjectile::Update()
 	UpdateGroundBounce();
 }
 
-float3 CMissileProjectile::UpdateTargeting() {
+float3 CMissileProjectile::GetTargetPosAndVel(float3& tgtPos) const {
 	RECOIL_DETAILED_TRACY_ZONE;
 	float3 targetVel;
 
@@ -280,20 +223,20 @@ float3 CMissileProjectile::UpdateTargeting() {
 
 	if (so != nullptr) {
 		// track aim- or error-position for SolidObject's
-		targetPos = so->aimPos;
+		tgtPos = so->aimPos;
 		targetVel = so->speed;
 
 		if (allyteamID != -1 && !ignoreError) {
 			if ((u = dynamic_cast<const CUnit*>(so)) != nullptr)
-				targetPos = u->GetErrorPos(allyteamID, true);
+				tgtPos = u->GetErrorPos(allyteamID, true);
 		}
 
-		targetPos.y = std::max(targetPos.y, targetPos.y * weaponDef->waterweapon);
+		tgtPos.y = std::max(tgtPos.y, tgtPos.y * weaponDef->waterweapon);
 		return targetVel;
 	}
 
 	// track regular target base-position
-	targetPos = target->pos;
+	tgtPos = target->pos;
 
 	if ((po = dynamic_cast<const CWeaponProjectile*>(target)) == nullptr)
 		return targetVel;
@@ -301,37 +244,150 @@ float3 CMissileProjectile::UpdateTargeting() {
 	return po->speed;
 }
 
-void CMissileProjectile::UpdateWobble() {
+void CMissileProjectile::UpdateWobbleAndDanceTimers() {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (!isWobbling)
-		return;
-
-	if ((--wobbleTime) <= 0) {
+	if (isWobbling && (--wobbleTime) <= 0) {
 		wobbleDif = (gsRNG.NextVector() - wobbleDir) * (1.0f / 16);
 		wobbleTime = 16;
 	}
 
-	float wobbleFact = weaponDef->wobble;
+	if (isDancing && (--danceTime) <= 0) {
+		danceMove = gsRNG.NextVector() * weaponDef->dance - danceCenter;
+		danceCenter += danceMove;
+		danceTime = 8;
+	}
+}
+
+
+void CMissileProjectile::GetKinematics(Kinematics& k, const float3& targetVel) const {
+	k.targetVel = targetVel;
+	k.wobbleFact = weaponDef->wobble;
+	k.maxSpeed = maxSpeed;
+	k.extraHeightDecay = extraHeightDecay;
+	k.wobbleDif = wobbleDif;
+	k.danceMove = danceMove;
 
 	if (owner() != nullptr)
-		wobbleFact *= CUnit::ExperienceScale(owner()->limExperience, weaponDef->ownerExpAccWeight);
+		k.wobbleFact *= CUnit::ExperienceScale(owner()->limExperience, weaponDef->ownerExpAccWeight);
+
+	k.pos = pos;
+	k.dir = dir;
+	k.targetPos = targetPos;
+	k.wobbleDir = wobbleDir;
+	k.speed = speed.w;
+	k.extraHeight = extraHeight;
+	k.extraHeightTime = extraHeightTime;
+}
+
+void CMissileProjectile::SetKinematics(const Kinematics& k) {
+	SetPosition(k.pos);
+
+	targetPos = k.targetPos;
+	wobbleDir = k.wobbleDir;
+	extraHeight = k.extraHeight;
+	extraHeightTime = k.extraHeightTime;
 
-	wobbleDir += wobbleDif;
-	dir = (dir + wobbleDir * wobbleFact).Normalize();
+	// dir and speed.w have changed, keep speed-vector in sync
+	SetDirectionAndSpeed(k.dir, k.speed);
 }
 
-void CMissileProjectile::UpdateDance() {
-	RECOIL_DETAILED_TRACY_ZONE;
-	if (!isDancing)
-		return;
+void CMissileProjectile::StepKinematics(Kinematics& k) const {
+	k.speed += (weaponDef->weaponacceleration * (k.speed < k.maxSpeed));
 
-	if ((--danceTime) <= 0) {
-		danceMove = gsRNG.NextVector() * weaponDef->dance - danceCenter;
-		danceCenter += danceMove;
-		danceTime = 8;
+	if (isWobbling) {
+		k.wobbleDir += k.wobbleDif;
+		k.dir = (k.dir + k.wobbleDir * k.wobbleFact).Normalize();
 	}
 
-	SetPosition(pos + danceMove);
+	if (isDancing)
+		k.pos = k.pos + k.danceMove;
+
+	const float3 orgTargPos = k.targetPos;
+	const float3 targetDir = (k.targetPos - k.pos).SafeNormalize();
+	const float targetDist = k.pos.distance(k.targetPos) + 0.1f;
+
+	if (k.extraHeightTime > 0) {
+		k.extraHeight -= k.extraHeightDecay;
+		--k.extraHeightTime;
+
+		k.targetPos.y += k.extraHeight;
+
+		if (k.dir.y <= 0.0f) {
+			// missile has reached apex, smoothly transition
+			// to targetDir (can still overshoot when target
+			// is too close or height difference too large)
+			const float horDiff = (k.targetPos - k.pos).Length2D() + 0.01f;
+			const float verDiff = (k.targetPos.y - k.pos.y) + 0.01f;
+			const float dirDiff = math::fabs(targetDir.y - k.dir.y);
+			const float ratio = math::fabs(verDiff / horDiff);
+
+			// tilt missile up if
+			// 1. missile is pointing below target
+			// 2. AND missile height is below target
+			// This compensates for high wobble zero turnrate missiles aiming at high elevations
+			// Prevents these missiles from quickly turing directly downwards if wobble 
+			// causes them to undershoot their elevated target 
+			if (((targetDir.y - k.dir.y) > 0.0f) && ((k.targetPos.y - k.extraHeight - k.pos.y) > 0.0f)) {
+				k.dir.y += (dirDiff * ratio);
+			}
+			else {
+				k.dir.y -= (dirDiff * ratio);
+			}
+
+		} else {
+			// missile is still ascending
+			
+			// tilt missile up if
+			// 1. missile is pointing below target
+			// 2. AND missile height is below target
+			// This compensates for high wobble zero turnrate missiles aiming at high elevations
+			// Lets these missiles continue ascending to an elevated target
+			// even if wobble causes them to temporarily undershoot their elevated target 
+			if ( ((targetDir.y - k.dir.y) > 0.0f) && ((k.targetPos.y - k.extraHeight - k.pos.y) > 0.0f) ) {
+				k.dir.y += (k.extraHeightDecay / targetDist);
+			}
+			else {
+				k.dir.y -= (k.extraHeightDecay / targetDist);
+			}
+		}
+	}
+
+	const float3 targetLeadVec = k.targetVel * (targetDist / k.maxSpeed) * 0.7f;
+	const float3 targetLeadDir = (k.targetPos + targetLeadVec - k.pos).Normalize();
+
+	float3 targetDirDif = targetLeadDir - k.dir;
+
+	if (targetDirDif.SqLength() < Square(weaponDef->turnrate)) {
+		k.dir = targetLeadDir;
+	} else {
+		targetDirDif = (targetDirDif - (k.dir * (targetDirDif.dot(k.dir)))).SafeNormalize();
+		k.dir = (k.dir + (targetDirDif * weaponDef->turnrate)).SafeNormalize();
+	}
+
+	k.targetPos = orgTargPos;
+}
+
+bool CMissileProjectile::PredictKinematics(KinematicsPrediction& kp) const {
+	// mirrors the steering branch of Update(), which decrements ttl first
+	if (luaMoveCtrl || ttl <= 1)
+		return false;
+
+	// timers that expire this frame draw from the synced RNG
+	if (isWobbling && wobbleTime <= 1)
+		return false;
+	if (isDancing && danceTime <= 1)
+		return false;
+
+	float3 tgtPos = targetPos;
+	const float3 targetVel = GetTargetPosAndVel(tgtPos);
+
+	kp.input = {};
+	GetKinematics(kp.input, targetVel);
+	kp.input.targetPos = tgtPos;
+
+	kp.output = kp.input;
+	StepKinematics(kp.output);
+	return true;
 }
 
 inline float CMissileProjectile::GetSmokeSize() const
@@ -12,6 +12,32 @@ class CSmokeTrailProjectile;
 class CMissileProjectile : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CMissileProjectile)
+public:
+	// per-frame steering state; only 4-byte members so instances can be memcmp'ed
+	struct Kinematics {
+		// inputs
+		float3 targetVel;
+		float wobbleFact = 0.0f;
+		float maxSpeed = 0.0f;
+		float extraHeightDecay = 0.0f;
+		float3 wobbleDif;
+		float3 danceMove;
+
+		// inputs and outputs
+		float3 pos;
+		float3 dir;
+		float3 targetPos;
+		float3 wobbleDir;
+		float speed = 0.0f;
+		float extraHeight = 0.0f;
+		int extraHeightTime = 0;
+	};
+
+	struct KinematicsPrediction {
+		Kinematics input;
+		Kinematics output;
+	};
+
 protected:
 	void UpdateGroundBounce() override;
 public:
@@ -33,10 +59,23 @@ public:
 
 	void SetIgnoreError(bool b) { ignoreError = b; }
 
+	/**
+	 * Computes this frame's steering without modifying the projectile, so it
+	 * can run in parallel ahead of the (serial) synced update. Update() only
+	 * uses the result if its inputs are bit-identical by then. Returns false
+	 * when the frame needs a synced RNG draw or takes no steering step.
+	 */
+	bool PredictKinematics(KinematicsPrediction& kp) const;
+	void SetKinematicsPrediction(const KinematicsPrediction* kp) { kinematicsPrediction = kp; }
+
 private:
-	float3 UpdateTargeting();
-	void UpdateWobble();
-	void UpdateDance();
+	float3 GetTargetPosAndVel(float3& tgtPos) const;
+	float3 UpdateTargeting() { return (GetTargetPosAndVel(targetPos)); }
+	void UpdateWobbleAndDanceTimers();
+
+	void GetKinematics(Kinematics& k, const float3& targetVel) const;
+	void SetKinematics(const Kinematics& k);
+	void StepKinematics(Kinematics& k) const;
 
 	bool ignoreError;
 
@@ -62,6 +101,8 @@ private:
 	float3 oldSmoke;
 	float3 oldDir;
 	CSmokeTrailProjectile* smokeTrail;
+
+	const KinematicsPrediction* kinematicsPrediction = nullptr;
 private:
 	inline float GetSmokeSize() const;
 	inline float GetSmokeColor() const;
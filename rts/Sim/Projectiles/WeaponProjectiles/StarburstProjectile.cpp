@@ -19,6 +19,8 @@
 #include "System/Matrix44f.h"
 #include "System/SpringMath.h"
 
+#include <cstring>
+
 #include "System/Misc/TracyDefs.h"
 
 
@@ -55,7 +57,8 @@ CR_REG_METADATA(CStarburstProjectile, (
 	CR_MEMBER(turnToTarget),
 
 	CR_MEMBER(tracerParts),
-	CR_MEMBER(smokeTrail)
+	CR_MEMBER(smokeTrail),
+	CR_IGNORED(kinematicsPrediction)
 ))
 
 
@@ -143,8 +146,16 @@ void CStarburstProjectile::Update()
 	UpdateTargeting();
 
 	if (!luaMoveCtrl) {
-		UpdateTrajectory();
-		SetPosition(pos + speed);
+		Kinematics k;
+		GetKinematics(k);
+
+		if (kinematicsPrediction != nullptr && std::memcmp(&kinematicsPrediction->input, &k, sizeof(k)) == 0) {
+			k = kinematicsPrediction->output;
+		} else {
+			StepKinematics(k);
+		}
+
+		SetKinematics(k);
 	}
 
 	if (ttl > 0)
@@ -155,7 +166,7 @@ void CStarburstProjectile::Update()
 	UpdateInterception();
 }
 
-void CStarburstProjectile::UpdateTargeting()
+void CStarburstProjectile::GetTargetPos(float3& tgtPos) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (target == nullptr)
@@ -168,83 +179,126 @@ void CStarburstProjectile::UpdateTargeting()
 	const CUnit* u = nullptr;
 
 	if (so == nullptr) {
-		targetPos = target->pos + aimError;
+		tgtPos = target->pos + aimError;
 		return;
 	}
 
 	if (!ignoreError && allyteamID != -1 && (u = dynamic_cast<const CUnit*>(so)) != nullptr)
-		targetPos = u->GetErrorPos(allyteamID, true);
+		tgtPos = u->GetErrorPos(allyteamID, true);
 	else
-		targetPos = so->aimPos;
+		tgtPos = so->aimPos;
 
-	targetPos.y = std::max(targetPos.y, targetPos.y * weaponDef->waterweapon);
-	targetPos += aimError;
+	tgtPos.y = std::max(tgtPos.y, tgtPos.y * weaponDef->waterweapon);
+	tgtPos += aimError;
 }
 
-void CStarburstProjectile::UpdateTrajectory()
+
+void CStarburstProjectile::GetKinematics(Kinematics& k) const
 {
-	RECOIL_DETAILED_TRACY_ZONE;
-	if (uptime > 0) {
-		// stage 1: going upwards
-		speed.w += weaponDef->weaponacceleration;
-		speed.w = std::min(speed.w, maxSpeed);
-		CWorldObject::SetVelocity(dir * speed.w); // do not need to update dir or speed.w here
-		return;
-	}
+	k.targetPos = targetPos;
+	k.maxSpeed = maxSpeed;
+	k.maxGoodDif = maxGoodDif;
+	k.tracking = tracking;
+	k.gravity = mygravity;
+	k.ttl = ttl;
+	k.uptime = uptime;
+
+	k.pos = pos;
+	k.dir = dir;
+	k.velocity = speed;
+	k.speed = speed.w;
+	k.distanceToTravel = distanceToTravel;
+	k.turnToTarget = turnToTarget;
+}
+
+void CStarburstProjectile::SetKinematics(const Kinematics& k)
+{
+	dir = k.dir;
+	distanceToTravel = k.distanceToTravel;
+	turnToTarget = k.turnToTarget;
+
+	// do not assume f4::op=(f3) will not touch .w
+	CWorldObject::SetVelocity(k.velocity);
+	speed.w = k.speed;
+
+	SetPosition(k.pos);
+}
 
-	if (turnToTarget && ttl > 0 && distanceToTravel > 0.0f) {
+void CStarburstProjectile::StepKinematics(Kinematics& k) const
+{
+	if (k.uptime > 0) {
+		// stage 1: going upwards
+		k.speed += weaponDef->weaponacceleration;
+		k.speed = std::min(k.speed, k.maxSpeed);
+		k.velocity = k.dir * k.speed;
+	} else if (k.turnToTarget && k.ttl > 0 && k.distanceToTravel > 0.0f) {
 		// stage 2: turn to target
-		float3 targetErrorVec = (targetPos - pos).Normalize();
+		float3 targetErrorVec = (k.targetPos - k.pos).Normalize();
 
-		if (targetErrorVec.dot(dir) > 0.99f) {
-			dir = targetErrorVec;
-			turnToTarget = false;
+		if (targetErrorVec.dot(k.dir) > 0.99f) {
+			k.dir = targetErrorVec;
+			k.turnToTarget = false;
 		} else {
-			targetErrorVec = targetErrorVec - dir;
-			targetErrorVec = (targetErrorVec - (dir * (targetErrorVec.dot(dir)))).SafeNormalize();
+			targetErrorVec = targetErrorVec - k.dir;
+			targetErrorVec = (targetErrorVec - (k.dir * (targetErrorVec.dot(k.dir)))).SafeNormalize();
 
 			if (weaponDef->turnrate != 0) {
-				dir = (dir + (targetErrorVec * weaponDef->turnrate)).Normalize();
+				k.dir = (k.dir + (targetErrorVec * weaponDef->turnrate)).Normalize();
 			} else {
-				dir = (dir + (targetErrorVec * 0.06f)).Normalize();
+				k.dir = (k.dir + (targetErrorVec * 0.06f)).Normalize();
 			}
 		}
 
-		// do not need to update dir or speed.w here
-		CWorldObject::SetVelocity(dir * speed.w);
-
-		if (distanceToTravel != MAX_PROJECTILE_RANGE)
-			distanceToTravel -= speed.Length2D();
-
-		return;
-	}
+		k.velocity = k.dir * k.speed;
 
-	if (ttl > 0 && distanceToTravel > 0.0f) {
+		if (k.distanceToTravel != MAX_PROJECTILE_RANGE)
+			k.distanceToTravel -= k.velocity.Length2D();
+	} else if (k.ttl > 0 && k.distanceToTravel > 0.0f) {
 		// stage 3: hit target
-		float3 targetErrorVec = (targetPos - pos).Normalize();
+		float3 targetErrorVec = (k.targetPos - k.pos).Normalize();
 
-		if (targetErrorVec.dot(dir) > maxGoodDif) {
-			dir = targetErrorVec;
+		if (targetErrorVec.dot(k.dir) > k.maxGoodDif) {
+			k.dir = targetErrorVec;
 		} else {
-			targetErrorVec = targetErrorVec - dir;
-			targetErrorVec = (targetErrorVec - (dir * (targetErrorVec.dot(dir)))).SafeNormalize();
+			targetErrorVec = targetErrorVec - k.dir;
+			targetErrorVec = (targetErrorVec - (k.dir * (targetErrorVec.dot(k.dir)))).SafeNormalize();
 
-			dir = (dir + (targetErrorVec * tracking)).SafeNormalize();
+			k.dir = (k.dir + (targetErrorVec * k.tracking)).SafeNormalize();
 		}
 
-		speed.w += weaponDef->weaponacceleration;
-		speed.w = std::min(speed.w, maxSpeed);
-		CWorldObject::SetVelocity(dir * speed.w);
+		k.speed += weaponDef->weaponacceleration;
+		k.speed = std::min(k.speed, k.maxSpeed);
+		k.velocity = k.dir * k.speed;
 
-		if (distanceToTravel != MAX_PROJECTILE_RANGE)
-			distanceToTravel -= speed.Length2D();
-
-		return;
+		if (k.distanceToTravel != MAX_PROJECTILE_RANGE)
+			k.distanceToTravel -= k.velocity.Length2D();
+	} else {
+		// stage "out of fuel"
+		// changes dir and speed, must keep velocity in sync
+		k.dir = (k.dir + (UpVector * k.gravity)).Normalize();
+		k.speed = k.speed - k.gravity;
+		k.velocity = k.dir * k.speed;
 	}
 
-	// stage "out of fuel"
-	// changes dir and speed.w, must keep speed-vector in sync
-	SetDirectionAndSpeed((dir + (UpVector * mygravity)).Normalize(), speed.w - mygravity);
+	k.pos = k.pos + k.velocity;
+}
+
+bool CStarburstProjectile::PredictKinematics(KinematicsPrediction& kp) const
+{
+	if (luaMoveCtrl)
+		return false;
+
+	// mirrors Update(), which decrements the timers before targeting
+	kp.input = {};
+	GetKinematics(kp.input);
+	GetTargetPos(kp.input.targetPos);
+
+	kp.input.ttl -= 1;
+	kp.input.uptime -= 1;
+
+	kp.output = kp.input;
+	StepKinematics(kp.output);
+	return true;
 }
 
 
@@ -13,6 +13,32 @@ class CStarburstProjectile : public CWeaponProjectile
 	CR_DECLARE_DERIVED(CStarburstProjectile)
 	CR_DECLARE_SUB(TracerPart)
 
+public:
+	// per-frame trajectory state; only 4-byte members so instances can be memcmp'ed
+	struct Kinematics {
+		// inputs
+		float3 targetPos;
+		float maxSpeed = 0.0f;
+		float maxGoodDif = 0.0f;
+		float tracking = 0.0f;
+		float gravity = 0.0f;
+		int ttl = 0;
+		int uptime = 0;
+
+		// inputs and outputs
+		float3 pos;
+		float3 dir;
+		float3 velocity;
+		float speed = 0.0f;
+		float distanceToTravel = 0.0f;
+		int turnToTarget = 0;
+	};
+
+	struct KinematicsPrediction {
+		Kinematics input;
+		Kinematics output;
+	};
+
 public:
 	// creg only
 	CStarburstProjectile() { }
@@ -30,9 +56,21 @@ public:
 	int ShieldRepulse(const float3& shieldPos, float shieldForce, float shieldMaxSpeed) override;
 
 	void SetIgnoreError(bool b) { ignoreError = b; }
+
+	/**
+	 * Computes this frame's trajectory step without modifying the projectile
+	 * (see CMissileProjectile::PredictKinematics); Update() only uses it if
+	 * the inputs are bit-identical by then.
+	 */
+	bool PredictKinematics(KinematicsPrediction& kp) const;
+	void SetKinematicsPrediction(const KinematicsPrediction* kp) { kinematicsPrediction = kp; }
 private:
-	void UpdateTargeting();
-	void UpdateTrajectory();
+	void GetTargetPos(float3& tgtPos) const;
+	void UpdateTargeting() { GetTargetPos(targetPos); }
+
+	void GetKinematics(Kinematics& k) const;
+	void SetKinematics(const Kinematics& k);
+	void StepKinematics(Kinematics& k) const;
 
 	void InitTracerParts();
 	void UpdateTracerPart();
@@ -82,6 +120,8 @@ private:
 
 	TracerPart tracerParts[NUM_TRACER_PARTS];
 	CSmokeTrailProjectile* smokeTrail = nullptr;
+
+	const KinematicsPrediction* kinematicsPrediction = nullptr;
 };
 
 #endif /* STARBURST_PROJECTILE_H */
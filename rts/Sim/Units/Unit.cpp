@@ -869,6 +869,10 @@ void CUnit::SetLosStatus(int at, unsigned short newStatus)
 	// without first clearing the IN{LOS, RADAR} bit
 	losStatus[at] |= newStatus;
 
+	// weapons of <at> only consider units in its LOS or radar
+	if (diffBits & (LOS_INLOS | LOS_INRADAR))
+		helper->InvalidateTargetCandidates(this, at);
+
 	if (diffBits) {
 		if (diffBits & LOS_INLOS) {
 			if (newStatus & LOS_INLOS) {
@@ -902,7 +906,7 @@ void CUnit::SetLosStatus(int at, unsigned short newStatus)
 }
 
 
-unsigned short CUnit::CalcLosStatus(int at)
+unsigned short CUnit::CalcLosStatus(int at) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const unsigned short currStatus = losStatus[at];
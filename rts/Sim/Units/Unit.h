@@ -188,7 +188,7 @@ public:
 	bool IsInLosForAllyTeam(int allyTeam) const { return ((losStatus[allyTeam] & LOS_INLOS) != 0); }
 
 	void SetLosStatus(int allyTeam, unsigned short newStatus);
-	unsigned short CalcLosStatus(int allyTeam);
+	unsigned short CalcLosStatus(int allyTeam) const;
 	void UpdateLosStatus(int allyTeam);
 
 	void UpdateWeapons();
@@ -860,6 +860,8 @@ void UnitDef::CreateYardMap(std::string&& yardMapStr)
 			yardmap[bmx + bmz * xsize] = defYardMap[ymx + ymz * hxSize];
 		}
 	}
+
+	yardMapMasks.Init(yardmap.data(), int2(xsize, zsize));
 }
 
 
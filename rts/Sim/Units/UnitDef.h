@@ -10,6 +10,7 @@
 #include "Sim/Misc/GuiSoundSet.h"
 #include "Sim/Objects/SolidObject.h"
 #include "Sim/Objects/SolidObjectDef.h"
+#include "Sim/Objects/YardMapMasks.h"
 #include "System/float3.h"
 #include "System/UnorderedMap.hpp"
 
@@ -101,6 +102,7 @@ public:
 
 	const UnitDefWeapon& GetWeapon(unsigned int idx) const { return weapons[idx]; }
 	const YardMapStatus* GetYardMapPtr() const { return (yardmap.data()); }
+	const CYardMapMasks* GetYardMapMasksPtr() const { return (yardmap.empty()? nullptr: &yardMapMasks); }
 
 
 	void AddModelExpGenID(unsigned int egID) { modelExplGenIDs[1 + modelExplGenIDs[0]] = egID; modelExplGenIDs[0] += (egID != -1u); }
@@ -237,6 +239,8 @@ public:
 	///< The unrotated yardmap for buildings
 	///< (only non-mobile ground units can have these)
 	std::vector<YardMapStatus> yardmap;
+	///< yardmap precompiled per facing, valid if yardmap is not empty
+	CYardMapMasks yardMapMasks;
 
 	///< buildingMask used to disallow construction on certain map squares
 	std::uint16_t buildingMask;
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 
 #include "UnitHandler.h"
@@ -13,6 +14,7 @@
 #include "CommandAI/BuilderCAI.h"
 #include "Sim/Ecs/Registry.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
@@ -338,12 +340,135 @@ void CUnitHandler::UpdateUnitMoveTypes()
 	UnitTrapCheckSystem::Update();
 }
 
+// everything CUnit::CalcLosStatus reads from the unit besides its losStatus;
+// the LOS maps themselves only change in CLosHandler::Update
+namespace {
+struct UnitLosInputs {
+	UnitLosInputs() = default;
+	UnitLosInputs(const CUnit* unit)
+		: pos(unit->pos)
+		, speed(unit->speed)
+		, physicalState(unit->physicalState)
+		, allyteam(unit->allyteam)
+		, isCloaked(unit->isCloaked)
+		, alwaysVisible(unit->alwaysVisible)
+		, useAirLos(unit->useAirLos)
+		, stealth(unit->stealth)
+		, sonarStealth(unit->sonarStealth)
+		, beingBuilt(unit->beingBuilt)
+	{}
+
+	bool operator == (const UnitLosInputs& i) const {
+		return (pos == i.pos && speed == i.speed && physicalState == i.physicalState && allyteam == i.allyteam &&
+		        isCloaked == i.isCloaked && alwaysVisible == i.alwaysVisible && useAirLos == i.useAirLos &&
+		        stealth == i.stealth && sonarStealth == i.sonarStealth && beingBuilt == i.beingBuilt);
+	}
+
+	float3 pos;
+	float3 speed;
+
+	unsigned int physicalState = 0;
+	int allyteam = 0;
+
+	bool isCloaked = false;
+	bool alwaysVisible = false;
+	bool useAirLos = false;
+	bool stealth = false;
+	bool sonarStealth = false;
+	bool beingBuilt = false;
+};
+}
+
 void CUnitHandler::UpdateUnitLosStates()
 {
 	ZoneScopedC(tracy::Color::Goldenrod);
-	for (CUnit* unit: activeUnits) {
-		for (int at = 0; at < teamHandler.ActiveAllyTeams(); ++at) {
-			unit->UpdateLosStatus(at);
+
+	// statuses of all units are calculated in parallel, the serial pass then
+	// only has to apply the transitions; the Entered/Left callins can change
+	// anything, so once one has run a prediction is only used if the unit's
+	// inputs, its status and the allyteam's global LOS are still the same
+	constexpr size_t MIN_LOS_PREDICTION_UNITS = 128;
+
+	static std::vector<UnitLosInputs> predictedInputs;
+	static std::vector<unsigned short> predictedFrom;
+	static std::vector<unsigned short> predictedStatus;
+	static std::vector<bool> predictedGlobalLOS;
+
+	// units created by callins are not visited until the next frame
+	const size_t numUnits = activeUnits.size();
+	const int numAllyTeams = teamHandler.ActiveAllyTeams();
+
+	// not worth dispatching to the pool
+	if (numUnits < MIN_LOS_PREDICTION_UNITS) {
+		for (size_t i = 0; i < numUnits; i++) {
+			for (int at = 0; at < numAllyTeams; ++at) {
+				activeUnits[i]->UpdateLosStatus(at);
+			}
+		}
+
+		return;
+	}
+
+	predictedInputs.resize(numUnits);
+	predictedFrom.resize(numUnits * numAllyTeams);
+	predictedStatus.resize(numUnits * numAllyTeams);
+	predictedGlobalLOS.resize(numAllyTeams);
+
+	for (int at = 0; at < numAllyTeams; ++at) {
+		predictedGlobalLOS[at] = losHandler->GetGlobalLOS(at);
+	}
+
+	for_mt(0, numUnits, [&](const int i) {
+		const CUnit* unit = activeUnits[i];
+
+		predictedInputs[i] = UnitLosInputs(unit);
+
+		for (int at = 0; at < numAllyTeams; ++at) {
+			const unsigned short status = unit->losStatus[at];
+
+			predictedFrom[i * numAllyTeams + at] = status;
+
+			// fully masked statuses never change, see CUnit::UpdateLosStatus
+			if ((status & LOS_ALL_MASK_BITS) == LOS_ALL_MASK_BITS) {
+				predictedStatus[i * numAllyTeams + at] = status;
+				continue;
+			}
+
+			predictedStatus[i * numAllyTeams + at] = unit->CalcLosStatus(at);
+		}
+	});
+
+	bool ranCallins = false;
+
+	for (size_t i = 0; i < numUnits; i++) {
+		CUnit* unit = activeUnits[i];
+
+		for (int at = 0; at < numAllyTeams; ++at) {
+			const unsigned short currStatus = unit->losStatus[at];
+
+			// recalculate only what the callins have changed
+			if (ranCallins) {
+				bool changed = false;
+
+				changed |= (currStatus != predictedFrom[i * numAllyTeams + at]);
+				changed |= (losHandler->GetGlobalLOS(at) != predictedGlobalLOS[at]);
+				changed |= (UnitLosInputs(unit) != predictedInputs[i]);
+
+				if (changed) {
+					unit->UpdateLosStatus(at);
+					continue;
+				}
+			}
+
+			const unsigned short newStatus = predictedStatus[i * numAllyTeams + at];
+
+			// SetLosStatus would be a no-op
+			if (newStatus == currStatus)
+				continue;
+
+			unit->SetLosStatus(at, newStatus);
+
+			ranCallins |= (((currStatus ^ newStatus) & (LOS_INLOS | LOS_INRADAR)) != 0);
 		}
 	}
 }
@@ -476,10 +601,22 @@ void CUnitHandler::UpdatePostAnimation()
 	SCOPED_TIMER("Sim::Unit::UpdatePostAnimation");
 	inUpdateCall = true;
 
+	static std::vector<CUnit*> updatePieceBVHList;
+	updatePieceBVHList.clear();
+
 	for (auto* unit : activeUnits) {
 		unit->UpdateTransportees();
+
+		if (unit->localModel.GetPieceBVHNeedsRefit())
+			updatePieceBVHList.emplace_back(unit);
 	}
 
+	// refit after the animations of this frame, hit-tests until the next refit
+	// fall back to testing every piece of models whose pieces moved meanwhile
+	for_mt(0, updatePieceBVHList.size(), [](int i) {
+		updatePieceBVHList[i]->localModel.UpdatePieceBVH();
+	});
+
 	inUpdateCall = false;
 }
 
@@ -15,6 +15,7 @@
 CR_BIND_DERIVED(CBuilding, CUnit, )
 CR_REG_METADATA(CBuilding, (
 	CR_IGNORED(blockMap), // reloaded in PostLoad
+	CR_IGNORED(yardMapMasks), // reloaded in PostLoad
 	CR_POSTLOAD(PostLoad)
 ))
 
@@ -23,6 +24,7 @@ void CBuilding::PostLoad()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	blockMap = unitDef->GetYardMapPtr();
+	yardMapMasks = unitDef->GetYardMapMasksPtr();
 }
 
 
@@ -31,6 +33,7 @@ void CBuilding::PreInit(const UnitLoadParams& params)
 	RECOIL_DETAILED_TRACY_ZONE;
 	unitDef = params.unitDef;
 	blockMap = unitDef->GetYardMapPtr(); // null if empty
+	yardMapMasks = unitDef->GetYardMapMasksPtr();
 	blockHeightChanges = unitDef->levelGround;
 
 	CUnit::PreInit(params);
@@ -22,11 +22,14 @@ public:
 	void ForcedMove(const float3& newPos) override;
 
 	const YardMapStatus* GetBlockMap() const override { return blockMap; }
+	const CYardMapMasks* GetYardMapMasks() const override { return yardMapMasks; }
 
 protected:
 	// current unrotated blockmap/yardmap of this object;
 	// null means no active yardmap (all squares blocked)
 	const YardMapStatus* blockMap = nullptr;
+	// precompiled form of blockMap, null along with it
+	const CYardMapMasks* yardMapMasks = nullptr;
 };
 
 #endif // _BUILDING_H
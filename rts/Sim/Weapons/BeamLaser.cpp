@@ -306,6 +306,7 @@ void CBeamLaser::FireInternal(float3 curDir)
 	CFeature* hitFeature = nullptr;
 	CPlasmaRepulser* hitShield = nullptr;
 	static std::vector<TraceRay::SShieldDist> hitShields;
+	static TraceRay::SBeamCandidates beamCandidates;
 	CollisionQuery hitColQuery;
 
 	if (!sweepFireState.IsSweepFiring()) {
@@ -330,7 +331,10 @@ void CBeamLaser::FireInternal(float3 curDir)
 	}
 
 	for (int tries = 0; tries < 5 && tryAgain; ++tries) {
-		float beamLength = TraceRay::TraceRay(curPos, curDir, maxLength - curLength, collisionFlags, owner, hitUnit, hitFeature, &hitColQuery);
+		// one quadfield traversal serves both the object and the shield trace
+		TraceRay::GetBeamCandidates(curPos, curDir, maxLength - curLength, beamCandidates);
+
+		float beamLength = TraceRay::TraceBeam(beamCandidates, curPos, curDir, maxLength - curLength, collisionFlags, owner, hitUnit, hitFeature, &hitColQuery);
 
 		if (hitUnit != nullptr && teamHandler.AlliedTeams(hitUnit->team, owner->team)) {
 			if (sweepFireState.IsSweepFiring() && !sweepFireState.DamageAllies()) {
@@ -353,7 +357,7 @@ void CBeamLaser::FireInternal(float3 curDir)
 		// we do more than one trace-iteration and set dir to
 		// newDir only in the case there is a shield in our way
 		hitShields.clear();
-		TraceRay::TraceRayShields(this, curPos, curDir, beamLength, hitShields);
+		TraceRay::TraceBeamShields(beamCandidates, this, curPos, curDir, beamLength, hitShields);
 
 		for (const TraceRay::SShieldDist& sd: hitShields) {
 			if (sd.dist < beamLength && sd.rep->IncomingBeam(this, curPos, curPos + (curDir * sd.dist), salvoDamageMult)) {
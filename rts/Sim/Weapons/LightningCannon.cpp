@@ -41,7 +41,11 @@ void CLightningCannon::FireImpl(const bool scriptCall)
 	CFeature* hitFeature = nullptr;
 	CollisionQuery hitColQuery;
 
-	float boltLength = TraceRay::TraceRay(curPos, curDir, range, collisionFlags, owner, hitUnit, hitFeature, &hitColQuery);
+	// one quadfield traversal serves both the object and the shield trace
+	static TraceRay::SBeamCandidates boltCandidates;
+	TraceRay::GetBeamCandidates(curPos, curDir, range, boltCandidates);
+
+	float boltLength = TraceRay::TraceBeam(boltCandidates, curPos, curDir, range, collisionFlags, owner, hitUnit, hitFeature, &hitColQuery);
 
 	if (!weaponDef->waterweapon) {
 		// terminate bolt at water surface if necessary
@@ -54,7 +58,7 @@ void CLightningCannon::FireImpl(const bool scriptCall)
 
 	static std::vector<TraceRay::SShieldDist> hitShields;
 	hitShields.clear();
-	TraceRay::TraceRayShields(this, curPos, curDir, range, hitShields);
+	TraceRay::TraceBeamShields(boltCandidates, this, curPos, curDir, range, hitShields);
 	for (const TraceRay::SShieldDist& sd: hitShields) {
 		if (sd.dist < boltLength && sd.rep->IncomingBeam(this, curPos, curPos + (curDir * sd.dist), 1.0f)) {
 			boltLength = sd.dist;
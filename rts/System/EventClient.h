@@ -48,6 +48,15 @@ enum DbgTimingInfoType {
 	TIMING_UNSYNCED
 };
 
+/// one unit event, as delivered by the batched (*Batch) call-ins once per sim-frame
+struct SUnitEvent {
+	int unitID;
+	int unitDefID;
+	int unitTeam;
+	/// allyteam whose LOS or radar changed, the unit's own allyteam for UnitMovedBatch
+	int allyTeam;
+};
+
 
 class CEventClient
 {
@@ -154,6 +163,17 @@ class CEventClient
 		virtual void UnitLeftRadar(const CUnit* unit, int allyTeam) {}
 		virtual void UnitLeftLos(const CUnit* unit, int allyTeam) {}
 
+		/**
+		 * batched variants of the above and of UnitMoved, receiving all events of
+		 * a sim-frame (which the client can read) with a single call; the units
+		 * might have died since
+		 */
+		virtual void UnitEnteredRadarBatch(const std::vector<SUnitEvent>& events) {}
+		virtual void UnitEnteredLosBatch(const std::vector<SUnitEvent>& events) {}
+		virtual void UnitLeftRadarBatch(const std::vector<SUnitEvent>& events) {}
+		virtual void UnitLeftLosBatch(const std::vector<SUnitEvent>& events) {}
+		virtual void UnitMovedBatch(const std::vector<SUnitEvent>& events) {}
+
 		virtual void UnitEnteredUnderwater(const CUnit* unit) {}
 		virtual void UnitEnteredWater(const CUnit* unit) {}
 		virtual void UnitEnteredAir(const CUnit* unit) {}
@@ -4,6 +4,7 @@
 
 #include "Lua/LuaCallInCheck.h"
 #include "Lua/LuaOpenGL.h"  // FIXME -- should be moved
+#include "Sim/Units/UnitDef.h"
 
 #include "System/Config/ConfigHandler.h"
 #include "System/Platform/Threading.h"
@@ -35,6 +36,12 @@ void CEventHandler::ResetState()
 {
 	mouseOwner = nullptr;
 
+	unitEnteredRadarEvents.clear();
+	unitEnteredLosEvents.clear();
+	unitLeftRadarEvents.clear();
+	unitLeftLosEvents.clear();
+	unitMovedEvents.clear();
+
 	eventMap.clear();
 	eventMap.reserve(64);
 	handles.clear();
@@ -207,6 +214,57 @@ void CEventHandler::ListRemove(EventClientList& ecList, CEventClient* ec)
 }
 
 
+/******************************************************************************/
+/******************************************************************************/
+
+void CEventHandler::QueueUnitEvent(std::vector<SUnitEvent>& events, const CUnit* unit, int allyTeam)
+{
+	events.push_back({unit->id, unit->unitDef->id, unit->team, allyTeam});
+}
+
+void CEventHandler::FlushUnitEvents(
+	EventClientList& ecList,
+	std::vector<SUnitEvent>& events,
+	void (CEventClient::*callIn)(const std::vector<SUnitEvent>&)
+) {
+	if (events.empty())
+		return;
+
+	for (size_t i = 0; i < ecList.size(); ) {
+		CEventClient* ec = ecList[i];
+
+		if (ec->GetFullRead()) {
+			(ec->*callIn)(events);
+		} else {
+			readableUnitEvents.clear();
+
+			for (const SUnitEvent& e: events) {
+				if (ec->CanReadAllyTeam(e.allyTeam))
+					readableUnitEvents.push_back(e);
+			}
+
+			if (!readableUnitEvents.empty())
+				(ec->*callIn)(readableUnitEvents);
+		}
+
+		// the call-in may remove itself from the list
+		i += (i < ecList.size() && ec == ecList[i]);
+	}
+
+	events.clear();
+}
+
+void CEventHandler::FlushBatchedEvents()
+{
+	ZoneScoped;
+	FlushUnitEvents(listUnitEnteredRadarBatch, unitEnteredRadarEvents, &CEventClient::UnitEnteredRadarBatch);
+	FlushUnitEvents(listUnitEnteredLosBatch, unitEnteredLosEvents, &CEventClient::UnitEnteredLosBatch);
+	FlushUnitEvents(listUnitLeftRadarBatch, unitLeftRadarEvents, &CEventClient::UnitLeftRadarBatch);
+	FlushUnitEvents(listUnitLeftLosBatch, unitLeftLosEvents, &CEventClient::UnitLeftLosBatch);
+	FlushUnitEvents(listUnitMovedBatch, unitMovedEvents, &CEventClient::UnitMovedBatch);
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 
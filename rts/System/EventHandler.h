@@ -217,6 +217,9 @@ class CEventHandler
 		void Save(zipFile archive);
 
 		void UnsyncedHeightMapUpdate(const SRectangle& rect);
+
+		/// delivers the events queued for the batched call-ins since the last flush
+		void FlushBatchedEvents();
 		void Update();
 
 		bool KeyMapChanged();
@@ -351,6 +354,13 @@ class CEventHandler
 		void ListInsert(EventClientList& ciList, CEventClient* ec);
 		void ListRemove(EventClientList& ciList, CEventClient* ec);
 
+		void QueueUnitEvent(std::vector<SUnitEvent>& events, const CUnit* unit, int allyTeam);
+		void FlushUnitEvents(
+			EventClientList& ecList,
+			std::vector<SUnitEvent>& events,
+			void (CEventClient::*callIn)(const std::vector<SUnitEvent>&)
+		);
+
 	private:
 		CEventClient* mouseOwner;
 
@@ -359,6 +369,15 @@ class CEventHandler
 
 		EventClientList handles;
 
+		// events since the last FlushBatchedEvents, only queued while the batched call-in has clients
+		std::vector<SUnitEvent> unitEnteredRadarEvents;
+		std::vector<SUnitEvent> unitEnteredLosEvents;
+		std::vector<SUnitEvent> unitLeftRadarEvents;
+		std::vector<SUnitEvent> unitLeftLosEvents;
+		std::vector<SUnitEvent> unitMovedEvents;
+		// subset of the above readable by a client without full read access
+		std::vector<SUnitEvent> readableUnitEvents;
+
 	#define SETUP_EVENT(name, props) EventClientList list ## name;
 	#define SETUP_UNMANAGED_EVENT(name, props)
 		#include "Events.def"
@@ -444,7 +463,23 @@ UNIT_CALLIN_NO_PARAM(UnitEnteredAir)
 UNIT_CALLIN_NO_PARAM(UnitLeftUnderwater)
 UNIT_CALLIN_NO_PARAM(UnitLeftWater)
 UNIT_CALLIN_NO_PARAM(UnitLeftAir)
-UNIT_CALLIN_NO_PARAM(UnitMoved)
+
+inline void CEventHandler::UnitMoved(const CUnit* unit)
+{
+	const auto unitAllyTeam = unit->allyteam;
+
+	for (size_t i = 0; i < listUnitMoved.size(); ) {
+		CEventClient* ec = listUnitMoved[i];
+
+		if (ec->CanReadAllyTeam(unitAllyTeam))
+			ec->UnitMoved(unit);
+
+		i += (i < listUnitMoved.size() && ec == listUnitMoved[i]);
+	}
+
+	if (!listUnitMovedBatch.empty())
+		QueueUnitEvent(unitMovedEvents, unit, unitAllyTeam);
+}
 
 #define UNIT_CALLIN_INT_PARAMS(name)                                              \
 	inline void CEventHandler:: Unit ## name (const CUnit* unit, int p1, int p2)  \
@@ -456,16 +491,19 @@ UNIT_CALLIN_INT_PARAMS(Taken)
 UNIT_CALLIN_INT_PARAMS(Given)
 
 
-#define UNIT_CALLIN_LOS_PARAM(name)                                        \
+#define UNIT_CALLIN_LOS_PARAM(name, events)                                \
 	inline void CEventHandler:: Unit ## name (const CUnit* unit, int at)   \
 	{                                                                      \
 		ITERATE_ALLYTEAM_EVENTCLIENTLIST(Unit ## name, at, unit, at)       \
+                                                                           \
+		if (!listUnit ## name ## Batch.empty())                            \
+			QueueUnitEvent(events, unit, at);                              \
 	}
 
-UNIT_CALLIN_LOS_PARAM(EnteredRadar)
-UNIT_CALLIN_LOS_PARAM(EnteredLos)
-UNIT_CALLIN_LOS_PARAM(LeftRadar)
-UNIT_CALLIN_LOS_PARAM(LeftLos)
+UNIT_CALLIN_LOS_PARAM(EnteredRadar, unitEnteredRadarEvents)
+UNIT_CALLIN_LOS_PARAM(EnteredLos, unitEnteredLosEvents)
+UNIT_CALLIN_LOS_PARAM(LeftRadar, unitLeftRadarEvents)
+UNIT_CALLIN_LOS_PARAM(LeftLos, unitLeftLosEvents)
 
 
 inline void CEventHandler::UnitConstructionDecayed(const CUnit* unit,
@@ -16,7 +16,7 @@
 #include "System/SpringFormat.h"
 #include "System/SafeUtil.h"
 
-#ifndef UNIT_TEST
+#if !defined(UNIT_TEST) && !defined(TOOLS)
 CONFIG(bool, UDPConnectionLogDebugMessages).defaultValue(false);
 #endif
 
@@ -314,7 +314,7 @@ void UDPConnection::Init()
 	closed = false;
 	resend = false;
 
-	#ifndef UNIT_TEST
+	#if !defined(UNIT_TEST) && !defined(TOOLS)
 	logMessages = configHandler->GetBool("UDPConnectionLogDebugMessages");
 	#endif
 
@@ -123,6 +123,9 @@ public:
 
 	int GetReconnectSecs() const { return reconnectTime; }
 
+	unsigned int GetNumResentChunks() const { return resentChunks; }
+	unsigned int GetNumDroppedChunks() const { return droppedChunks; }
+
 	/// Are we using this address?
 	bool IsUsingAddress(const asio::ip::udp::endpoint& from) const { return (addr == from); }
 	bool UseMinLossFactor() const { return (netLossFactor == MIN_LOSS_FACTOR); }
@@ -0,0 +1,126 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+CMappedFile& CMappedFile::operator = (CMappedFile&& f) noexcept
+{
+	if (this == &f)
+		return *this;
+
+	Close();
+
+	data = std::exchange(f.data, nullptr);
+	size = std::exchange(f.size, 0);
+
+#ifdef _WIN32
+	fileHandle = std::exchange(f.fileHandle, nullptr);
+	mappingHandle = std::exchange(f.mappingHandle, nullptr);
+#else
+	fileDesc = std::exchange(f.fileDesc, -1);
+#endif
+
+	return *this;
+}
+
+
+bool CMappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(hFile);
+		return false;
+	}
+
+	HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (hMapping == nullptr) {
+		CloseHandle(hFile);
+		return false;
+	}
+
+	void* view = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (view == nullptr) {
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+
+	fileHandle = hFile;
+	mappingHandle = hMapping;
+	data = reinterpret_cast<const std::uint8_t*>(view);
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	const int fd = open(filePath.c_str(), O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	if (view == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+
+	fileDesc = fd;
+	data = reinterpret_cast<const std::uint8_t*>(view);
+	size = static_cast<std::size_t>(st.st_size);
+#endif
+
+	return true;
+}
+
+void CMappedFile::Close()
+{
+#ifdef _WIN32
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mappingHandle != nullptr)
+		CloseHandle(mappingHandle);
+	if (fileHandle != nullptr)
+		CloseHandle(fileHandle);
+
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+#else
+	if (data != nullptr)
+		munmap(const_cast<std::uint8_t*>(data), size);
+	if (fileDesc >= 0)
+		close(fileDesc);
+
+	fileDesc = -1;
+#endif
+
+	data = nullptr;
+	size = 0;
+}
+
@@ -0,0 +1,47 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief read-only memory-mapped view of a whole file
+ * Pages are faulted in by the OS on first access, so
+ * callers only pay for the parts of the file they touch.
+ */
+class CMappedFile
+{
+public:
+	CMappedFile() = default;
+	CMappedFile(const std::string& filePath) { Open(filePath); }
+	CMappedFile(const CMappedFile&) = delete;
+	CMappedFile(CMappedFile&& f) noexcept { *this = std::move(f); }
+	~CMappedFile() { Close(); }
+
+	CMappedFile& operator = (const CMappedFile&) = delete;
+	CMappedFile& operator = (CMappedFile&& f) noexcept;
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const { return (data != nullptr); }
+
+	const std::uint8_t* GetData() const { return data; }
+	std::size_t GetSize() const { return size; }
+
+private:
+	const std::uint8_t* data = nullptr;
+	std::size_t size = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#else
+	int fileDesc = -1;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -11,10 +11,13 @@
 #endif
 
 #include "lib/lua/src/ltable.h"
+#include "System/HashSpec.h"
 #include "System/UnorderedMap.hpp"
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
+#include <cstring>
 #include <deque>
+#include <vector>
 
 struct creg_lua_State;
 struct creg_Proto;
@@ -726,6 +729,198 @@ void SerializeLightUserData(creg::ISerializer* s, void **p)
 }
 
 
+/*
+ * Compact encoding for TValues nothing else can point to (table slots and
+ * proto constants). Unlike SerializeInstance these are not registered as
+ * creg objects and skip member reflection: a type tag is followed by the
+ * raw payload, GC objects are still written as (deduplicated) references.
+ */
+static void SerializeCompactTValue(creg::ISerializer* s, creg_TValue* tv)
+{
+	s->SerializeInt(&tv->tt, sizeof(tv->tt));
+
+	switch (tv->tt) {
+		case LUA_TNIL: { return; }
+		case LUA_TBOOLEAN: { s->SerializeInt(&tv->value.b, sizeof(tv->value.b)); return; }
+		case LUA_TLIGHTUSERDATA: { SerializeLightUserData(s, &tv->value.p); return; }
+		case LUA_TNUMBER: { s->Serialize(&tv->value.n, sizeof(tv->value.n)); return; }
+		case LUA_TSTRING:
+		case LUA_TTABLE:
+		case LUA_TFUNCTION:
+		case LUA_TUSERDATA:
+		case LUA_TTHREAD: { SerializePtr(s, &tv->value.gc); return; }
+		case LUA_TDEADKEY: { return; }
+		default: { assert(false); return; }
+	}
+}
+
+
+/*
+ * Hash-part key layouts ("shapes") shared between tables, e.g. all
+ * {x=..., y=..., z=...} records. A shape is written once per package;
+ * later tables with identical keys and chains only store its index.
+ * Only shapes without pointer-keys are shared, since those would be
+ * rehashed by creg_Table::PostLoad.
+ */
+struct TableShape {
+	const creg_Node* node;
+	int sizenode;
+};
+
+static std::vector<TableShape> tableShapes;
+static spring::unsynced_map<std::uint64_t, std::vector<int>> tableShapeIndices;
+
+static void ClearTableShapes(void* = nullptr)
+{
+	tableShapes.clear();
+	tableShapeIndices.clear();
+}
+
+static bool IsShareableShape(const creg_Node* node, int sizenode)
+{
+	for (int i = 0; i < sizenode; ++i) {
+		switch (node[i].i_key.nk.tt) {
+			case LUA_TNIL:
+			case LUA_TBOOLEAN:
+			case LUA_TNUMBER:
+			case LUA_TSTRING:
+				break;
+			default:
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static bool EqualNodeKeys(const creg_Node* a, const creg_Node* b, int sizenode)
+{
+	for (int i = 0; i < sizenode; ++i) {
+		const auto& ka = a[i].i_key.nk;
+		const auto& kb = b[i].i_key.nk;
+
+		if (ka.tt != kb.tt)
+			return false;
+		if ((ka.next == nullptr) != (kb.next == nullptr))
+			return false;
+		if (ka.next != nullptr && (ka.next - a) != (kb.next - b))
+			return false;
+
+		switch (ka.tt) {
+			case LUA_TBOOLEAN: { if (ka.value.b != kb.value.b) return false; } break;
+			case LUA_TNUMBER: { if (std::memcmp(&ka.value.n, &kb.value.n, sizeof(ka.value.n)) != 0) return false; } break;
+			case LUA_TSTRING: { if (ka.value.gc != kb.value.gc) return false; } break;
+			default: break;
+		}
+	}
+
+	return true;
+}
+
+static std::uint64_t HashNodeKeys(const creg_Node* node, int sizenode)
+{
+	std::uint64_t hash = sizenode;
+
+	for (int i = 0; i < sizenode; ++i) {
+		const auto& key = node[i].i_key.nk;
+
+		std::uint64_t bits = 0;
+		switch (key.tt) {
+			case LUA_TBOOLEAN: { bits = key.value.b; } break;
+			case LUA_TNUMBER: { std::memcpy(&bits, &key.value.n, sizeof(key.value.n)); } break;
+			case LUA_TSTRING: { bits = reinterpret_cast<std::uintptr_t>(key.value.gc); } break;
+			default: break;
+		}
+
+		hash = spring::hash_combine(bits, spring::hash_combine(key.tt, hash));
+		hash = spring::hash_combine((key.next != nullptr)? (key.next - node): -1, hash);
+	}
+
+	return hash;
+}
+
+static void SerializeNodeKeys(creg::ISerializer* s, creg_Node* node, int sizenode)
+{
+	for (int i = 0; i < sizenode; ++i) {
+		auto& key = node[i].i_key.nk;
+
+		// chain links are stored as 1-based offsets into the node array
+		std::uint32_t nextIdx = 0;
+
+		if (s->IsWriting() && key.next != nullptr)
+			nextIdx = (key.next - node) + 1;
+
+		SerializeCompactTValue(s, &node[i].i_key.tvk);
+		s->SerializeInt(&nextIdx, sizeof(nextIdx));
+
+		if (!s->IsWriting())
+			key.next = (nextIdx != 0)? (node + nextIdx - 1): nullptr;
+	}
+}
+
+static void SerializeTableShape(creg::ISerializer* s, creg_Node* node, int sizenode)
+{
+	// 0 means the keys follow inline, otherwise 1 + index of a known shape
+	std::uint32_t shapeRef = 0;
+
+	if (s->IsWriting()) {
+		const bool shareable = IsShareableShape(node, sizenode);
+		const std::uint64_t hash = shareable? HashNodeKeys(node, sizenode): 0;
+
+		if (shareable) {
+			for (const int idx: tableShapeIndices[hash]) {
+				const TableShape& shape = tableShapes[idx];
+
+				if (shape.sizenode != sizenode || !EqualNodeKeys(shape.node, node, sizenode))
+					continue;
+
+				shapeRef = idx + 1;
+				break;
+			}
+		}
+
+		s->SerializeInt(&shapeRef, sizeof(shapeRef));
+
+		if (shapeRef != 0)
+			return;
+
+		SerializeNodeKeys(s, node, sizenode);
+
+		if (!shareable)
+			return;
+
+		tableShapeIndices[hash].push_back(tableShapes.size());
+		tableShapes.push_back({node, sizenode});
+		return;
+	}
+
+	s->SerializeInt(&shapeRef, sizeof(shapeRef));
+
+	if (shapeRef == 0) {
+		SerializeNodeKeys(s, node, sizenode);
+
+		// mirror the writer, which registers every shareable shape in order
+		if (IsShareableShape(node, sizenode))
+			tableShapes.push_back({node, sizenode});
+
+		return;
+	}
+
+	assert(shapeRef <= tableShapes.size());
+	const TableShape& shape = tableShapes[shapeRef - 1];
+	assert(shape.sizenode == sizenode);
+
+	for (int i = 0; i < sizenode; ++i) {
+		const auto& srcKey = shape.node[i].i_key.nk;
+		auto& dstKey = node[i].i_key.nk;
+
+		dstKey.value = srcKey.value;
+		dstKey.tt = srcKey.tt;
+		dstKey.next = (srcKey.next != nullptr)? (node + (srcKey.next - shape.node)): nullptr;
+	}
+}
+
+
 void creg_TValue::Serialize(creg::ISerializer* s)
 {
 	switch(tt) {
@@ -753,9 +948,15 @@ void creg_Node::Serialize(creg::ISerializer* s)
 
 void creg_Table::Serialize(creg::ISerializer* s)
 {
-	int sizenode = twoto(lsizenode);
+	const int sizenode = twoto(lsizenode);
+
+	if (!s->IsWriting())
+		array = (creg_TValue*) luaContext.alloc(sizearray * sizeof(creg_TValue));
+
+	for (int i = 0; i < sizearray; ++i) {
+		SerializeCompactTValue(s, &array[i]);
+	}
 
-	SerializeCVector(s, &array, sizearray);
 	bool empty;
 	creg_Node* dummy = GetDummyNode();
 	if (s->IsWriting())
@@ -770,7 +971,14 @@ void creg_Table::Serialize(creg::ISerializer* s)
 			assert(node == dummy);
 		}
 	} else {
-		SerializeCVector(s, &node, sizenode);
+		if (!s->IsWriting())
+			node = (creg_Node*) luaContext.alloc(sizenode * sizeof(creg_Node));
+
+		SerializeTableShape(s, node, sizenode);
+
+		for (int i = 0; i < sizenode; ++i) {
+			SerializeCompactTValue(s, &node[i].i_val);
+		}
 	}
 
 	ptrdiff_t lastfreeOffset;
@@ -817,7 +1025,13 @@ void creg_Table::PostLoad()
 
 void creg_Proto::Serialize(creg::ISerializer* s)
 {
-	SerializeCVector(s, &k,        sizek);
+	if (!s->IsWriting())
+		k = (creg_TValue*) luaContext.alloc(sizek * sizeof(creg_TValue));
+
+	for (int i = 0; i < sizek; ++i) {
+		SerializeCompactTValue(s, &k[i]);
+	}
+
 	SerializeCVector(s, &code,     sizecode);
 	SerializeCVector(s, &p,        sizep);
 	SerializeCVector(s, &lineinfo, sizelineinfo);
@@ -1092,6 +1306,12 @@ namespace creg {
 
 void SerializeLuaState(creg::ISerializer* s, lua_State** L)
 {
+	// every package starts with an empty shape table on both ends, and
+	// the table (pointing into the serialized state) is dropped once all
+	// of its objects have been written or read
+	ClearTableShapes();
+	s->AddPostLoadCallback(ClearTableShapes, nullptr);
+
 	creg_LG* clg;
 	if (s->IsWriting()) {
 		assert(*L != nullptr);
@@ -270,6 +270,16 @@ void COutputStreamSerializer::SerializeInt(void* data, int byteSize)
 	WriteVarSizeUInt(stream, x);
 }
 
+void COutputStreamSerializer::AddPostLoadCallback(void (*cb)(void*), void* ud)
+{
+	PostSaveCallback pscb;
+
+	pscb.cb = cb;
+	pscb.userdata = ud;
+
+	callbacks.push_back(pscb);
+}
+
 
 struct COutputStreamSerializer::ClassRef
 {
@@ -310,6 +320,12 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 		}
 	}
 
+	for (const auto& callback: callbacks) {
+		callback.cb(callback.userdata);
+	}
+
+	callbacks.clear();
+
 	// Collect a set of all used classes
 	std::map<creg::Class*, ClassRef> classMap;
 	std::vector<ClassRef*> classRefs;
@@ -87,6 +87,13 @@ namespace creg {
 		std::map<Class*, int> classSizes;
 		std::map<Class*, int> classCounts;
 
+		struct PostSaveCallback
+		{
+			void (*cb)(void* d);
+			void* userdata;
+		};
+		std::vector<PostSaveCallback> callbacks;
+
 		// Serialize all class names
 		void WriteObjectInfo();
 		// Helper for instance/ptr saving
@@ -122,8 +129,8 @@ namespace creg {
 		/** @see ISerializer::SerializeInt */
 		void SerializeInt(void* data, int byteSize);
 
-		/** Empty function, only applies to loading */
-		void AddPostLoadCallback(void (*cb)(void* d), void* d) {}
+		/** Callbacks run after all objects are written, e.g. to release state kept while saving them */
+		void AddPostLoadCallback(void (*cb)(void* userdata), void* userdata);
 	};
 
 	/** Input stream serializer
@@ -0,0 +1,145 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Lua/LuaSyncedSnapshot.h"
+#include "LuaInclude.h"
+
+#include <catch_amalgamated.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+static int handlepanic(lua_State*)
+{
+	throw "lua paniced";
+}
+
+// from lauxlib.cpp
+static void* l_alloc(void*, void* ptr, size_t, size_t nsize)
+{
+	if (nsize == 0) {
+		free(ptr);
+		return nullptr;
+	}
+
+	return realloc(ptr, nsize);
+}
+
+static lua_State* NewState()
+{
+	lua_State* L = lua_newstate(l_alloc, nullptr);
+	lua_atpanic(L, handlepanic);
+	SPRING_LUA_OPEN_LIB(L, luaopen_base);
+	return L;
+}
+
+static void Run(lua_State* L, const char* code)
+{
+	const int err = luaL_loadbuffer(L, code, strlen(code), "test") || lua_pcall(L, 0, 0, 0);
+
+	if (err != 0)
+		FAIL(lua_tostring(L, -1));
+}
+
+// evaluates <expr> in dstL with the snapshots as globals
+static std::string Eval(lua_State* L, const char* expr)
+{
+	const std::string code = std::string("return tostring(") + expr + ")";
+	const int err = luaL_loadbuffer(L, code.c_str(), code.size(), "test") || lua_pcall(L, 0, 1, 0);
+
+	if (err != 0)
+		FAIL(lua_tostring(L, -1));
+
+	const std::string result = lua_tostring(L, -1);
+	lua_pop(L, 1);
+	return result;
+}
+
+
+struct SnapshotFixture {
+	SnapshotFixture()
+		: srcL(NewState())
+		, dstL(NewState())
+	{}
+	~SnapshotFixture() {
+		lua_close(dstL);
+		lua_close(srcL);
+	}
+
+	// snapshots the watched globals of srcL into the globals of dstL
+	void Update() {
+		lua_newtable(dstL);
+		LuaSyncedSnapshot::Update(dstL, LUA_GLOBALSINDEX, lua_gettop(dstL), srcL, watched);
+		lua_pop(dstL, 1);
+	}
+
+	lua_State* srcL;
+	lua_State* dstL;
+
+	std::vector<LuaSyncedTable::WatchedEntry> watched = {{"t", 0}};
+};
+
+
+TEST_CASE_METHOD(SnapshotFixture, "LuaSyncedSnapshot_Update")
+{
+	Run(srcL, "t = {n = 1, s = 'a', sub = {1, 2, 3}}");
+	Update();
+
+	CHECK(Eval(dstL, "t.n") == "1");
+	CHECK(Eval(dstL, "#t.sub") == "3");
+	CHECK(watched[0].version == 1);
+
+	Run(dstL, "sub = t.sub");
+	Run(srcL, "t.n = 2; t.s = nil; t.f = print");
+	Update();
+
+	CHECK(Eval(dstL, "t.n") == "2");
+	CHECK(Eval(dstL, "t.s") == "nil");
+	CHECK(Eval(dstL, "t.f") == "nil");
+	// unchanged subtables keep their identity
+	CHECK(Eval(dstL, "rawequal(sub, t.sub)") == "true");
+	CHECK(watched[0].version == 2);
+
+	Update();
+
+	CHECK(watched[0].version == 2);
+}
+
+TEST_CASE_METHOD(SnapshotFixture, "LuaSyncedSnapshot_SharedTables")
+{
+	Run(srcL, "t = {}; t.a = {v = 'x'}; t.b = t.a; t.r = t");
+	Update();
+
+	CHECK(Eval(dstL, "rawequal(t.a, t.b)") == "true");
+	CHECK(Eval(dstL, "rawequal(t.r, t)") == "true");
+	CHECK(Eval(dstL, "t.a.v") == "x");
+}
+
+TEST_CASE_METHOD(SnapshotFixture, "LuaSyncedSnapshot_SharedTablesDiverge")
+{
+	// either key may be visited first, so replace each one in turn
+	for (const char* key: {"a", "b"}) {
+		CAPTURE(key);
+
+		Run(srcL, "X = {v = 'x'}; t = {a = X, b = X}");
+		Update();
+
+		REQUIRE(Eval(dstL, "rawequal(t.a, t.b)") == "true");
+
+		Run(srcL, (std::string("t.") + key + " = {v = 'z'}").c_str());
+		Update();
+
+		CHECK(Eval(dstL, "rawequal(t.a, t.b)") == "false");
+		CHECK(Eval(dstL, "t.a.v") == ((key[0] == 'a')? "z": "x"));
+		CHECK(Eval(dstL, "t.b.v") == ((key[0] == 'b')? "z": "x"));
+
+		// and the snapshots stay apart once the sources do
+		Run(srcL, "t.a.v = 'p'; t.b.v = 'q'");
+		Update();
+
+		CHECK(Eval(dstL, "t.a.v") == "p");
+		CHECK(Eval(dstL, "t.b.v") == "q");
+	}
+}
@@ -0,0 +1,132 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/CollisionHandler.h"
+#include "Sim/Misc/CollisionVolume.h"
+#include "System/Matrix44f.h"
+#include "System/float3.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+
+static float RandFloat(std::mt19937& rng, float min, float max)
+{
+	return std::uniform_real_distribution<float>(min, max)(rng);
+}
+
+static float3 RandFloat3(std::mt19937& rng, float min, float max)
+{
+	return {RandFloat(rng, min, max), RandFloat(rng, min, max), RandFloat(rng, min, max)};
+}
+
+static CMatrix44f RandMatrix(std::mt19937& rng, const float3& center, float maxOffset)
+{
+	CMatrix44f mat;
+	mat.Translate(center + RandFloat3(rng, -maxOffset, maxOffset));
+	mat.RotateY(RandFloat(rng, -math::PI, math::PI));
+	mat.RotateX(RandFloat(rng, -math::PI, math::PI));
+	mat.RotateZ(RandFloat(rng, -math::PI, math::PI));
+	return mat;
+}
+
+static bool QueriesEqual(const CollisionQuery& a, const CollisionQuery& b)
+{
+	// results must be bit-identical, not just approximately equal
+	return (std::memcmp(&a, &b, sizeof(CollisionQuery)) == 0);
+}
+
+
+TEST_CASE("CollisionBatch_MatchesScalarIntersect")
+{
+	constexpr unsigned int MAX_BATCH_SIZE = 37;
+
+	std::mt19937 rng(4321);
+
+	std::vector<CollisionVolume> volumes;
+	std::vector<CMatrix44f> matrices;
+	std::vector<CollisionQuery> batchQueries;
+	std::vector<CollisionQuery> scalarQueries;
+	bool batchHits[MAX_BATCH_SIZE];
+
+	CollisionVolumeBatch batch;
+
+	unsigned int numHits = 0;
+	unsigned int numTests = 0;
+
+	for (unsigned int n = 0; n < 2000; n++) {
+		// include sizes that do not fill the last SIMD batch
+		const unsigned int numVolumes = std::uniform_int_distribution<unsigned int>(1, MAX_BATCH_SIZE)(rng);
+		const float3 center = RandFloat3(rng, -5000.0f, 5000.0f);
+
+		volumes.clear();
+		volumes.resize(numVolumes);
+		matrices.clear();
+		matrices.resize(numVolumes);
+		batch.Clear();
+
+		for (unsigned int i = 0; i < numVolumes; i++) {
+			const int volType = std::uniform_int_distribution<int>(CollisionVolume::COLVOL_TYPE_ELLIPSOID, CollisionVolume::COLVOL_TYPE_SPHERE)(rng);
+			const int volAxis = std::uniform_int_distribution<int>(CollisionVolume::COLVOL_AXIS_X, CollisionVolume::COLVOL_AXIS_Z)(rng);
+
+			volumes[i].InitShape(RandFloat3(rng, 1.0f, 80.0f), ZeroVector, volType, CollisionVolume::COLVOL_HITTEST_CONT, volAxis);
+			matrices[i] = RandMatrix(rng, center, 50.0f);
+		}
+
+		// volumes are added after InitShape, the batch keeps pointers
+		for (unsigned int i = 0; i < numVolumes; i++) {
+			batch.Add(&volumes[i], matrices[i]);
+		}
+
+		REQUIRE(batch.Size() == numVolumes);
+
+		for (unsigned int r = 0; r < 20; r++) {
+			// mix of short (projectile) and long rays, some starting inside volumes
+			const float3 p0 = center + RandFloat3(rng, -120.0f, 120.0f);
+			const float3 p1 = (r & 1)?
+				p0 + RandFloat3(rng, -40.0f, 40.0f):
+				p0 + (center + RandFloat3(rng, -50.0f, 50.0f) - p0) * RandFloat(rng, 0.5f, 3.0f);
+
+			batchQueries.clear();
+			batchQueries.resize(numVolumes);
+			scalarQueries.clear();
+			scalarQueries.resize(numVolumes);
+
+			const int firstHit = CCollisionHandler::IntersectBatch(batch, p0, p1, batchQueries.data(), batchHits);
+
+			int firstScalarHit = -1;
+
+			for (unsigned int i = 0; i < numVolumes; i++) {
+				const bool scalarHit = CCollisionHandler::Intersect(&volumes[i], matrices[i], p0, p1, &scalarQueries[i]);
+
+				if (scalarHit && firstScalarHit < 0)
+					firstScalarHit = i;
+
+				CHECK(batchHits[i] == scalarHit);
+				CHECK(QueriesEqual(batchQueries[i], scalarQueries[i]));
+
+				numHits += scalarHit;
+				numTests += 1;
+			}
+
+			REQUIRE(firstHit == firstScalarHit);
+
+			// first-hit mode stops at the same entry without needing queries or hits
+			CHECK(CCollisionHandler::IntersectBatch(batch, p0, p1, nullptr, nullptr, true) == firstScalarHit);
+		}
+	}
+
+	// make sure both hits and misses were exercised
+	CHECK(numHits > (numTests / 20));
+	CHECK(numHits < (numTests - numTests / 20));
+}
+
+TEST_CASE("CollisionBatch_Empty")
+{
+	CollisionVolumeBatch batch;
+
+	CHECK(batch.Size() == 0);
+	CHECK(CCollisionHandler::IntersectBatch(batch, ZeroVector, UpVector, nullptr, nullptr) == -1);
+}
@@ -0,0 +1,210 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/FootprintBatch.h"
+#include "Sim/Misc/GlobalConstants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+
+// the rectangle query a single TestUnitBuildSquare makes (see UpdateGroundBlockMaps)
+static bool RefIsNear(const std::vector<int2>& corners, int2 size, int buffer, float x, float z)
+{
+	for (const int2& corner: corners) {
+		const float minx = (corner.x - buffer) * SQUARE_SIZE;
+		const float minz = (corner.y - buffer) * SQUARE_SIZE;
+		const float maxx = (corner.x + size.x + buffer) * SQUARE_SIZE;
+		const float maxz = (corner.y + size.y + buffer) * SQUARE_SIZE;
+
+		if (x < minx || x > maxx)
+			continue;
+		if (z < minz || z > maxz)
+			continue;
+
+		return true;
+	}
+
+	return false;
+}
+
+// what the batch updates: units within a cluster's bounds that are near it
+static bool IsNear(const CFootprintClusters& clusters, float x, float z)
+{
+	for (size_t i = 0; i < clusters.GetNumClusters(); i++) {
+		int2 mins;
+		int2 maxs;
+
+		clusters.GetBounds(i, mins, maxs);
+
+		if (x < mins.x * SQUARE_SIZE || x > maxs.x * SQUARE_SIZE)
+			continue;
+		if (z < mins.y * SQUARE_SIZE || z > maxs.y * SQUARE_SIZE)
+			continue;
+
+		if (clusters.IsNear(i, x, z))
+			return true;
+	}
+
+	return false;
+}
+
+static void CheckClusters(std::mt19937& rng, const std::vector<int2>& corners, int2 size, int buffer, int mapSize)
+{
+	CFootprintClusters clusters;
+	clusters.Init(corners, size, buffer);
+
+	std::uniform_real_distribution<float> posDist(-buffer * SQUARE_SIZE * 1.5f, (mapSize + buffer * 1.5f) * SQUARE_SIZE);
+	std::uniform_int_distribution<int> sqrDist(-buffer - 2, mapSize + buffer + 2);
+
+	for (int n = 0; n < 20000; n++) {
+		float x = posDist(rng);
+		float z = posDist(rng);
+
+		// exercise the (inclusive) edges of the footprint rectangles
+		switch (n % 4) {
+			case 1: { x = sqrDist(rng) * SQUARE_SIZE; z = sqrDist(rng) * SQUARE_SIZE; } break;
+			case 2: { x = std::nextafter(sqrDist(rng) * float(SQUARE_SIZE),  1e9f); z = std::nextafter(sqrDist(rng) * float(SQUARE_SIZE), -1e9f); } break;
+			case 3: { x = std::nextafter(sqrDist(rng) * float(SQUARE_SIZE), -1e9f); } break;
+			default: {} break;
+		}
+
+		CAPTURE(x, z);
+		REQUIRE(IsNear(clusters, x, z) == RefIsNear(corners, size, buffer, x, z));
+	}
+}
+
+
+TEST_CASE("FootprintClusters_Grid")
+{
+	std::mt19937 rng(1);
+	std::vector<int2> corners;
+
+	// a grid search around a builder, as done by build-placement widgets
+	for (int z = 200; z < 260; z += 2) {
+		for (int x = 300; x < 380; x += 2) {
+			corners.emplace_back(x, z);
+		}
+	}
+
+	CheckClusters(rng, corners, {4, 4}, 5, 512);
+	CheckClusters(rng, corners, {3, 5}, 0, 512);
+}
+
+TEST_CASE("FootprintClusters_Sparse")
+{
+	std::mt19937 rng(2);
+	std::uniform_int_distribution<int> cornerDist(0, 1000);
+
+	// candidates spread over the whole map, whose bounding box does not
+	// approximate the area near them at all
+	for (const int count: {1, 2, 7, 50}) {
+		std::vector<int2> corners;
+
+		for (int i = 0; i < count; i++) {
+			corners.emplace_back(cornerDist(rng), cornerDist(rng));
+		}
+
+		// candidates outside the map still have units near them
+		corners.emplace_back(-1, -1);
+		corners.emplace_back(-20, 300);
+		corners.emplace_back(500, -7);
+
+		CAPTURE(count);
+		CheckClusters(rng, corners, {6, 2}, 12, 1024);
+
+		CFootprintClusters clusters;
+		clusters.Init(corners, {6, 2}, 12);
+
+		// each cluster spans at most about two tiles of (6 + 12 * 2) squares
+		for (size_t i = 0; i < clusters.GetNumClusters(); i++) {
+			int2 mins;
+			int2 maxs;
+
+			clusters.GetBounds(i, mins, maxs);
+
+			CHECK((maxs.x - mins.x) <= 2 * (6 + 12 * 2));
+			CHECK((maxs.y - mins.y) <= 2 * (6 + 12 * 2));
+		}
+	}
+}
+
+TEST_CASE("FootprintClusters_Empty")
+{
+	CFootprintClusters clusters;
+	clusters.Init({}, {2, 2}, 4);
+
+	CHECK(clusters.GetNumClusters() == 0);
+}
+
+TEST_CASE("FootprintClusters_OutOfMap")
+{
+	std::mt19937 rng(4);
+
+	// corners on both sides of zero must not share a tile
+	const std::vector<int2> corners = {{-1, -1}, {-3, 2}, {1, -5}, {-30, -30}};
+
+	CheckClusters(rng, corners, {2, 2}, 4, 64);
+
+	CFootprintClusters clusters;
+	clusters.Init(corners, {2, 2}, 4);
+
+	for (size_t i = 0; i < clusters.GetNumClusters(); i++) {
+		int2 mins;
+		int2 maxs;
+
+		clusters.GetBounds(i, mins, maxs);
+
+		CHECK((maxs.x - mins.x) <= 2 * (2 + 4 * 2));
+		CHECK((maxs.y - mins.y) <= 2 * (2 + 4 * 2));
+	}
+}
+
+
+TEST_CASE("FootprintHeightRanges")
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> heightDist(-100.0f, 300.0f);
+
+	constexpr int mapWidth = 96;
+	constexpr int mapHeight = 80;
+
+	std::vector<float> heightMap(mapWidth * mapHeight);
+
+	for (float& h: heightMap) {
+		h = heightDist(rng);
+	}
+
+	for (const int2 size: {int2(1, 1), int2(4, 4), int2(3, 7), int2(8, 2)}) {
+		const int2 mins = {10, 5};
+		const int2 maxs = {mapWidth - size.x, mapHeight - size.y};
+
+		// few footprints are scanned directly, many share the table
+		for (const size_t numFootprints: {size_t(1), size_t(100000)}) {
+			const CFootprintHeightRanges ranges(heightMap.data(), mapWidth, mins, maxs, size, numFootprints);
+
+			for (int z = mins.y; z <= maxs.y; z++) {
+				for (int x = mins.x; x <= maxs.x; x++) {
+					float2 ref = {heightMap[z * mapWidth + x], heightMap[z * mapWidth + x]};
+
+					// every square TestUnitBuildSquare tests for this corner
+					for (int sz = z; sz < z + size.y; sz++) {
+						for (int sx = x; sx < x + size.x; sx++) {
+							ref.x = std::min(ref.x, heightMap[sz * mapWidth + sx]);
+							ref.y = std::max(ref.y, heightMap[sz * mapWidth + sx]);
+						}
+					}
+
+					const float2 range = ranges.Get({x, z});
+
+					CAPTURE(size.x, size.y, numFootprints, x, z);
+					REQUIRE(range.x == ref.x);
+					REQUIRE(range.y == ref.y);
+				}
+			}
+		}
+	}
+}
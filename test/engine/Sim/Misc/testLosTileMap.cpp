@@ -0,0 +1,160 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/LosTileMap.h"
+
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+
+struct Span {
+	int x1;
+	int x2;
+	int y;
+};
+
+static Span RandSpan(std::mt19937& rng, int2 size)
+{
+	const int y = std::uniform_int_distribution<int>(0, size.y - 1)(rng);
+	const int x1 = std::uniform_int_distribution<int>(0, size.x - 1)(rng);
+	const int x2 = std::uniform_int_distribution<int>(x1, std::min(size.x, x1 + 40))(rng);
+
+	return {x1, x2, y};
+}
+
+
+TEST_CASE("LosTileMap_MatchesDenseMap")
+{
+	std::mt19937 rng(2468);
+
+	// include sizes that are not a multiple of the tile size
+	for (const int2 size: {int2(16, 16), int2(37, 21), int2(128, 96), int2(5, 200)}) {
+		CLosTileMap tileMap;
+		tileMap.Init(size);
+
+		std::vector<unsigned short> denseMap(size.x * size.y, 0);
+		std::vector<Span> added;
+
+		unsigned int numEntered = 0;
+		unsigned int numExpectedEntered = 0;
+
+		for (unsigned int n = 0; n < 4000; n++) {
+			// remove previously added spans about as often as new ones are added
+			const bool remove = !added.empty() && (std::uniform_int_distribution<int>(0, 1)(rng) == 0);
+
+			Span span;
+
+			if (remove) {
+				const size_t idx = std::uniform_int_distribution<size_t>(0, added.size() - 1)(rng);
+
+				span = added[idx];
+				added[idx] = added.back();
+				added.pop_back();
+			} else {
+				span = RandSpan(rng, size);
+				added.push_back(span);
+			}
+
+			const int amount = remove? -1: 1;
+
+			for (int x = span.x1; x < span.x2; x++) {
+				numExpectedEntered += (denseMap[span.y * size.x + x] == 0);
+				denseMap[span.y * size.x + x] += amount;
+			}
+
+			tileMap.AddSpan(span.x1, span.x2, span.y, amount, [&](int x, int y) {
+				CHECK(y == span.y);
+				CHECK(x >= span.x1);
+				CHECK(x < span.x2);
+				numEntered++;
+			});
+
+			// the dense mirror only exists from some point on
+			if (n == 1000)
+				tileMap.GetDense();
+			if (n >= 1000 && (n % 97) == 0)
+				REQUIRE(tileMap.GetDense() == denseMap);
+		}
+
+		CHECK(numEntered == numExpectedEntered);
+
+		for (int y = 0; y < size.y; y++) {
+			for (int x = 0; x < size.x; x++) {
+				CHECK(tileMap.At(x, y) == denseMap[y * size.x + x]);
+			}
+		}
+
+		CHECK(tileMap.GetDense() == denseMap);
+
+		// empty tiles are released again
+		for (const Span& span: added) {
+			tileMap.AddSpan(span.x1, span.x2, span.y, -1);
+		}
+
+		CHECK(tileMap.GetNumUsedTiles() == 0);
+		CHECK(tileMap.GetDense() == std::vector<unsigned short>(size.x * size.y, 0));
+	}
+}
+
+TEST_CASE("LosTileMap_DenseMirrorStaysCurrent")
+{
+	std::mt19937 rng(1357);
+
+	const int2 size = {70, 45};
+
+	CLosTileMap tileMap;
+	tileMap.Init(size);
+	tileMap.AddSpan(3, 40, 7, 2);
+
+	// legacy AIs keep the raw pointer around instead of asking again
+	const unsigned short* dense = tileMap.GetDense().data();
+
+	CHECK(dense[7 * size.x + 3] == 2);
+
+	std::vector<Span> added;
+
+	for (unsigned int n = 0; n < 500; n++) {
+		const Span span = RandSpan(rng, size);
+
+		tileMap.AddSpan(span.x1, span.x2, span.y, 1);
+		added.push_back(span);
+	}
+	for (size_t i = 0; i < added.size(); i += 2) {
+		tileMap.AddSpan(added[i].x1, added[i].x2, added[i].y, -1);
+	}
+
+	for (int y = 0; y < size.y; y++) {
+		for (int x = 0; x < size.x; x++) {
+			CHECK(dense[y * size.x + x] == tileMap.At(x, y));
+		}
+	}
+
+	CHECK(tileMap.GetDense().data() == dense);
+}
+
+TEST_CASE("LosTileMap_SparseAllocation")
+{
+	CLosTileMap tileMap;
+	tileMap.Init({1024, 1024});
+
+	CHECK(tileMap.GetNumTiles() == (1024 / CLosTileMap::TILE_SIZE) * (1024 / CLosTileMap::TILE_SIZE));
+	CHECK(tileMap.GetNumUsedTiles() == 0);
+	CHECK(tileMap.At(500, 500) == 0);
+
+	// a span crossing one tile border touches exactly two tiles
+	tileMap.AddSpan(CLosTileMap::TILE_SIZE - 2, CLosTileMap::TILE_SIZE + 2, 3, 1);
+	CHECK(tileMap.GetNumUsedTiles() == 2);
+
+	tileMap.AddSpan(CLosTileMap::TILE_SIZE - 2, CLosTileMap::TILE_SIZE, 3, -1);
+	CHECK(tileMap.GetNumUsedTiles() == 1);
+	CHECK(tileMap.At(CLosTileMap::TILE_SIZE - 1, 3) == 0);
+	CHECK(tileMap.At(CLosTileMap::TILE_SIZE, 3) == 1);
+
+	// freed tiles are reused instead of growing the storage
+	const size_t memUsage = tileMap.GetMemUsage();
+
+	tileMap.AddSpan(512, 514, 700, 1);
+	CHECK(tileMap.GetNumUsedTiles() == 2);
+	CHECK(tileMap.GetMemUsage() == memUsage);
+}
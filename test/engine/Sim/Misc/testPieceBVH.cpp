@@ -0,0 +1,206 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/CollisionHandler.h"
+#include "Sim/Misc/CollisionVolume.h"
+#include "Sim/Misc/PieceBVH.h"
+#include "System/Matrix44f.h"
+#include "System/float3.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+
+struct TestModel {
+	std::vector<CollisionVolume> volumes;
+	std::vector<CMatrix44f> pieceMats; // piece-space to model-space, incl. volume offsets
+	std::vector<bool> visible;
+
+	CMatrix44f objectMat; // model-space to world-space
+};
+
+static float RandFloat(std::mt19937& rng, float min, float max)
+{
+	return std::uniform_real_distribution<float>(min, max)(rng);
+}
+
+static float3 RandFloat3(std::mt19937& rng, float min, float max)
+{
+	return {RandFloat(rng, min, max), RandFloat(rng, min, max), RandFloat(rng, min, max)};
+}
+
+static CMatrix44f RandMatrix(std::mt19937& rng, float maxOffset)
+{
+	CMatrix44f mat;
+	mat.Translate(RandFloat3(rng, -maxOffset, maxOffset));
+	mat.RotateY(RandFloat(rng, -math::PI, math::PI));
+	mat.RotateX(RandFloat(rng, -math::PI, math::PI));
+	mat.RotateZ(RandFloat(rng, -math::PI, math::PI));
+	return mat;
+}
+
+static void RandPieceMatrices(std::mt19937& rng, TestModel& model)
+{
+	for (size_t n = 0; n < model.volumes.size(); n++) {
+		model.pieceMats[n] = RandMatrix(rng, 60.0f);
+		model.pieceMats[n].Translate(model.volumes[n].GetOffsets());
+	}
+}
+
+static TestModel RandModel(std::mt19937& rng, unsigned int numPieces)
+{
+	TestModel model;
+	model.volumes.resize(numPieces);
+	model.pieceMats.resize(numPieces);
+	model.visible.resize(numPieces);
+
+	for (unsigned int n = 0; n < numPieces; n++) {
+		const int volType = std::uniform_int_distribution<int>(CollisionVolume::COLVOL_TYPE_ELLIPSOID, CollisionVolume::COLVOL_TYPE_SPHERE)(rng);
+		const int volAxis = std::uniform_int_distribution<int>(CollisionVolume::COLVOL_AXIS_X, CollisionVolume::COLVOL_AXIS_Z)(rng);
+
+		model.volumes[n].InitShape(RandFloat3(rng, 2.0f, 30.0f), RandFloat3(rng, -5.0f, 5.0f), volType, CollisionVolume::COLVOL_HITTEST_CONT, volAxis);
+		model.visible[n] = (RandFloat(rng, 0.0f, 1.0f) > 0.1f);
+	}
+
+	RandPieceMatrices(rng, model);
+
+	model.objectMat = RandMatrix(rng, 1000.0f);
+	return model;
+}
+
+static std::vector<PieceBVH::Bounds> GetPieceBounds(const TestModel& model)
+{
+	std::vector<PieceBVH::Bounds> bounds(model.volumes.size());
+
+	for (size_t n = 0; n < model.volumes.size(); n++) {
+		bounds[n] = PieceBVH::GetVolumeBounds(&model.volumes[n], model.pieceMats[n]);
+	}
+
+	return bounds;
+}
+
+
+// the same selection CCollisionHandler::IntersectPiecesHelper makes
+static int IntersectLinear(const TestModel& model, const float3& p0, const float3& p1, CollisionQuery* cq)
+{
+	const auto GetVolume = [&](unsigned int n, CMatrix44f& volMat) -> const CollisionVolume* {
+		if (!model.visible[n])
+			return nullptr;
+
+		volMat = model.objectMat * model.pieceMats[n];
+		return &model.volumes[n];
+	};
+
+	return CCollisionHandler::IntersectClosestVolume(GetVolume, nullptr, model.volumes.size(), p0, p1, cq);
+}
+
+static int IntersectBVH(const TestModel& model, const PieceBVH& bvh, const float3& p0, const float3& p1, CollisionQuery* cq)
+{
+	const auto GetVolume = [&](unsigned int n, CMatrix44f& volMat) -> const CollisionVolume* {
+		if (!model.visible[n])
+			return nullptr;
+
+		volMat = model.objectMat * model.pieceMats[n];
+		return &model.volumes[n];
+	};
+
+	const CMatrix44f invObjectMat = model.objectMat.InvertAffine();
+
+	std::vector<unsigned int> indices;
+	bvh.QuerySegment(invObjectMat.Mul(p0), invObjectMat.Mul(p1), indices);
+	std::sort(indices.begin(), indices.end());
+
+	return CCollisionHandler::IntersectClosestVolume(GetVolume, indices.data(), indices.size(), p0, p1, cq);
+}
+
+
+static void CheckRays(std::mt19937& rng, const TestModel& model, const PieceBVH& bvh, unsigned int numRays, unsigned int& numHits)
+{
+	const float3 center = model.objectMat.GetPos();
+
+	for (unsigned int r = 0; r < numRays; r++) {
+		// mix of short rays (projectiles) and long ones (mouse picking)
+		const float3 p0 = center + RandFloat3(rng, -150.0f, 150.0f);
+		const float3 p1 = (r & 1)?
+			p0 + RandFloat3(rng, -40.0f, 40.0f):
+			center + (center + RandFloat3(rng, -80.0f, 80.0f) - p0) * RandFloat(rng, 1.0f, 20.0f);
+
+		CollisionQuery cqLinear;
+		CollisionQuery cqBVH;
+
+		const int hitLinear = IntersectLinear(model, p0, p1, &cqLinear);
+		const int hitBVH = IntersectBVH(model, bvh, p0, p1, &cqBVH);
+
+		REQUIRE(hitLinear == hitBVH);
+		REQUIRE((IntersectLinear(model, p0, p1, nullptr) >= 0) == (IntersectBVH(model, bvh, p0, p1, nullptr) >= 0));
+
+		if (hitLinear < 0)
+			continue;
+
+		numHits++;
+
+		CHECK(cqLinear.IngressHit() == cqBVH.IngressHit());
+		CHECK(cqLinear.EgressHit() == cqBVH.EgressHit());
+		CHECK(cqLinear.InsideHit() == cqBVH.InsideHit());
+		CHECK(cqLinear.GetHitPos() == cqBVH.GetHitPos());
+		CHECK(cqLinear.GetEgressPos() == cqBVH.GetEgressPos());
+	}
+}
+
+
+TEST_CASE("PieceBVH_BuildAndRefit")
+{
+	std::mt19937 rng(1234);
+
+	for (unsigned int numPieces: {1u, 2u, 7u, 50u, 100u}) {
+		TestModel model = RandModel(rng, numPieces);
+
+		PieceBVH bvh;
+		bvh.Build(GetPieceBounds(model));
+
+		CHECK(bvh.GetNumLeaves() == numPieces);
+		CHECK(bvh.GetNumNodes() == (numPieces * 2 - 1));
+
+		// every piece must be found by a segment through its own center
+		for (unsigned int n = 0; n < numPieces; n++) {
+			std::vector<unsigned int> indices;
+
+			const float3 c = model.pieceMats[n].GetPos();
+			bvh.QuerySegment(c - float3(1.0f, 0.0f, 0.0f), c + float3(1.0f, 0.0f, 0.0f), indices);
+
+			CHECK(std::find(indices.begin(), indices.end(), n) != indices.end());
+		}
+
+		// a segment far outside the model finds nothing
+		std::vector<unsigned int> indices;
+		bvh.QuerySegment(float3(1e4f, 1e4f, 1e4f), float3(2e4f, 1e4f, 1e4f), indices);
+		CHECK(indices.empty());
+	}
+}
+
+TEST_CASE("PieceBVH_MatchesLinearPieceTest")
+{
+	std::mt19937 rng(5678);
+
+	unsigned int numHits = 0;
+
+	for (unsigned int m = 0; m < 200; m++) {
+		TestModel model = RandModel(rng, std::uniform_int_distribution<unsigned int>(8, 100)(rng));
+
+		PieceBVH bvh;
+		bvh.Build(GetPieceBounds(model));
+
+		CheckRays(rng, model, bvh, 200, numHits);
+
+		// pieces move (animation), the topology is kept and only refitted
+		RandPieceMatrices(rng, model);
+		bvh.Refit(GetPieceBounds(model));
+
+		CheckRays(rng, model, bvh, 200, numHits);
+	}
+
+	// make sure the comparison was not vacuous
+	CHECK(numHits > 1000);
+}
@@ -0,0 +1,501 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/ResourceSpotFinder.h"
+#include "lib/streflop/streflop_cond.h"
+
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+
+using Spot = CResourceSpotFinder::Spot;
+
+// CResourceMapAnalyzer::GetResourcePoints before the passes over the whole
+// map were restructured, with spots recorded in resource-map coordinates
+struct RefAnalyzer {
+	RefAnalyzer(const std::vector<unsigned char>& resourceMap, int mapWidth, int mapHeight, int extractorRadius)
+		: resourceMapArray(resourceMap.data())
+		, mapHeight(mapHeight)
+		, mapWidth(mapWidth)
+		, totalCells(mapWidth * mapHeight)
+		, squareRadius(extractorRadius * extractorRadius)
+		, xtractorRadius(extractorRadius)
+		, doubleRadius(extractorRadius * 2)
+		, rexArrayA(totalCells)
+		, rexArrayB(totalCells)
+		, rexArrayC(totalCells)
+		, tempAverage(totalCells)
+	{}
+
+	void GetResourcePoints() {
+		std::vector<int> xend(doubleRadius + 1);
+
+		for (int a = 0; a < doubleRadius + 1; a++) {
+			float z = a - xtractorRadius;
+			float floatsqrradius = squareRadius;
+			xend[a] = int(math::sqrt(floatsqrradius - z * z));
+		}
+
+		// load up the resource values in each pixel
+		double totalResourcesDouble  = 0;
+
+		for (int i = 0; i < totalCells; i++) {
+			// count the total resources so you can work out
+			// an average of the whole map
+			totalResourcesDouble +=  rexArrayA[i] = resourceMapArray[i];
+		}
+
+		// do the average
+		averageIncome = totalResourcesDouble / totalCells;
+		numSpotsFound = 0;
+
+		// if the map does not have any resource (quick test), just stop
+		if (totalResourcesDouble < 0.9)
+			return;
+
+		// Now work out how much resources each spot can make
+		// by adding up the resources from nearby spots
+		for (int y = 0; y < mapHeight; y++) {
+			for (int x = 0; x < mapWidth; x++) {
+				totalResources = 0;
+
+				// first spot needs full calculation
+				if (x == 0 && y == 0)
+					for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+						if (sy >= 0 && sy < mapHeight){
+							for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
+								if (sx >= 0 && sx < mapWidth) {
+									// get the resources from all pixels around the extractor radius
+									totalResources += rexArrayA[sy * mapWidth + sx];
+								}
+							}
+						}
+					}
+
+				// quick calc test
+				if (x > 0) {
+					totalResources = tempAverage[y * mapWidth + x - 1];
+					for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+						if (sy >= 0 && sy < mapHeight) {
+							const int addX = x + xend[a];
+							const int remX = x - xend[a] - 1;
+
+							if (addX < mapWidth) {
+								totalResources += rexArrayA[sy * mapWidth + addX];
+							}
+							if (remX >= 0) {
+								totalResources -= rexArrayA[sy * mapWidth + remX];
+							}
+						}
+					}
+				} else if (y > 0) {
+					// x == 0 here
+					totalResources = tempAverage[(y - 1) * mapWidth];
+					// remove the top half
+					int a = xtractorRadius;
+
+					for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
+						if (sx < mapWidth) {
+							const int remY = y - xend[a] - 1;
+
+							if (remY >= 0) {
+								totalResources -= rexArrayA[remY * mapWidth + sx];
+							}
+						}
+					}
+
+					// add the bottom half
+					a = xtractorRadius;
+
+					for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
+						if (sx < mapWidth) {
+							const int addY = y + xend[a];
+
+							if (addY < mapHeight) {
+								totalResources += rexArrayA[addY * mapWidth + sx];
+							}
+						}
+					}
+				}
+
+				// set that spot's resource making ability
+				// (divide by cells to values are small)
+				tempAverage[y * mapWidth + x] = totalResources;
+
+				if (maxResource < totalResources) {
+					// find the spot with the highest resource value to set as the map's max
+					maxResource = totalResources;
+				}
+			}
+		}
+
+		// make a list for the distribution of values
+		std::vector<int> valueDist(256, 0);
+
+		// this will get the total resources a rex placed at each spot would make
+		for (int i = 0; i < totalCells; i++) {
+			// scale the resources so any map will have values 0-255,
+			// no matter how much resources it has
+			rexArrayB[i] = tempAverage[i] * 255 / maxResource;
+			// clear out the array since it has never been used
+			rexArrayC[i] = 0;
+
+			int value = rexArrayB[i];
+			valueDist[value]++;
+		}
+
+		// find the current best value
+		int bestValue = 0;
+		int numberOfValues = 0;
+		int usedSpots = 0;
+
+		for (int i = 255; i >= 0; i--) {
+			if (valueDist[i] != 0) {
+				bestValue = i;
+				numberOfValues = valueDist[i];
+				break;
+			}
+		}
+
+		// make a list of the indexes of the best spots
+		// (make sure that the list wont be too big)
+		if (numberOfValues > 256) {
+			numberOfValues = 256;
+		}
+
+		std::vector<int> bestSpotList(numberOfValues);
+
+		for (int i = 0; i < totalCells; i++) {
+			if (rexArrayB[i] == bestValue) {
+				// add the index of this spot to the list
+				bestSpotList[usedSpots] = i;
+				usedSpots++;
+
+				if (usedSpots == numberOfValues) {
+					// the list is filled, stop the loop
+					usedSpots = 0;
+					break;
+				}
+			}
+		}
+
+		for (int a = 0; a < maxSpots; a++) {
+			if (!stopMe) {
+				// reset temporary resources so it can find new spots
+				tempResources = 0;
+				// take the first spot
+				int speedTempResources_x = 0;
+				int speedTempResources_y = 0;
+				int speedTempResources = 0;
+				bool found = false;
+
+				while (!found) {
+					if (usedSpots == numberOfValues) {
+						// the list is empty now, refill it
+
+						// make a list of all the best spots
+						for (int i = 0; i < 256; i++) {
+							// clear the array
+							valueDist[i] = 0;
+						}
+
+						// find the resource distribution
+						for (int i = 0; i < totalCells; i++) {
+							int value = rexArrayB[i];
+							valueDist[value]++;
+						}
+
+						// find the current best value
+						bestValue = 0;
+						numberOfValues = 0;
+						usedSpots = 0;
+
+						for (int i = 255; i >= 0; i--) {
+							if (valueDist[i] != 0) {
+								bestValue = i;
+								numberOfValues = valueDist[i];
+								break;
+							}
+						}
+
+						// make a list of the indexes of the best spots
+						// (make sure that the list wont be too big)
+						if (numberOfValues > 256) {
+							numberOfValues = 256;
+						}
+
+						bestSpotList.clear();
+						bestSpotList.resize(numberOfValues);
+
+						for (int i = 0; i < totalCells; i++) {
+							if (rexArrayB[i] == bestValue) {
+								// add the index of this spot to the list
+								bestSpotList[usedSpots] = i;
+								usedSpots++;
+
+								if (usedSpots == numberOfValues) {
+									// the list is filled, stop the loop
+									usedSpots = 0;
+									break;
+								}
+							}
+						}
+					}
+
+					// The list is not empty now.
+					int spotIndex = bestSpotList[usedSpots];
+
+					if (rexArrayB[spotIndex] == bestValue) {
+						// the spot is still valid, so use it
+						speedTempResources_x = spotIndex % mapWidth;
+						speedTempResources_y = spotIndex / mapWidth;
+						speedTempResources = bestValue;
+						found = true;
+					}
+
+					// update the bestSpotList index
+					usedSpots++;
+				}
+
+				coordX = speedTempResources_x;
+				coordZ = speedTempResources_y;
+				tempResources = speedTempResources;
+			}
+
+			if (tempResources < minIncomeForSpot) {
+				// if the spots get too crappy it will stop running the loops to speed it all up
+				stopMe = true;
+			}
+
+			if (!stopMe) {
+				spots.push_back({coordX, coordZ, tempResources});
+
+				// plot TGA array (not necessary) for debug
+				rexArrayC[coordZ * mapWidth + coordX] = tempResources;
+				numSpotsFound += 1;
+
+				// small speedup of "wipes the resources around the spot so it is not counted twice"
+				for (int sy = coordZ - xtractorRadius, a = 0;  sy <= coordZ + xtractorRadius;  sy++, a++) {
+					if (sy >= 0 && sy < mapHeight) {
+						int clearXStart = coordX - xend[a];
+						int clearXEnd = coordX + xend[a];
+
+						if (clearXStart < 0) {
+							clearXStart = 0;
+						}
+						if (clearXEnd >= mapWidth) {
+							clearXEnd = mapWidth - 1;
+						}
+
+						for (int xClear = clearXStart; xClear <= clearXEnd; xClear++) {
+							// wipes the resources around the spot so it is not counted twice
+							rexArrayA[sy * mapWidth + xClear] = 0;
+							rexArrayB[sy * mapWidth + xClear] = 0;
+							tempAverage[sy * mapWidth + xClear] = 0;
+						}
+					}
+				}
+
+				// redo the whole averaging process around the picked spot so other spots can be found around it
+				for (int y = coordZ - doubleRadius; y <= coordZ + doubleRadius; y++) {
+					if (y >=0 && y < mapHeight) {
+						for (int x = coordX - doubleRadius; x <= coordX + doubleRadius; x++) {
+							if (x >=0 && x < mapWidth) {
+								totalResources = 0;
+
+								// comment out for debug
+								if (x == 0 && y == 0) {
+									for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+										if (sy >= 0 && sy < mapHeight) {
+											for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
+												if (sx >= 0 && sx < mapWidth) {
+													// get the resources from all pixels around the extractor radius
+													totalResources += rexArrayA[sy * mapWidth + sx];
+												}
+											}
+										}
+									}
+								}
+
+								// quick calc test
+								if (x > 0) {
+									totalResources = tempAverage[y * mapWidth + x - 1];
+
+									for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+										if (sy >= 0 && sy < mapHeight) {
+											int addX = x + xend[a];
+											int remX = x - xend[a] - 1;
+
+											if (addX < mapWidth) {
+												totalResources += rexArrayA[sy * mapWidth + addX];
+											}
+											if (remX >= 0) {
+												totalResources -= rexArrayA[sy * mapWidth + remX];
+											}
+										}
+									}
+								} else if (y > 0) {
+									// x == 0 here
+									totalResources = tempAverage[(y - 1) * mapWidth];
+									// remove the top half
+									int a = xtractorRadius;
+
+									for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
+										if (sx < mapWidth) {
+											int remY = y - xend[a] - 1;
+
+											if (remY >= 0) {
+												totalResources -= rexArrayA[remY * mapWidth + sx];
+											}
+										}
+									}
+
+									// add the bottom half
+									a = xtractorRadius;
+
+									for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
+										if (sx < mapWidth) {
+											int addY = y + xend[a];
+
+											if (addY < mapHeight) {
+												totalResources += rexArrayA[addY * mapWidth + sx];
+											}
+										}
+									}
+								}
+
+								tempAverage[y * mapWidth + x] = totalResources;
+								// set that spot's resource amount
+								rexArrayB[y * mapWidth + x] = totalResources * 255 / maxResource;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	const unsigned char* resourceMapArray;
+
+	std::vector<Spot> spots;
+
+	int numSpotsFound = -1;
+	float averageIncome = 0.0f;
+	bool stopMe = false;
+
+	int maxSpots = 10000;
+	int mapHeight;
+	int mapWidth;
+	int totalCells;
+	int squareRadius;
+	int totalResources = 0;
+	int maxResource = 0;
+	int tempResources = 0;
+	int coordX = 0;
+	int coordZ = 0;
+	int minIncomeForSpot = 50;
+	int xtractorRadius;
+	int doubleRadius;
+
+	std::vector<unsigned char> rexArrayA;
+	std::vector<unsigned char> rexArrayB;
+	std::vector<unsigned char> rexArrayC;
+	std::vector<int> tempAverage;
+};
+
+
+// sparse blobs of resources on an empty map, like most metal maps
+static std::vector<unsigned char> RandSpotMap(std::mt19937& rng, int mapWidth, int mapHeight)
+{
+	std::vector<unsigned char> resourceMap(mapWidth * mapHeight, 0);
+	std::uniform_int_distribution<int> posDist(0, mapWidth * mapHeight - 1);
+	std::uniform_int_distribution<int> sizeDist(0, 3);
+	std::uniform_int_distribution<int> valueDist(1, 255);
+
+	for (int n = (mapWidth * mapHeight) / 200; n > 0; n--) {
+		const int pos = posDist(rng);
+		const int size = sizeDist(rng);
+		const int value = valueDist(rng);
+
+		for (int z = pos / mapWidth - size; z <= pos / mapWidth + size; z++) {
+			for (int x = pos % mapWidth - size; x <= pos % mapWidth + size; x++) {
+				if (x >= 0 && x < mapWidth && z >= 0 && z < mapHeight)
+					resourceMap[z * mapWidth + x] = value;
+			}
+		}
+	}
+
+	return resourceMap;
+}
+
+// resources everywhere, with many ties between equally good spots
+static std::vector<unsigned char> RandNoiseMap(std::mt19937& rng, int mapWidth, int mapHeight)
+{
+	std::vector<unsigned char> resourceMap(mapWidth * mapHeight);
+	std::uniform_int_distribution<int> valueDist(0, 3);
+
+	for (unsigned char& value: resourceMap) {
+		value = valueDist(rng) * 60;
+	}
+
+	return resourceMap;
+}
+
+static void CheckSameSpots(const std::vector<unsigned char>& resourceMap, int mapWidth, int mapHeight, int extractorRadius)
+{
+	RefAnalyzer ref(resourceMap, mapWidth, mapHeight, extractorRadius);
+	ref.GetResourcePoints();
+
+	CResourceSpotFinder spotFinder;
+	std::vector<Spot> spots;
+
+	spotFinder.Init(resourceMap.data(), mapWidth, mapHeight, extractorRadius);
+	spotFinder.FindSpots(spots, ref.maxSpots, ref.minIncomeForSpot);
+
+	CAPTURE(mapWidth, mapHeight, extractorRadius);
+	CHECK(float(spotFinder.GetTotalResources() / (mapWidth * mapHeight)) == ref.averageIncome);
+	REQUIRE(int(spots.size()) == ref.numSpotsFound);
+
+	if (spots.empty())
+		return;
+
+	CHECK(spotFinder.GetMaxResource() == ref.maxResource);
+
+	for (size_t i = 0; i < spots.size(); i++) {
+		CAPTURE(i);
+		CHECK(spots[i].x == ref.spots[i].x);
+		CHECK(spots[i].z == ref.spots[i].z);
+		CHECK(spots[i].value == ref.spots[i].value);
+	}
+}
+
+
+TEST_CASE("ResourceSpotFinder_MatchesSerialAnalysis")
+{
+	std::mt19937 rng(95095);
+
+	constexpr int mapSizes[][2] = {{1, 1}, {7, 3}, {64, 64}, {96, 40}, {33, 130}, {256, 256}};
+	constexpr int extractorRadii[] = {0, 1, 3, 8};
+
+	for (const auto& mapSize: mapSizes) {
+		for (const int extractorRadius: extractorRadii) {
+			CheckSameSpots(RandSpotMap(rng, mapSize[0], mapSize[1]), mapSize[0], mapSize[1], extractorRadius);
+			CheckSameSpots(RandNoiseMap(rng, mapSize[0], mapSize[1]), mapSize[0], mapSize[1], extractorRadius);
+		}
+	}
+}
+
+TEST_CASE("ResourceSpotFinder_EmptyMap")
+{
+	const std::vector<unsigned char> resourceMap(32 * 32, 0);
+
+	CResourceSpotFinder spotFinder;
+	std::vector<Spot> spots;
+
+	spotFinder.Init(resourceMap.data(), 32, 32, 2);
+	spotFinder.FindSpots(spots, 10000, 50);
+
+	CHECK(spots.empty());
+	CHECK(spotFinder.GetTotalResources() == 0.0);
+}
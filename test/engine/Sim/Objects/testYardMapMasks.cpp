@@ -0,0 +1,238 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Objects/YardMapMasks.h"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+
+// per-square rotation as done by CSolidObject::GetGroundBlockingMaskAtPos
+static int RefBlockingState(const std::vector<YardMapStatus>& yardMap, int2 footprint, int facing, int x, int z)
+{
+	const int2 hFootprint{footprint.x >> 1, footprint.y >> 1};
+	const int2 size = ((facing & 1) == 0)? footprint: int2(footprint.y, footprint.x);
+	const int2 diff = int2(x, z) - int2(size.x >> 1, size.y >> 1);
+
+	constexpr int2 rotationDirs[] = { {0,1}, {1,0}, {0,-1}, {-1,0}, {0,1} };
+	constexpr int2 rotationCorrections[] = { {0,0}, {-1,0}, {-1,-1}, {0,-1} };
+
+	const int2 front = rotationDirs[facing];
+	const int2 right = rotationDirs[facing + 1];
+	const int2 adjust = rotationCorrections[facing];
+
+	const int by = (front.x * diff.x) + (front.y * diff.y) + hFootprint.y + adjust.y;
+	const int bx = (right.x * diff.x) + (right.y * diff.y) + hFootprint.x + adjust.x;
+
+	if (bx < 0 || by < 0 || bx >= footprint.x || by >= footprint.y)
+		return YARDMAP_OPEN;
+
+	return YardmapStates(yardMap[bx + by * footprint.x]);
+}
+
+// per-square rotation as done by the build-site tests
+static int RefBuildState(const std::vector<YardMapStatus>& yardMap, int2 footprint, int facing, int x, int z)
+{
+	int2 size = ((facing & 1) == 0)? footprint: int2(footprint.y, footprint.x);
+
+	switch (facing) {
+		case 2: { x = size.x - x - 1; z = size.y - z - 1; } break;
+		case 1: { z = size.y - z - 1; std::swap(x, z); std::swap(size.x, size.y); } break;
+		case 3: { x = size.x - x - 1; std::swap(x, z); std::swap(size.x, size.y); } break;
+		default: {} break;
+	}
+
+	return YardmapStates(yardMap[x + size.x * z]);
+}
+
+static std::vector<YardMapStatus> RandYardMap(std::mt19937& rng, int2 footprint)
+{
+	constexpr YardmapStates states[] = {
+		YARDMAP_OPEN, YARDMAP_STACKABLE, YARDMAP_GEOSTACKABLE, YARDMAP_YARD, YARDMAP_YARDINV,
+		YARDMAP_UNBUILDABLE, YARDMAP_BUILDONLY, YARDMAP_EXITONLY, YARDMAP_BLOCKED,
+	};
+
+	std::vector<YardMapStatus> yardMap(footprint.x * footprint.y);
+	std::uniform_int_distribution<int> dist(0, std::size(states) - 1);
+
+	for (YardMapStatus& s: yardMap) {
+		s = states[dist(rng)];
+	}
+
+	return yardMap;
+}
+
+static const std::vector<int2> footprints = {
+	{1, 1}, {2, 2}, {3, 5}, {4, 6}, {7, 7}, {8, 2}, {63, 3}, {64, 5}, {65, 4}, {6, 130}, {130, 66},
+};
+
+
+TEST_CASE("YardMapMasks_MatchesPerSquareRotation")
+{
+	std::mt19937 rng(97531);
+
+	for (const int2 footprint: footprints) {
+		const std::vector<YardMapStatus> yardMap = RandYardMap(rng, footprint);
+
+		CYardMapMasks masks;
+		masks.Init(yardMap.data(), footprint);
+
+		for (int facing = 0; facing < CYardMapMasks::NUM_FACINGS; facing++) {
+			const int2 size = masks.GetSize(facing);
+
+			CHECK(size == (((facing & 1) == 0)? footprint: int2(footprint.y, footprint.x)));
+
+			for (int z = 0; z < size.y; z++) {
+				for (int x = 0; x < size.x; x++) {
+					const int blockState = RefBlockingState(yardMap, footprint, facing, x, z);
+					const int buildState = RefBuildState(yardMap, footprint, facing, x, z);
+
+					CHECK(int(YardmapStates(CYardMapMasks::GetBlockingState(yardMap.data(), footprint, facing, x, z))) == blockState);
+					CHECK(YardmapStates(yardMap[CYardMapMasks::GetBuildIndex(footprint, facing, x, z)]) == buildState);
+
+					for (int plane = 0; plane < CYardMapMasks::NUM_STATE_PLANES; plane++) {
+						CHECK(masks.TestSquare(facing, x, z, plane) == (((blockState >> plane) & 1) != 0));
+					}
+
+					CHECK(masks.TestSquare(facing, x, z, CYardMapMasks::PLANE_FOOTPRINT));
+					CHECK(masks.TestSquare(facing, x, z, CYardMapMasks::PLANE_STACKABLE) == (buildState <= YARDMAP_STACKABLE));
+					CHECK(masks.TestSquare(facing, x, z, CYardMapMasks::PLANE_GEOSTACKABLE) == (buildState <= YARDMAP_GEOSTACKABLE));
+					CHECK(masks.TestSquare(facing, x, z, CYardMapMasks::PLANE_BUILDONLY) == (buildState == YARDMAP_BUILDONLY));
+				}
+			}
+
+			// squares outside the footprint are never set
+			CHECK_FALSE(masks.TestSquare(facing, -1, 0, CYardMapMasks::PLANE_FOOTPRINT));
+			CHECK_FALSE(masks.TestSquare(facing, size.x, 0, CYardMapMasks::PLANE_FOOTPRINT));
+			CHECK_FALSE(masks.TestSquare(facing, 0, size.y, CYardMapMasks::PLANE_FOOTPRINT));
+		}
+	}
+}
+
+TEST_CASE("YardMapMasks_StampingMatchesPerSquareState")
+{
+	std::mt19937 rng(86420);
+
+	constexpr int EXITONLY_PLANES = CYardMapMasks::GetStatePlanes(YARDMAP_EXITONLY);
+	constexpr int UNBUILDABLE_PLANES = CYardMapMasks::GetStatePlanes(YARDMAP_UNBUILDABLE);
+	constexpr int YARD_PLANES = CYardMapMasks::GetStatePlanes(YARDMAP_YARD | YARDMAP_YARDINV);
+
+	constexpr int stampMasks[] = {YARDMAP_BLOCKED, YARDMAP_YARDFREE, YARDMAP_YARDBLOCKED, YARDMAP_YARD, YARDMAP_YARDINV};
+
+	enum { SQR_EXITONLY = 1, SQR_BLOCKBUILDING = 2, SQR_INSERTED = 4, SQR_CLEARED = 8, SQR_ERASED = 16 };
+
+	for (const int2 footprint: footprints) {
+		const std::vector<YardMapStatus> yardMap = RandYardMap(rng, footprint);
+
+		CYardMapMasks masks;
+		masks.Init(yardMap.data(), footprint);
+
+		for (int facing = 0; facing < CYardMapMasks::NUM_FACINGS; facing++) {
+			const int2 size = masks.GetSize(facing);
+
+			for (const int stampMask: stampMasks) {
+				std::vector<int> refSquares(size.x * size.y, 0);
+				std::vector<int> bitSquares(size.x * size.y, 0);
+
+				// per-square add and remove logic of CGroundBlockingObjectMap before precompiling
+				for (int z = 0; z < size.y; z++) {
+					for (int x = 0; x < size.x; x++) {
+						const int state = RefBlockingState(yardMap, footprint, facing, x, z);
+						int& sqr = refSquares[z * size.x + x];
+
+						if (state & YARDMAP_EXITONLY) {
+							sqr |= (SQR_EXITONLY | SQR_BLOCKBUILDING | SQR_CLEARED);
+							continue;
+						}
+						if (state & YARDMAP_UNBUILDABLE) {
+							sqr |= (SQR_BLOCKBUILDING | SQR_CLEARED);
+							continue;
+						}
+						if (state & (YARDMAP_YARD | YARDMAP_YARDINV))
+							sqr |= SQR_CLEARED;
+						if (state & stampMask)
+							sqr |= SQR_INSERTED;
+
+						sqr |= SQR_ERASED;
+					}
+				}
+
+				const int maskPlanes = CYardMapMasks::GetStatePlanes(stampMask);
+
+				for (int z = 0; z < size.y; z++) {
+					int* row = &bitSquares[z * size.x];
+
+					masks.ForEachSquare(facing, z, size.x, EXITONLY_PLANES, 0, [&](int x) { row[x] |= (SQR_EXITONLY | SQR_BLOCKBUILDING | SQR_CLEARED); });
+					masks.ForEachSquare(facing, z, size.x, UNBUILDABLE_PLANES, EXITONLY_PLANES, [&](int x) { row[x] |= SQR_BLOCKBUILDING; });
+					masks.ForEachSquare(facing, z, size.x, maskPlanes, EXITONLY_PLANES | UNBUILDABLE_PLANES, [&](int x) { row[x] |= SQR_INSERTED; });
+					masks.ForEachSquare(facing, z, size.x, UNBUILDABLE_PLANES | YARD_PLANES, EXITONLY_PLANES, [&](int x) { row[x] |= SQR_CLEARED; });
+					masks.ForEachSquare(facing, z, size.x, CYardMapMasks::ALL_SQUARES, EXITONLY_PLANES | UNBUILDABLE_PLANES, [&](int x) { row[x] |= SQR_ERASED; });
+				}
+
+				CHECK(bitSquares == refSquares);
+			}
+		}
+	}
+}
+
+TEST_CASE("YardMapMasks_ClippedToObjectSize")
+{
+	std::mt19937 rng(24680);
+
+	// CMD_UNLOAD_UNIT can change buildFacing without swapping xsize and zsize,
+	// so the object footprint need not match the size of the rotated yardmap
+	for (const int2 footprint: footprints) {
+		const std::vector<YardMapStatus> yardMap = RandYardMap(rng, footprint);
+
+		CYardMapMasks masks;
+		masks.Init(yardMap.data(), footprint);
+
+		for (int facing = 0; facing < CYardMapMasks::NUM_FACINGS; facing++) {
+			for (const int2 objSize: {footprint, int2(footprint.y, footprint.x)}) {
+				const int2 size = masks.GetClippedSize(facing, objSize);
+
+				CHECK(size.x <= objSize.x);
+				CHECK(size.y <= objSize.y);
+
+				for (int plane = 0; plane < CYardMapMasks::NUM_STATE_PLANES; plane++) {
+					// per-square stamping of the whole object footprint
+					std::vector<int> refSquares(objSize.x * objSize.y, 0);
+					std::vector<int> bitSquares(objSize.x * objSize.y, 0);
+
+					for (int z = 0; z < objSize.y; z++) {
+						for (int x = 0; x < objSize.x; x++) {
+							refSquares[z * objSize.x + x] = ((RefBlockingState(yardMap, footprint, facing, x, z) >> plane) & 1);
+						}
+					}
+
+					for (int z = 0; z < size.y; z++) {
+						masks.ForEachSquare(facing, z, size.x, 1 << plane, 0, [&](int x) {
+							REQUIRE(x < size.x);
+							bitSquares[z * objSize.x + x] = 1;
+						});
+					}
+
+					CAPTURE(footprint.x, footprint.y, facing, objSize.x, objSize.y, plane);
+					CHECK(bitSquares == refSquares);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("YardMapMasks_NoYardMap")
+{
+	CYardMapMasks masks;
+	masks.Init(nullptr, {4, 6});
+
+	unsigned int numSquares = 0;
+
+	for (int z = 0; z < 6; z++) {
+		masks.ForEachSquare(0, z, 4, CYardMapMasks::ALL_SQUARES, 0, [&](int) { numSquares++; });
+	}
+
+	CHECK(numSquares == 0);
+	CHECK(masks.GetSize(1) == int2(6, 4));
+}
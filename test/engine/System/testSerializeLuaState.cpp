@@ -5,6 +5,8 @@
 
 #include <catch_amalgamated.hpp>
 
+#include <chrono>
+
 
 static int handlepanic(lua_State* L)
 {
@@ -97,4 +99,94 @@ TEST_CASE("SerializeLuaState")
 	CHECK(L_GC == flh.L_GC);
 
 	lua_close(flh.L);
-}
\ No newline at end of file
+}
+
+
+static double CallChecksum(lua_State* L)
+{
+	lua_getglobal(L, "checksum");
+	lua_pcall(L, 0, 1, 0);
+
+	const double sum = lua_tonumber(L, -1);
+	lua_pop(L, 1);
+	return sum;
+}
+
+TEST_CASE("SerializeLuaState_RoundTrip_Performance")
+{
+	using Clock = std::chrono::steady_clock;
+	using Millis = std::chrono::duration<double, std::milli>;
+
+	int context = 1;
+
+	flh.L = lua_newstate(l_alloc, &context);
+	lua_atpanic(flh.L, handlepanic);
+	SPRING_LUA_OPEN_LIB(flh.L, luaopen_base);
+	SPRING_LUA_OPEN_LIB(flh.L, luaopen_math);
+	SPRING_LUA_OPEN_LIB(flh.L, luaopen_table);
+	SPRING_LUA_OPEN_LIB(flh.L, luaopen_string);
+
+	lua_settop(flh.L, 0);
+	creg::AutoRegisterCFunctions("Test::", flh.L);
+	flh.L_GC = lua_newthread(flh.L);
+	luaL_ref(flh.L, LUA_REGISTRYINDEX);
+
+	// gadget-like data: many records of the same shape, a large array, a string-keyed map
+	// and records with number keys (shared shapes hash the raw lua_Number)
+	const char* code =
+		"units = {}\n"
+		"for i = 1, 100000 do units[i] = {id = i, x = i * 0.5, z = -i, name = 'unit' .. (i % 256), alive = (i % 3 ~= 0)} end\n"
+		"heights = {}\n"
+		"for i = 1, 250000 do heights[i] = math.sin(i) * 100 end\n"
+		"lookup = {}\n"
+		"for i = 1, 50000 do lookup['key' .. i] = {i, i * 2} end\n"
+		"weights = {}\n"
+		"for i = 1, 10000 do weights[i] = {[0.25] = i, [-1] = i * 2} end\n"
+		"function checksum()\n"
+		"  local s = 0\n"
+		"  for i = 1, #units do local u = units[i]; s = s + u.id + u.x + u.z + #u.name + (u.alive and 1 or 0) end\n"
+		"  for i = 1, #heights do s = s + heights[i] end\n"
+		"  for k, v in pairs(lookup) do s = s + #k + v[1] + v[2] end\n"
+		"  for i = 1, #weights do local w = weights[i]; s = s + w[0.25] + w[-1] end\n"
+		"  return s\n"
+		"end\n";
+
+	REQUIRE(luaL_loadbuffer(flh.L, code, strlen(code), "roundtrip") == 0);
+	REQUIRE(lua_pcall(flh.L, 0, 0, 0) == 0);
+
+	const double savedSum = CallChecksum(flh.L);
+
+	std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+
+	const auto saveStart = Clock::now();
+	{
+		LuaRoot root;
+		creg::COutputStreamSerializer oser;
+		oser.SavePackage(&ss, &root, root.GetClass());
+	}
+	const auto saveEnd = Clock::now();
+	const auto saveSize = ss.tellp();
+
+	const auto loadStart = Clock::now();
+	{
+		creg::CInputStreamSerializer iser;
+		void* loaded;
+		creg::Class* loadedCls;
+		creg::CopyLuaContext(flh.L);
+		LUA_CLOSE(&flh.L);
+		iser.LoadPackage(&ss, loaded, loadedCls);
+		LuaRoot* loadedRoot = (LuaRoot*) loaded;
+		delete loadedRoot;
+	}
+	const auto loadEnd = Clock::now();
+
+	printf("[SerializeLuaState] save %.1fms, load %.1fms, %.2f MB\n",
+		Millis(saveEnd - saveStart).count(),
+		Millis(loadEnd - loadStart).count(),
+		saveSize / (1024.0 * 1024.0)
+	);
+
+	CHECK(CallChecksum(flh.L) == savedSum);
+
+	lua_close(flh.L);
+}
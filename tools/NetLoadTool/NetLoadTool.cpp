@@ -0,0 +1,558 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gflags/gflags.h>
+
+#ifdef __linux__
+	#include <unistd.h>
+#endif
+
+#include "Game/GameVersion.h"
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "Net/Protocol/NetMessageTypes.h"
+#include "System/GlobalConfig.h"
+#include "System/LoadSave/DemoReader.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/UDPConnection.h"
+#include "System/Platform/Misc.h"
+
+/*
+Usage:
+Start a dedicated server whose script has (at least) <clients> player slots
+named <nameprefix>0 .. <nameprefix>N-1, then run e.g.
+
+	netloadtool --host 127.0.0.1 --port 8452 --clients 16 --demofile /path/to/demo.sdfz --speed 2
+
+Every client connects over UDP like a regular player, acknowledges frames,
+answers sync-checks and pings the server. When a demo is given the player
+commands recorded in it (COMMAND, SELECT, AICOMMAND(S), LUAMSG, MAPDRAW)
+are replayed by the clients at <speed> times real-time, demo player K's
+stream going to client K % numDemoPlayers. Results are printed at every
+report interval and per client at exit:
+ - per-client ping round-trip latency (min / avg / max)
+ - resent and dropped UDP chunks
+ - jitter of the NEWFRAME / KEYFRAME inter-arrival times
+ - server CPU usage (Linux, when --serverpid is given)
+*/
+
+	DEFINE_string(host,           "127.0.0.1", "Address of the server");
+	DEFINE_int32 (port,           8452,        "Port of the server");
+	DEFINE_int32 (clients,        8,           "Number of synthetic clients");
+	DEFINE_string(nameprefix,     "LoadBot",   "Client i connects as <nameprefix><i>");
+	DEFINE_string(password,       "",          "Password sent by every client");
+	DEFINE_string(demofile,       "",          "Demo to extract per-player command streams from");
+	DEFINE_double(speed,          1.0,         "Replay pace relative to real-time");
+	DEFINE_bool  (userspeed,      false,       "Have client 0 request <speed> as game speed");
+	DEFINE_bool  (sendstartpos,   false,       "Send a ready start-position (team = firstteam + client index)");
+	DEFINE_int32 (firstteam,      0,           "Team of client 0 for --sendstartpos");
+	DEFINE_bool  (syncresponse,   true,        "Answer every frame with a (zero) sync-response");
+	DEFINE_int32 (pinginterval,   250,         "Milliseconds between pings per client");
+	DEFINE_int32 (connectstagger, 20,          "Milliseconds between client connection attempts");
+	DEFINE_int32 (reportinterval, 5,           "Seconds between aggregate reports");
+	DEFINE_int32 (duration,       0,           "Seconds to run once all clients joined, 0 = until replay ends");
+	DEFINE_int32 (serverpid,      0,           "Process id of the server to sample CPU usage from (Linux only)");
+
+
+// default values only, the load generator has no config-file
+GlobalConfig globalConfig;
+
+void ErrorMessageBox(const std::string& msg, const std::string& caption, unsigned int flags, bool)
+{
+	std::cerr << caption << ": " << msg << std::endl;
+}
+
+
+struct ReplayPacket {
+	float time;
+	unsigned int playerByte;
+	std::shared_ptr<const netcode::RawPacket> packet;
+};
+
+struct SampleStats {
+	void Add(float v) {
+		sum += v;
+		sqSum += v * v;
+		min = std::min(min, v);
+		max = std::max(max, v);
+		num += 1;
+	}
+
+	float Avg() const { return ((num > 0)? (sum / num): 0.0f); }
+	float Dev() const { return ((num > 0)? std::sqrt(std::max(0.0, sqSum / num - Avg() * Avg())): 0.0f); }
+
+	double sum = 0.0;
+	double sqSum = 0.0;
+	float min = FLT_MAX;
+	float max = 0.0f;
+	unsigned int num = 0;
+};
+
+struct LoadClient {
+	enum State {
+		STATE_IDLE,
+		STATE_CONNECTING,
+		STATE_INGAME,
+		STATE_DONE,
+	};
+
+	std::unique_ptr<netcode::UDPConnection> conn;
+	std::string name;
+
+	State state = STATE_IDLE;
+	int playerNum = -1;
+	int serverFrame = -1;
+
+	const std::vector<ReplayPacket>* replay = nullptr;
+	size_t replayPos = 0;
+	spring_time replayStart;
+	bool replaying = false;
+
+	spring_time lastPingTime;
+	spring_time lastFrameTime;
+	uint8_t pingTag = 0;
+
+	SampleStats pingStats;
+	SampleStats frameDeltaStats;
+
+	unsigned int numFrames = 0;
+	unsigned int numReplayed = 0;
+	std::string rejectReason;
+};
+
+
+
+/**
+ * @brief offset of the player-number byte in replayable messages, or 0
+ * The server only accepts these when the byte matches the sending
+ * connection, so it has to be rewritten for every synthetic client.
+ */
+static unsigned int GetPlayerByteOffset(const netcode::RawPacket* pkt)
+{
+	if (pkt->length < 4)
+		return 0;
+
+	switch (pkt->data[0]) {
+		case NETMSG_COMMAND:
+		case NETMSG_SELECT:
+		case NETMSG_AICOMMAND:
+		case NETMSG_AICOMMANDS:
+		case NETMSG_LUAMSG:
+			return 3;
+		case NETMSG_MAPDRAW:
+			return 2;
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+static std::vector< std::vector<ReplayPacket> > ExtractReplayStreams(const std::string& demoFile)
+{
+	std::vector< std::vector<ReplayPacket> > streams;
+	std::vector<int> playerStreams(256, -1);
+
+	CDemoReader reader(demoFile, 0.0f);
+
+	float firstTime = -1.0f;
+
+	while (!reader.ReachedEnd()) {
+		// time of the chunk returned by GetData
+		const float time = reader.GetNextDemoReadTime();
+
+		netcode::RawPacket* packet = reader.GetData(FLT_MAX);
+
+		if (packet == nullptr)
+			continue;
+
+		const unsigned int playerByte = GetPlayerByteOffset(packet);
+
+		if (playerByte == 0) {
+			delete packet;
+			continue;
+		}
+
+		const uint8_t demoPlayer = packet->data[playerByte];
+
+		if (playerStreams[demoPlayer] == -1) {
+			playerStreams[demoPlayer] = streams.size();
+			streams.emplace_back();
+		}
+
+		if (firstTime < 0.0f)
+			firstTime = time;
+
+		streams[playerStreams[demoPlayer]].push_back({time - firstTime, playerByte, std::shared_ptr<const netcode::RawPacket>(packet)});
+	}
+
+	return streams;
+}
+
+
+static bool ReadProcessCPUTime(int pid, double& cpuSecs)
+{
+#ifdef __linux__
+	std::ifstream statFile("/proc/" + std::to_string(pid) + "/stat");
+	std::string line;
+
+	if (!std::getline(statFile, line))
+		return false;
+
+	// the command name may contain spaces, fields are counted from the closing bracket
+	const size_t pos = line.rfind(')');
+
+	if (pos == std::string::npos)
+		return false;
+
+	std::istringstream fields(line.substr(pos + 2));
+	std::string field;
+
+	unsigned long long uTime = 0;
+	unsigned long long sTime = 0;
+
+	// skip state(3) .. cmajflt(12), then read utime(14) and stime(15)
+	for (int i = 3; i < 14; i++) {
+		fields >> field;
+	}
+
+	if (!(fields >> uTime >> sTime))
+		return false;
+
+	cpuSecs = (uTime + sTime) / double(sysconf(_SC_CLK_TCK));
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+static void SendSyncResponse(LoadClient& client)
+{
+	if (!FLAGS_syncresponse)
+		return;
+
+	client.conn->SendData(CBaseNetProtocol::Get().SendSyncResponse(client.playerNum, client.serverFrame, 0));
+}
+
+static void OnFrame(LoadClient& client, const spring_time now)
+{
+	if (client.numFrames > 0)
+		client.frameDeltaStats.Add((now - client.lastFrameTime).toMilliSecsf());
+
+	client.lastFrameTime = now;
+	client.numFrames += 1;
+
+	// replay clock starts with the simulation
+	if (!client.replaying && client.replay != nullptr) {
+		client.replaying = true;
+		client.replayStart = now;
+	}
+}
+
+static void ProcessPackets(LoadClient& client, const spring_time now)
+{
+	std::shared_ptr<const netcode::RawPacket> packet;
+
+	while ((packet = client.conn->GetData()) != nullptr) {
+		if (packet->length == 0)
+			continue;
+
+		switch (packet->data[0]) {
+			case NETMSG_SETPLAYERNUM: {
+				client.playerNum = packet->data[1];
+				client.state = LoadClient::STATE_INGAME;
+				client.conn->SendData(CBaseNetProtocol::Get().SendPlayerName(client.playerNum, client.name));
+
+				if (FLAGS_sendstartpos) {
+					const unsigned int clientIdx = std::atoi(client.name.c_str() + FLAGS_nameprefix.size());
+					client.conn->SendData(CBaseNetProtocol::Get().SendStartPos(client.playerNum, FLAGS_firstteam + clientIdx, 1, 0.0f, 0.0f, 0.0f));
+				}
+			} break;
+
+			case NETMSG_REJECT_CONNECT: {
+				client.rejectReason = std::string(reinterpret_cast<const char*>(packet->data + 1), packet->length - 1);
+				client.state = LoadClient::STATE_DONE;
+			} break;
+
+			case NETMSG_QUIT: {
+				client.state = LoadClient::STATE_DONE;
+			} break;
+
+			case NETMSG_KEYFRAME: {
+				if (packet->length < 5)
+					break;
+
+				std::memcpy(&client.serverFrame, &packet->data[1], sizeof(client.serverFrame));
+				client.conn->SendData(CBaseNetProtocol::Get().SendKeyFrame(client.serverFrame));
+				SendSyncResponse(client);
+				OnFrame(client, now);
+			} break;
+
+			case NETMSG_NEWFRAME: {
+				client.serverFrame += 1;
+				SendSyncResponse(client);
+				OnFrame(client, now);
+			} break;
+
+			case NETMSG_PING: {
+				if (packet->length < 7 || packet->data[1] != client.playerNum)
+					break;
+
+				float sendTime = 0.0f;
+				std::memcpy(&sendTime, &packet->data[3], sizeof(sendTime));
+				client.pingStats.Add(now.toMilliSecsf() - sendTime);
+			} break;
+
+			default:
+				break;
+		}
+	}
+}
+
+static void SendReplayPackets(LoadClient& client, const spring_time now)
+{
+	if (!client.replaying)
+		return;
+
+	const float replayTime = (now - client.replayStart).toSecsf() * FLAGS_speed;
+
+	for (; client.replayPos < client.replay->size(); client.replayPos++) {
+		const ReplayPacket& rp = (*client.replay)[client.replayPos];
+
+		if (rp.time > replayTime)
+			break;
+
+		// demo packets are shared between clients mapped to the same demo player
+		std::shared_ptr<netcode::RawPacket> packet = std::make_shared<netcode::RawPacket>(rp.packet->data, rp.packet->length);
+		packet->data[rp.playerByte] = client.playerNum;
+
+		client.conn->SendData(packet);
+		client.numReplayed += 1;
+	}
+}
+
+static bool ReplayFinished(const LoadClient& client)
+{
+	return (client.replay == nullptr || client.replayPos >= client.replay->size());
+}
+
+
+static void PrintReport(const std::vector<LoadClient>& clients, float elapsedSecs, float serverCPU)
+{
+	SampleStats ping;
+	SampleStats jitter;
+
+	unsigned int numIngame = 0;
+	unsigned int numFrames = 0;
+	unsigned int numReplayed = 0;
+	unsigned int numResent = 0;
+	unsigned int numDropped = 0;
+
+	for (const LoadClient& client: clients) {
+		numIngame += (client.state == LoadClient::STATE_INGAME);
+		numFrames = std::max(numFrames, client.numFrames);
+		numReplayed += client.numReplayed;
+
+		if (client.conn == nullptr)
+			continue;
+
+		numResent += client.conn->GetNumResentChunks();
+		numDropped += client.conn->GetNumDroppedChunks();
+
+		if (client.pingStats.num > 0)
+			ping.Add(client.pingStats.Avg());
+		if (client.frameDeltaStats.num > 0)
+			jitter.Add(client.frameDeltaStats.Dev());
+	}
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "[" << elapsedSecs << "s] ingame=" << numIngame << "/" << clients.size();
+	std::cout << " frames=" << numFrames << " replayed=" << numReplayed;
+	std::cout << " ping(avg/max)=" << ping.Avg() << "/" << ping.max << "ms";
+	std::cout << " frame-jitter(avg/max)=" << jitter.Avg() << "/" << jitter.max << "ms";
+	std::cout << " resent=" << numResent << " dropped=" << numDropped;
+
+	if (serverCPU >= 0.0f)
+		std::cout << " server-cpu=" << serverCPU << "%";
+
+	std::cout << std::endl;
+}
+
+static void PrintClientReport(const LoadClient& client)
+{
+	std::cout << "-- " << client.name << " (player " << client.playerNum << ") --" << std::endl;
+
+	if (!client.rejectReason.empty())
+		std::cout << "\trejected: " << client.rejectReason << std::endl;
+
+	std::cout << "\t" << client.numFrames << " frames received, " << client.numReplayed << " packets replayed" << std::endl;
+	std::cout << "\tping min/avg/max " << client.pingStats.min << "/" << client.pingStats.Avg() << "/" << client.pingStats.max << "ms over " << client.pingStats.num << " samples" << std::endl;
+	std::cout << "\tframe inter-arrival avg/dev/max " << client.frameDeltaStats.Avg() << "/" << client.frameDeltaStats.Dev() << "/" << client.frameDeltaStats.max << "ms" << std::endl;
+
+	if (client.conn != nullptr)
+		std::cout << client.conn->Statistics();
+}
+
+
+int main(int argc, char* argv[])
+{
+	gflags::SetUsageMessage(std::string("Usage: ") + argv[0] + " [options]");
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+	if (FLAGS_clients <= 0 || FLAGS_clients > 250 || FLAGS_speed <= 0.0) {
+		gflags::ShowUsageWithFlags(argv[0]);
+		return 1;
+	}
+
+	std::vector< std::vector<ReplayPacket> > replayStreams;
+
+	if (!FLAGS_demofile.empty()) {
+		try {
+			replayStreams = ExtractReplayStreams(FLAGS_demofile);
+		} catch (const std::exception& e) {
+			std::cout << "Failed to read demo: " << e.what() << std::endl;
+			return 1;
+		}
+
+		size_t numPackets = 0;
+		float demoLength = 0.0f;
+
+		for (const std::vector<ReplayPacket>& stream: replayStreams) {
+			numPackets += stream.size();
+			demoLength = std::max(demoLength, stream.empty()? 0.0f: stream.back().time);
+		}
+
+		std::cout << "Extracted " << numPackets << " packets of " << replayStreams.size() << " players (" << demoLength << "s)" << std::endl;
+	}
+
+	spring_time::setstarttime(spring_time::gettime(true));
+
+	std::vector<LoadClient> clients(FLAGS_clients);
+
+	for (int i = 0; i < FLAGS_clients; i++) {
+		clients[i].name = FLAGS_nameprefix + std::to_string(i);
+
+		if (!replayStreams.empty())
+			clients[i].replay = &replayStreams[i % replayStreams.size()];
+	}
+
+	const spring_time startTime = spring_gettime();
+
+	spring_time lastReportTime = startTime;
+	spring_time allJoinedTime;
+
+	double lastServerCPUSecs = 0.0;
+	bool haveServerCPU = (FLAGS_serverpid > 0 && ReadProcessCPUTime(FLAGS_serverpid, lastServerCPUSecs));
+
+	for (int nextClient = 0; ; ) {
+		const spring_time now = spring_gettime();
+
+		// staggered connects, a burst of ATTEMPTCONNECTs is not what we want to measure
+		if (nextClient < FLAGS_clients && (now - startTime).toMilliSecsi() >= (nextClient * FLAGS_connectstagger)) {
+			LoadClient& client = clients[nextClient++];
+
+			try {
+				client.conn = std::make_unique<netcode::UDPConnection>(0, FLAGS_host, FLAGS_port);
+				client.conn->Unmute();
+				client.conn->SendData(CBaseNetProtocol::Get().SendAttemptConnect(client.name, FLAGS_password, SpringVersion::GetSync(), Platform::GetPlatformStr(), globalConfig.networkLossFactor));
+				client.conn->Flush(true);
+				client.state = LoadClient::STATE_CONNECTING;
+			} catch (const std::exception& e) {
+				client.rejectReason = e.what();
+				client.state = LoadClient::STATE_DONE;
+			}
+		}
+
+		unsigned int numIngame = 0;
+		unsigned int numActive = 0;
+		unsigned int numReplaying = 0;
+
+		for (LoadClient& client: clients) {
+			if (client.conn == nullptr || client.state == LoadClient::STATE_DONE)
+				continue;
+
+			client.conn->Update();
+			ProcessPackets(client, now);
+
+			if (client.conn->CheckTimeout(0, client.state == LoadClient::STATE_CONNECTING)) {
+				client.rejectReason = "connection timed out";
+				client.state = LoadClient::STATE_DONE;
+				continue;
+			}
+
+			if (client.state == LoadClient::STATE_INGAME) {
+				if ((now - client.lastPingTime).toMilliSecsi() >= FLAGS_pinginterval) {
+					client.conn->SendData(CBaseNetProtocol::Get().SendPing(client.playerNum, client.pingTag++, now.toMilliSecsf()));
+					client.conn->SendData(CBaseNetProtocol::Get().SendCPUUsage(0.0f));
+					client.lastPingTime = now;
+				}
+
+				if (FLAGS_userspeed && client.numFrames == 1 && &client == &clients[0])
+					client.conn->SendData(CBaseNetProtocol::Get().SendUserSpeed(client.playerNum, FLAGS_speed));
+
+				SendReplayPackets(client, now);
+
+				numIngame += 1;
+				numReplaying += !ReplayFinished(client);
+			}
+
+			numActive += (client.state != LoadClient::STATE_DONE);
+			client.conn->Flush(false);
+		}
+
+		if (nextClient == FLAGS_clients && numActive == 0)
+			break;
+
+		if (numIngame == numActive && nextClient == FLAGS_clients && !allJoinedTime.isTime())
+			allJoinedTime = now;
+
+		if (allJoinedTime.isTime()) {
+			if (FLAGS_duration > 0 && (now - allJoinedTime).toSecsi() >= FLAGS_duration)
+				break;
+			if (FLAGS_duration <= 0 && !replayStreams.empty() && numReplaying == 0)
+				break;
+		}
+
+		if ((now - lastReportTime).toSecsi() >= FLAGS_reportinterval) {
+			float serverCPU = -1.0f;
+			double serverCPUSecs = 0.0;
+
+			if (haveServerCPU && ReadProcessCPUTime(FLAGS_serverpid, serverCPUSecs)) {
+				serverCPU = 100.0f * (serverCPUSecs - lastServerCPUSecs) / (now - lastReportTime).toSecsf();
+				lastServerCPUSecs = serverCPUSecs;
+			}
+
+			PrintReport(clients, (now - startTime).toSecsf(), serverCPU);
+			lastReportTime = now;
+		}
+
+		spring_sleep(spring_msecs(1));
+	}
+
+	for (LoadClient& client: clients) {
+		if (client.conn == nullptr)
+			continue;
+
+		client.conn->SendData(CBaseNetProtocol::Get().SendQuit("load test finished"));
+		client.conn->Flush(true);
+	}
+
+	PrintReport(clients, (spring_gettime() - startTime).toSecsf(), -1.0f);
+
+	for (const LoadClient& client: clients) {
+		PrintClientReport(client);
+	}
+
+	return 0;
+}